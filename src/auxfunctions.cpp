@@ -20,101 +20,226 @@
 
 #include "auxfunctions.hpp"
 #include "constants.hpp"
+#include "srcdatareader.hpp"
+#include "srcdatafilter.hpp"
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <iostream>
-#include <fstream>
+#include <iomanip>
+#include <ctime>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
 
-#define BOOST_NO_CXX11_SCOPED_ENUMS
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
-#include <boost/filesystem.hpp>
-#include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 
 using std::string;
 using std::vector;
+using std::shared_ptr;
+using std::unique_ptr;
 using std::cout;
-using std::ifstream;
 
-vector< vector<double> > srcData() {
+vector< vector<double> > srcData(const shared_ptr<Configuration> &conf) {
 
-    vector< vector<string> > raw;
     vector< vector<double> > srcdata;
 
-    const boost::filesystem::path file(SRCDATAFILE);
+    SrcDataReader reader;
 
-    if ( !boost::filesystem::exists(file) ) {
-        cout << ERRORMSGBLANK << "Source data file \"" << SRCDATAFILE << "\" not found!\n";
+    if ( !reader.open(conf->val_srcFile()) ) {
         return srcdata;
     }
 
-    ifstream fin(SRCDATAFILE);
+    vector<double> row;
 
-    if ( !fin ) {
-        cout << ERRORMSGBLANK << "Can not open file \"" << SRCDATAFILE << "\" to read!\n";
-        return srcdata;
+    const unique_ptr<SrcDataFilter> filter = srcDataFilter(conf);
+
+    while ( filter ? filter->readRow(reader, row) : reader.readRow(row) ) {
+        srcdata.push_back(row);
+    }
+
+    if ( filter ) {
+        filter->printSummary();
     }
 
-    while ( !fin.eof() ) {
+    reader.printErrors();
+
+    if ( reader.val_rawRowsNum() < (TABLECAPSTRNUM + 1) ) {
+        cout << ERRORMSGBLANK << "No source data (\n";
+    }
+
+    return srcdata;
+}
 
-        string s;
-        vector<string> elem;
+string trimDate(const string &str) {
 
-        getline(fin, s);
+    if ( str.size() == 1 ) {
+        return "0" + str;
+    }
+    else if ( str.size() == 2 ) {
+        return str;
+    }
 
-        if ( !s.empty() ) {
+    return "00";
+}
 
-            boost::split(elem, s, boost::is_any_of(CSVDELIMETER));
-            bool valid_str = true;
+string currDateTime() {
 
-            for ( size_t i=0; i<elem.size(); i++ ) {
-                if ( elem[i].empty() ) {
-                    valid_str = false;
-                    break;
-                }
-            }
+    time_t t = time(NULL);
+    struct tm *dtnow = localtime(&t);
 
-            if ( valid_str ) {
-                raw.push_back(elem);
-            }
-        }
+    string year = boost::lexical_cast<string>(dtnow->tm_year + 1900);
+    string mon  = boost::lexical_cast<string>(dtnow->tm_mon + 1);
+    string day  = boost::lexical_cast<string>(dtnow->tm_mday);
+    string hour = boost::lexical_cast<string>(dtnow->tm_hour);
+    string min  = boost::lexical_cast<string>(dtnow->tm_min);
+    string sec  = boost::lexical_cast<string>(dtnow->tm_sec);
+
+    return year + "-" + trimDate(mon) + "-" + trimDate(day) + "_" + trimDate(hour) + "-" + trimDate(min) + "-" + trimDate(sec);
+}
+
+string reportFileName(const string &reportName, const Configuration &conf) {
+
+    string fileName = reportName + "__";
+
+    if ( !conf.val_profileName().empty() ) {
+        fileName += conf.val_profileName() + "__";
     }
 
-    if ( raw.size() < (TABLECAPSTRNUM + 1) ) {
-        cout << ERRORMSGBLANK << "No source data (\n";
-        return srcdata;
+    fileName += currDateTime() + ".csv";
+
+    if ( conf.val_reportCompression() == COMPRESSION_GZIP ) {
+        fileName += GZEXT;
     }
 
-    for ( size_t i=TABLECAPSTRNUM; i<raw.size(); i++ ) {
+    return joinPath(conf.val_outDir(), fileName);
+}
 
-        if ( raw[i].size() != colCaptions.size() ) {
-            cout << WARNMSGBLANK << "Row " << i << " of source data array has wrong elements number! Skipped.\n";
-            continue;
-        }
+bool fileExists(const string &fileName) {
 
-        vector<double> elem;
+    struct stat st;
 
-        for ( size_t j=0; j<raw[i].size(); j++ ) {
-            elem.push_back(boost::lexical_cast<double>(raw[i][j]));
-        }
+    return (stat(fileName.c_str(), &st) == 0) && !(st.st_mode & S_IFDIR);
+}
 
-        srcdata.push_back(elem);
+bool dirExists(const string &dirName) {
+
+    struct stat st;
+
+    return (stat(dirName.c_str(), &st) == 0) && (st.st_mode & S_IFDIR);
+}
+
+bool makeDirs(const string &dirName) {
+
+    struct stat st;
+
+    if ( dirName.empty() || (stat(dirName.c_str(), &st) == 0) ) {
+        return !dirName.empty() && (st.st_mode & S_IFDIR);
     }
 
-    fin.close();
+    const size_t pos = dirName.find_last_of("/\\", dirName.size() - 2);
 
-    return srcdata;
+    if ( (pos != string::npos) && (pos > 0) && !makeDirs(dirName.substr(0, pos)) ) {
+        return false;
+    }
+
+#ifdef _WIN32
+    return (_mkdir(dirName.c_str()) == 0) || (errno == EEXIST);
+#else
+    return (mkdir(dirName.c_str(), 0777) == 0) || (errno == EEXIST);
+#endif
 }
 
-string trimDate(const string &str) {
+string joinPath(const string &dirName, const string &fileName) {
 
-    if ( str.size() == 1 ) {
-        return "0" + str;
+    if ( dirName.empty() ) {
+        return fileName;
     }
-    else if ( str.size() == 2 ) {
-        return str;
+
+    const char last = dirName[dirName.size()-1];
+
+    if ( (last == '/') || (last == '\\') ) {
+        return dirName + fileName;
     }
 
-    return "00";
+    return dirName + "/" + fileName;
+}
+
+size_t formatFixed(double val, size_t prec, char *buf) {
+
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+
+    const double scaled = std::fabs(val) * ((prec <= 8) ? pow10[prec] : 0);
+
+    // integer rounding is exact while scaled value is below 2^52
+    // and is not a tie, other cases are passed to snprintf
+    if ( (prec > 8) || !(scaled < 4503599627370496.0) || ((scaled - std::floor(scaled)) == 0.5) ) {
+        return static_cast<size_t>(snprintf(buf, FIXEDBUFSIZE, "%.*f", static_cast<int>(prec), val));
+    }
+
+    uint64_t r = static_cast<uint64_t>(std::llround(scaled));
+
+    char tmp[32];
+    size_t len = 0;
+
+    for ( size_t i=0; i<prec; i++ ) {
+        tmp[len++] = static_cast<char>('0' + r % 10);
+        r /= 10;
+    }
+
+    if ( prec > 0 ) {
+        tmp[len++] = '.';
+    }
+
+    do {
+        tmp[len++] = static_cast<char>('0' + r % 10);
+        r /= 10;
+    } while ( r > 0 );
+
+    if ( std::signbit(val) ) {
+        tmp[len++] = '-';
+    }
+
+    for ( size_t i=0; i<len; i++ ) {
+        buf[i] = tmp[len - 1 - i];
+    }
+
+    buf[len] = '\0';
+
+    return len;
+}
+
+ResCell cell(double val, int prec) {
+    ResCell c = {val, prec, false};
+    return c;
+}
+
+ResCell sciCell(double val, int prec) {
+    ResCell c = {val, prec, true};
+    return c;
+}
+
+std::ostream &operator<<(std::ostream &fout, const ResCell &c) {
+
+    if ( !std::isfinite(c.val) ) {
+        return fout;
+    }
+
+    if ( c.sci ) {
+        fout << std::scientific;
+    }
+    else {
+        fout << std::fixed;
+    }
+
+    return fout << std::setprecision(c.prec) << c.val;
 }
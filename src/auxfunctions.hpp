@@ -23,9 +23,36 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <ostream>
 
-std::vector< std::vector<double> > srcData();
+#include "configuration.hpp"
+
+std::vector< std::vector<double> > srcData(const std::shared_ptr<Configuration> &);
 
 std::string trimDate(const std::string &);
+std::string currDateTime();
+std::string reportFileName(const std::string &, const Configuration &);
+
+bool fileExists(const std::string &);
+bool dirExists(const std::string &);
+bool makeDirs(const std::string &);
+std::string joinPath(const std::string &, const std::string &);
+
+// Writes val with prec digits after the decimal point, the same as printf("%.*f").
+// Buffer must have FIXEDBUFSIZE chars, returns the length of text.
+size_t formatFixed(double val, size_t prec, char *buf);
+
+// Report cell: NaN and infinite values (masked rows and results, points
+// without solution) are written as empty cells.
+struct ResCell {
+    double val;
+    int prec;
+    bool sci;
+};
+
+ResCell cell(double val, int prec);
+ResCell sciCell(double val, int prec);
+std::ostream &operator<<(std::ostream &, const ResCell &);
 
 #endif // AUXFUNCTIONS_HPP
@@ -0,0 +1,425 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: batch.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "batch.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+#include "auxfunctions.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <set>
+#include <exception>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::ifstream;
+using std::cout;
+
+Batch::Batch(const shared_ptr<Configuration> &cfg) {
+
+    m_conf = cfg;
+    m_manifest = joinPath(m_conf->val_outDir(), BATCHMANIFESTNAME);
+}
+
+bool Batch::run(const Calculation &calculate) {
+
+    if ( !readList() ) {
+        return false;
+    }
+
+    readManifest();
+
+    const string cfgHash = configHash();
+    const vector<string> names = outputNames();
+
+    size_t calculated = 0;
+    size_t skipped = 0;
+    size_t failed = 0;
+
+    for ( size_t i=0; i<m_inputs.size(); i++ ) {
+
+        Item item;
+
+        item.input = m_inputs[i];
+        item.inputHash = fileHash(item.input);
+        item.configHash = cfgHash;
+        item.output = joinPath(m_conf->val_outDir(), names[i]);
+
+        const auto prev = m_finished.find(item.input);
+
+        if ( (prev != m_finished.end()) && (prev->second.status == BATCHDONE) &&
+             !item.inputHash.empty() &&
+             (prev->second.inputHash == item.inputHash) &&
+             (prev->second.configHash == item.configHash) &&
+             dirExists(prev->second.output) ) {
+
+            skipped++;
+            continue;
+        }
+
+        // calculation of the file aborted the previous run, it is not
+        // repeated now, so the rest of the batch can be finished
+        if ( (prev != m_finished.end()) && (prev->second.status == BATCHSTARTED) ) {
+
+            cout << ERRORMSGBLANK << "Calculation of file \"" << item.input << "\" aborted the previous run! Skipped.\n";
+
+            item.status = BATCHFAILED;
+            failed++;
+
+            if ( !appendManifest(item) ) {
+                return false;
+            }
+
+            continue;
+        }
+
+        cout << MSGBLANK << "Batch file " << (i + 1) << " of " << m_inputs.size() << ": \"" << item.input << "\".\n";
+
+        bool ok = false;
+
+        if ( item.inputHash.empty() ) {
+            cout << ERRORMSGBLANK << "Can not read file \"" << item.input << "\"!\n";
+        }
+        else if ( !makeDirs(item.output) ) {
+            cout << ERRORMSGBLANK << "Can not create directory \"" << item.output << "\"!\n";
+        }
+        else {
+
+            // crash of the process leaves this record as the last one of the file
+            item.status = BATCHSTARTED;
+
+            if ( !appendManifest(item) ) {
+                return false;
+            }
+
+            shared_ptr<Configuration> conf(new Configuration(*m_conf));
+
+            conf->overrideParameter("srcFile", item.input);
+            conf->overrideParameter("outDir", item.output);
+            conf->overrideParameter("batchList", "");
+
+            // one bad file must not stop the batch
+            try {
+                ok = calculate(conf);
+            }
+            catch ( const boost::bad_lexical_cast & ) {
+                cout << ERRORMSGBLANK << "Wrong value in file \"" << item.input << "\"!\n";
+            }
+            catch ( const std::exception &e ) {
+                cout << ERRORMSGBLANK << "Calculation of file \"" << item.input << "\" failed: " << e.what() << "\n";
+            }
+        }
+
+        item.status = ok ? BATCHDONE : BATCHFAILED;
+
+        if ( ok ) {
+            calculated++;
+        }
+        else {
+            failed++;
+        }
+
+        // without the manifest progress of the batch would be lost
+        if ( !appendManifest(item) ) {
+            return false;
+        }
+    }
+
+    cout << MSGBLANK << "Batch completed: " << calculated << " file(s) calculated, "
+         << skipped << " skipped as finished, " << failed << " failed.\n";
+
+    if ( failed > 0 ) {
+        cout << WARNMSGBLANK << "Failed files are recorded in \"" << m_manifest << "\" and will be calculated on restart.\n";
+    }
+
+    return failed == 0;
+}
+
+bool Batch::readList() {
+
+    const string fileName = m_conf->val_batchList();
+    ifstream fin(fileName.c_str());
+
+    if ( !fin ) {
+        cout << ERRORMSGBLANK << "Batch list \"" << fileName << "\" not found!\n";
+        return false;
+    }
+
+    m_inputs.clear();
+
+    string str;
+
+    while ( std::getline(fin, str) ) {
+
+        if ( !str.empty() && (str[str.size()-1] == '\r') ) {
+            str.erase(str.size()-1);
+        }
+
+        if ( str.empty() || (str.compare(0, 2, "//") == 0) ) {
+            continue;
+        }
+
+        m_inputs.push_back(str);
+    }
+
+    if ( m_inputs.empty() ) {
+        cout << ERRORMSGBLANK << "No source data files in batch list \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    return true;
+}
+
+void Batch::readManifest() {
+
+    m_finished.clear();
+    m_tornRecord = false;
+
+    ifstream fin(m_manifest.c_str(), std::ios::binary);
+
+    if ( !fin ) {
+        return;
+    }
+
+    string str;
+    size_t rowNum = 0;
+
+    while ( std::getline(fin, str) ) {
+
+        // the last line without end of line was not written completely
+        if ( fin.eof() ) {
+            m_tornRecord = true;
+            break;
+        }
+
+        if ( (rowNum++ < TABLECAPSTRNUM) || str.empty() ) {
+            continue;
+        }
+
+        vector<string> elem;
+        size_t pos = 0;
+
+        while ( true ) {
+
+            const size_t next = str.find(CSVDELIMETER[0], pos);
+            elem.push_back(str.substr(pos, (next == string::npos) ? string::npos : (next - pos)));
+
+            if ( next == string::npos ) {
+                break;
+            }
+
+            pos = next + 1;
+        }
+
+        if ( (elem.size() != BATCHFIELDSNUM) ||
+             ((elem[4] != BATCHDONE) && (elem[4] != BATCHFAILED) && (elem[4] != BATCHSTARTED)) ) {
+            cout << WARNMSGBLANK << "Wrong row " << (rowNum - 1) << " in file \"" << m_manifest << "\"! Skipped.\n";
+            continue;
+        }
+
+        Item item;
+
+        item.input      = elem[0];
+        item.inputHash  = elem[1];
+        item.configHash = elem[2];
+        item.output     = elem[3];
+        item.status     = elem[4];
+
+        m_finished[item.input] = item;
+    }
+
+    if ( !m_finished.empty() ) {
+        cout << MSGBLANK << m_finished.size() << " file(s) found in batch manifest \"" << m_manifest << "\".\n";
+    }
+}
+
+bool Batch::appendManifest(const Item &item) {
+
+    const bool exists = fileExists(m_manifest);
+
+    FILE *f = std::fopen(m_manifest.c_str(), "ab");
+
+    if ( f == nullptr ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << m_manifest << "\" to write!\n";
+        return false;
+    }
+
+    string rec;
+
+    if ( !exists ) {
+        rec = string("input") + CSVDELIMETER + "inputHash" + CSVDELIMETER + "configHash" + CSVDELIMETER
+            + "output" + CSVDELIMETER + "status" + "\n";
+    }
+    else if ( m_tornRecord ) {
+        rec = "\n";
+    }
+
+    rec += item.input + CSVDELIMETER + item.inputHash + CSVDELIMETER + item.configHash + CSVDELIMETER
+         + item.output + CSVDELIMETER + item.status + "\n";
+
+    bool ok = (std::fwrite(rec.data(), 1, rec.size(), f) == rec.size()) && (std::fflush(f) == 0);
+
+#ifdef _WIN32
+    ok = ok && (_commit(_fileno(f)) == 0);
+#else
+    ok = ok && (fsync(fileno(f)) == 0);
+#endif
+
+    ok = (std::fclose(f) == 0) && ok;
+
+    if ( !ok ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << m_manifest << "\"!\n";
+        return false;
+    }
+
+    m_tornRecord = false;
+    m_finished[item.input] = item;
+
+    return true;
+}
+
+string Batch::configHash() const {
+
+    uint64_t h = FNVOFFSET;
+
+    ifstream fin(m_conf->val_configFile().c_str(), std::ios::binary);
+
+    if ( fin ) {
+
+        std::ostringstream text;
+        text << fin.rdbuf();
+
+        const string str = text.str();
+        h = hashBytes(h, str.data(), str.size());
+    }
+
+    // paths of the batch differ from file to file and do not change results
+    const vector< std::pair<string, string> > &overrides = m_conf->val_overrides();
+
+    for ( size_t i=0; i<overrides.size(); i++ ) {
+
+        if ( (overrides[i].first == "srcFile") || (overrides[i].first == "outDir") ||
+             (overrides[i].first == "batchList") ) {
+            continue;
+        }
+
+        const string str = "\n" + overrides[i].first + PARAMDELIMITER + overrides[i].second;
+        h = hashBytes(h, str.data(), str.size());
+    }
+
+    return hashString(h);
+}
+
+vector<string> Batch::outputNames() const {
+
+    vector<string> names;
+    std::set<string> used;
+
+    for ( size_t i=0; i<m_inputs.size(); i++ ) {
+
+        string name = m_inputs[i];
+
+        const size_t slash = name.find_last_of("/\\");
+
+        if ( slash != string::npos ) {
+            name.erase(0, slash + 1);
+        }
+
+        if ( (name.size() > std::strlen(GZEXT)) && (name.compare(name.size() - std::strlen(GZEXT), string::npos, GZEXT) == 0) ) {
+            name.erase(name.size() - std::strlen(GZEXT));
+        }
+
+        const size_t dot = name.find_last_of('.');
+
+        if ( (dot != string::npos) && (dot > 0) ) {
+            name.erase(dot);
+        }
+
+        // files of the same name from different directories
+        const string base = name;
+
+        for ( size_t k=2; used.count(name) > 0; k++ ) {
+            name = base + "_" + boost::lexical_cast<string>(k);
+        }
+
+        used.insert(name);
+        names.push_back(name);
+    }
+
+    return names;
+}
+
+uint64_t Batch::hashBytes(uint64_t h, const char *data, size_t size) {
+
+    for ( size_t i=0; i<size; i++ ) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= FNVPRIME;
+    }
+
+    return h;
+}
+
+string Batch::hashString(uint64_t h) {
+
+    std::ostringstream str;
+    str << std::hex << std::setw(16) << std::setfill('0') << h;
+
+    return str.str();
+}
+
+string Batch::fileHash(const string &fileName) {
+
+    FILE *f = std::fopen(fileName.c_str(), "rb");
+
+    if ( f == nullptr ) {
+        return string();
+    }
+
+    vector<char> buf(BATCHHASHBUFSIZE);
+    uint64_t h = FNVOFFSET;
+    size_t n = 0;
+
+    while ( (n = std::fread(buf.data(), 1, buf.size(), f)) > 0 ) {
+        h = hashBytes(h, buf.data(), n);
+    }
+
+    const bool failed = std::ferror(f) != 0;
+
+    std::fclose(f);
+
+    return failed ? string() : hashString(h);
+}
@@ -0,0 +1,96 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: batch.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "configuration.hpp"
+
+//
+// Batch calculation of source data files listed in file batchList. Every
+// file is calculated with its own copy of the configuration, reports are
+// written to directory outDir/<file name>. A failure of one file (bad data,
+// exception, out of memory) is reported and the batch goes on.
+//
+// Every file is appended to manifest BATCHMANIFESTNAME in outDir before
+// and after calculation:
+//     input;inputHash;configHash;output;status
+// Hashes are FNV-1a of the file contents and of the configuration file with
+// command line overrides. The record is written by one write and synced
+// to disk, so a run killed at any moment leaves all finished records. A
+// torn last record does not end with a valid status and is ignored.
+//
+// On restart files with record "done", equal hashes and existing output
+// directory are skipped. A file left in state "started" aborted the
+// previous run (crash, kill), it is recorded as failed and skipped, so
+// the same file does not stop every restart. Failed files are calculated
+// again on the next restart. Later records of the same input override
+// earlier ones.
+//
+
+class Batch {
+
+public:
+
+    Batch(const std::shared_ptr<Configuration> &conf);
+
+    // calculation of one file with the given configuration, returns success
+    typedef std::function<bool (const std::shared_ptr<Configuration> &)> Calculation;
+
+    bool run(const Calculation &);
+
+private:
+
+    struct Item {
+        std::string input;
+        std::string inputHash;
+        std::string configHash;
+        std::string output;
+        std::string status;
+    };
+
+    bool readList();
+    void readManifest();
+    bool appendManifest(const Item &);
+
+    std::string configHash() const;
+    std::vector<std::string> outputNames() const;
+
+    static uint64_t hashBytes(uint64_t, const char *, size_t);
+    static std::string hashString(uint64_t);
+    static std::string fileHash(const std::string &);
+
+    std::shared_ptr<Configuration> m_conf;
+    std::string m_manifest;
+
+    std::vector<std::string> m_inputs;
+    std::unordered_map<std::string, Item> m_finished; // last record of every input
+    bool m_tornRecord = false;
+
+};
+
+#endif // BATCH_HPP
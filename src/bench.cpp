@@ -0,0 +1,352 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/bench.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//
+// Benchmark of calculation stages: reading and parsing of source data
+// file, calculation of source data (preCalculate), calculation of
+// parameters of all configuration profiles, formatting of results
+// table and real-time calculation of single points. Every stage is
+// repeated, the fastest repetition is reported with its wall time and
+// hardware counters normalized per row. Counters are optional, without
+// them only wall time is reported.
+//
+// The real-time stage also collects the latency histogram of points,
+// allocations of the real-time loop are checked by tkr_rtcheck.
+//
+
+#include "perfcounters.hpp"
+#include "latencyhistogram.hpp"
+#include "realtime.hpp"
+#include "tkrsourcedata.hpp"
+#include "tkrparameters.hpp"
+#include "configuration.hpp"
+#include "auxfunctions.hpp"
+#include "constants.hpp"
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::cout;
+using std::cerr;
+
+namespace {
+
+enum {
+    STAGE_PARSE,
+    STAGE_SOURCE,
+    STAGE_CALCULATION,
+    STAGE_REPORT,
+    STAGE_REALTIME,
+    STAGENUM
+};
+
+const char *stageNames[STAGENUM] = {
+    "parse",
+    "source data",
+    "calculation",
+    "report",
+    "real-time points"
+};
+
+struct StageResult {
+    double seconds = std::numeric_limits<double>::infinity();
+    double counts[PERFNUM];
+};
+
+// discards everything written, formatting cost only
+class NullBuf : public std::streambuf {
+
+protected:
+
+    int_type overflow(int_type c) {
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char *, std::streamsize n) {
+        return n;
+    }
+
+};
+
+class StageTimer {
+
+public:
+
+    StageTimer(PerfCounters &counters, StageResult &result) :
+        m_counters(counters),
+        m_result(result),
+        m_begin(std::chrono::steady_clock::now()) {
+
+        m_counters.start();
+    }
+
+    ~StageTimer() {
+
+        m_counters.stop();
+
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count();
+
+        // the fastest repetition is the least disturbed one
+        if ( sec < m_result.seconds ) {
+
+            m_result.seconds = sec;
+
+            for ( size_t i=0; i<PERFNUM; i++ ) {
+                m_result.counts[i] = m_counters.val_count(i);
+            }
+        }
+    }
+
+private:
+
+    PerfCounters &m_counters;
+    StageResult &m_result;
+    std::chrono::steady_clock::time_point m_begin;
+
+};
+
+void printValue(double val) {
+
+    if ( std::isfinite(val) ) {
+        cout << val;
+    }
+    else {
+        cout << "n/a";
+    }
+}
+
+void printUsage() {
+    cerr << "Usage: tkr_bench [-c file] [-i file] [-r repeats] [--no-counters]\n\n"
+         << "  -c file        configuration file (default " << CONFIGFILE << ")\n"
+         << "  -i file        source data file instead of srcFile parameter\n"
+         << "  -r repeats     number of repetitions of every stage (default 5)\n"
+         << "  --no-counters  do not open hardware counters\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+    string configFile = CONFIGFILE;
+    bool configGiven = false;
+    string srcFile;
+    size_t repeats = 5;
+    bool counters = true;
+
+    for ( int i=1; i<argc; i++ ) {
+
+        const string arg(argv[i]);
+
+        if ( arg == "--no-counters" ) {
+            counters = false;
+            continue;
+        }
+
+        if ( (i + 1) == argc ) {
+            printUsage();
+            return EXITUSAGE;
+        }
+
+        const char *value = argv[++i];
+
+        if ( arg == "-c" ) {
+            configFile = value;
+            configGiven = true;
+        }
+        else if ( arg == "-i" ) {
+            srcFile = value;
+        }
+        else if ( arg == "-r" ) {
+            repeats = std::strtoull(value, nullptr, 10);
+        }
+        else {
+            printUsage();
+            return EXITUSAGE;
+        }
+    }
+
+    if ( repeats == 0 ) {
+        printUsage();
+        return EXITUSAGE;
+    }
+
+    shared_ptr<Configuration> conf(new Configuration());
+    vector< shared_ptr<Configuration> > profiles;
+
+    try {
+
+        // default configuration file is optional as in tkr
+        if ( !conf->readConfigFile(configFile) && configGiven ) {
+            return EXITCONFIG;
+        }
+
+        if ( !srcFile.empty() ) {
+            conf->overrideParameter("srcFile", srcFile);
+        }
+
+        profiles = conf->profiles();
+    }
+    catch ( const ConfigError &e ) {
+        cout << ERRORMSGBLANK << e.what() << "\n";
+        return EXITCONFIG;
+    }
+
+    PerfCounters perf;
+
+    if ( counters && !perf.open() ) {
+        cout << WARNMSGBLANK << "Hardware counters are not available, only wall time will be measured.\n";
+    }
+
+    StageResult results[STAGENUM];
+    vector< vector<double> > srcdata;
+
+    NullBuf nullBuf;
+    std::ostream nullStream(&nullBuf);
+
+    const TkrCalcParams params = conf->val_calcParams();
+    LatencyHistogram latency;
+    vector<double> records;
+
+    for ( size_t r=0; r<repeats; r++ ) {
+
+        // messages of reading are printed once
+        std::streambuf *coutBuf = cout.rdbuf();
+
+        if ( r > 0 ) {
+            cout.rdbuf(&nullBuf);
+        }
+
+        {
+            StageTimer t(perf, results[STAGE_PARSE]);
+            srcdata = srcData(conf);
+        }
+
+        cout.rdbuf(coutBuf);
+
+        if ( srcdata.empty() ) {
+            return EXITFAILED;
+        }
+
+        shared_ptr<TkrSourceData> src(new TkrSourceData());
+        vector< shared_ptr<TkrParameters> > tkrs;
+
+        for ( size_t p=0; p<profiles.size(); p++ ) {
+            tkrs.push_back(shared_ptr<TkrParameters>(new TkrParameters(profiles[p])));
+        }
+
+        bool ok = false;
+
+        {
+            StageTimer t(perf, results[STAGE_SOURCE]);
+            ok = src->calculate(srcdata);
+        }
+
+        {
+            StageTimer t(perf, results[STAGE_CALCULATION]);
+            ok = ok && TkrParameters::calculate(tkrs, src);
+        }
+
+        if ( !ok ) {
+            cout << ERRORMSGBLANK << "Calculation failed!\n";
+            return EXITFAILED;
+        }
+
+        {
+            StageTimer t(perf, results[STAGE_REPORT]);
+
+            for ( size_t p=0; p<tkrs.size(); p++ ) {
+                tkrs[p]->writeResultsTable(nullStream);
+            }
+        }
+
+        // input records as written by the DAQ, tag is the row number
+        records.assign(srcdata.size() * RTSRCRECORD, 0);
+
+        for ( size_t i=0; i<srcdata.size(); i++ ) {
+            records[i * RTSRCRECORD] = i;
+            std::copy(srcdata[i].begin(), srcdata[i].begin() + SRCCOLNUM, records.begin() + i * RTSRCRECORD + 1);
+        }
+
+        {
+            StageTimer t(perf, results[STAGE_REALTIME]);
+
+            double res[RTRESRECORD];
+            TkrRow<double> row;
+
+            for ( size_t i=0; i<srcdata.size(); i++ ) {
+
+                const auto begin = std::chrono::steady_clock::now();
+
+                RealTime::calculatePoint(params, row, &records[i * RTSRCRECORD], res);
+
+                latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count()));
+            }
+        }
+    }
+
+    const double rows = static_cast<double>(srcdata.size());
+
+    cout << "Rows" << CSVDELIMETER << srcdata.size() << CSVDELIMETER
+         << "profiles " << profiles.size() << CSVDELIMETER
+         << "repetitions " << repeats << "\n"
+         << "Stage" << CSVDELIMETER << "Time [ms]" << CSVDELIMETER << "Time per row [ns]";
+
+    for ( size_t i=0; i<PERFNUM; i++ ) {
+        cout << CSVDELIMETER << perfCaptions[i] << " per row";
+    }
+
+    cout << CSVDELIMETER << "IPC" << "\n";
+
+    for ( size_t s=0; s<STAGENUM; s++ ) {
+
+        const StageResult &res = results[s];
+
+        cout << stageNames[s] << CSVDELIMETER << (res.seconds * 1e3)
+             << CSVDELIMETER << (res.seconds * 1e9 / rows);
+
+        for ( size_t i=0; i<PERFNUM; i++ ) {
+            cout << CSVDELIMETER;
+            printValue(res.counts[i] / rows);
+        }
+
+        cout << CSVDELIMETER;
+        printValue(res.counts[PERF_INSTRUCTIONS] / res.counts[PERF_CYCLES]);
+        cout << "\n";
+    }
+
+    cout << "\n"
+         << "Real-time point latency [ns]" << CSVDELIMETER
+         << "p50 " << latency.percentile(50) << CSVDELIMETER
+         << "p99 " << latency.percentile(99) << CSVDELIMETER
+         << "p99.9 " << latency.percentile(99.9) << CSVDELIMETER
+         << "max " << latency.val_max() << "\n";
+
+    return EXITOK;
+}
@@ -0,0 +1,155 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: cli.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cli.hpp"
+#include "identification.hpp"
+
+#include <string>
+#include <cstring>
+
+using std::string;
+using std::ostream;
+using std::make_pair;
+
+bool parseCommandLine(int argc, char **argv, CliOptions &opts) {
+
+    for ( int i=1; i<argc; i++ ) {
+
+        const string arg(argv[i]);
+
+        // options with value
+        if ( (arg == "-c") || (arg == "--config") ||
+             (arg == "-i") || (arg == "--input") ||
+             (arg == "-o") || (arg == "--output") ||
+             (arg == "-t") || (arg == "--trace") ||
+             (arg == "-b") || (arg == "--batch") ||
+             (arg == "-s") || (arg == "--set") ) {
+
+            if ( (i + 1) == argc ) {
+                return false;
+            }
+
+            const string value(argv[++i]);
+
+            if ( (arg == "-c") || (arg == "--config") ) {
+                opts.configFile = value;
+                opts.configGiven = true;
+            }
+            else if ( (arg == "-i") || (arg == "--input") ) {
+                opts.parameters.push_back(make_pair(string("srcFile"), value));
+            }
+            else if ( (arg == "-o") || (arg == "--output") ) {
+                opts.parameters.push_back(make_pair(string("outDir"), value));
+            }
+            else if ( (arg == "-t") || (arg == "--trace") ) {
+                opts.parameters.push_back(make_pair(string("traceFile"), value));
+            }
+            else if ( (arg == "-b") || (arg == "--batch") ) {
+                opts.parameters.push_back(make_pair(string("batchList"), value));
+            }
+            else {
+
+                const size_t pos = value.find(PARAMDELIMITER);
+
+                if ( (pos == string::npos) || (pos == 0) ) {
+                    return false;
+                }
+
+                opts.parameters.push_back(make_pair(value.substr(0, pos), value.substr(pos + 1)));
+            }
+        }
+        else if ( arg == "--stdout" ) {
+            opts.parameters.push_back(make_pair(string("reportStdout"), string("1")));
+        }
+        else if ( (arg == "-q") || (arg == "--quiet") ) {
+            opts.quiet = true;
+        }
+        else if ( (arg == "-p") || (arg == "--pause") ) {
+            opts.pause = true;
+        }
+        else if ( (arg == "-h") || (arg == "--help") ) {
+            opts.help = true;
+        }
+        else if ( (arg == "-V") || (arg == "--version") ) {
+            opts.version = true;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void printUsage(ostream &out) {
+
+    out << "Usage: " << Identification{}.name() << " [options]\n\n"
+        << "  -c, --config FILE     configuration file (default " << CONFIGFILE << ")\n"
+        << "  -i, --input FILE      source data file (default " << SRCDATAFILE << ")\n"
+        << "  -o, --output DIR      directory of reports (default current directory)\n"
+        << "  -t, --trace FILE      timeline of calculation in Chrome trace-event format\n"
+        << "  -b, --batch FILE      calculate every source data file listed in FILE,\n"
+        << "                        restart skips finished files\n"
+        << "  -s, --set NAME=VALUE  configuration parameter, overrides configuration file\n"
+        << "      --stdout          calculation report to standard output,\n"
+        << "                        messages to standard error\n"
+        << "  -q, --quiet           print error messages only\n"
+        << "  -p, --pause           wait for Enter before exit\n"
+        << "  -h, --help            print this help\n"
+        << "  -V, --version         print version and license\n\n"
+        << "Exit codes: " << EXITOK << " - success, " << EXITFAILED << " - calculation failed, "
+        << EXITUSAGE << " - wrong command line, " << EXITCONFIG << " - wrong configuration.\n";
+}
+
+void printVersion(ostream &out) {
+
+    out << Identification{}.name() << " v" << Identification{}.version() << "\n"
+        << Identification{}.description() << "\n\n"
+        << "Copyright (C) " << Identification{}.copyrightYears() << " " << Identification{}.authors() << "\n\n"
+        << Identification{}.licenseInformation() << "\n";
+}
+
+ErrorFilterBuf::ErrorFilterBuf(std::streambuf *target) :
+    m_target(target) {
+}
+
+ErrorFilterBuf::int_type ErrorFilterBuf::overflow(int_type c) {
+
+    if ( traits_type::eq_int_type(c, traits_type::eof()) ) {
+        return traits_type::not_eof(c);
+    }
+
+    m_line += traits_type::to_char_type(c);
+
+    if ( traits_type::to_char_type(c) == '\n' ) {
+
+        if ( m_line.compare(0, std::strlen(ERRORMSGBLANK), ERRORMSGBLANK) == 0 ) {
+            m_target->sputn(m_line.data(), static_cast<std::streamsize>(m_line.size()));
+        }
+
+        m_line.clear();
+    }
+
+    return c;
+}
+
+int ErrorFilterBuf::sync() {
+    return m_target->pubsync();
+}
@@ -0,0 +1,75 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: cli.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CLI_HPP
+#define CLI_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <streambuf>
+
+#include "constants.hpp"
+
+//
+// Command line options. Options of paths and output are converted to
+// configuration parameters, they override the configuration file.
+//
+
+struct CliOptions {
+    std::string configFile = CONFIGFILE;
+    bool configGiven = false;
+    std::vector< std::pair<std::string, std::string> > parameters;
+    bool quiet = false;
+    bool pause = false;
+    bool help = false;
+    bool version = false;
+};
+
+bool parseCommandLine(int, char **, CliOptions &);
+void printUsage(std::ostream &);
+void printVersion(std::ostream &);
+
+//
+// Stream buffer passing only error messages (lines starting with
+// ERRORMSGBLANK) to the target buffer. It replaces std::cout buffer
+// in quiet mode.
+//
+
+class ErrorFilterBuf : public std::streambuf {
+
+public:
+
+    ErrorFilterBuf(std::streambuf *target);
+
+protected:
+
+    int_type overflow(int_type);
+    int sync();
+
+private:
+
+    std::streambuf *m_target;
+    std::string m_line;
+
+};
+
+#endif // CLI_HPP
@@ -0,0 +1,549 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: comparison.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comparison.hpp"
+#include "constants.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+#include "numparser.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::unordered_map;
+using std::cout;
+using std::setprecision;
+
+const size_t Comparison::NOMATCH;
+
+namespace {
+
+uint64_t binKey(int64_t bn, int64_t bm) {
+    return (static_cast<uint64_t>(bn) << 32) ^ (static_cast<uint64_t>(bm) & 0xffffffff);
+}
+
+const int64_t binOrder[9][2] = {
+    { 0,  0}, {-1,  0}, { 1,  0}, { 0, -1}, { 0,  1},
+    {-1, -1}, {-1,  1}, { 1, -1}, { 1,  1}
+};
+
+} // namespace
+
+Comparison::Comparison(const shared_ptr<Configuration> &conf) :
+    m_conf(conf),
+    m_binN(conf->val_compareBinN()),
+    m_binMe(conf->val_compareBinMe()) {
+
+    if ( !(m_binN > 0) ) {
+        m_binN = 1;
+    }
+
+    if ( !(m_binMe > 0) ) {
+        m_binMe = 1;
+    }
+}
+
+bool Comparison::calculate() {
+
+    if ( !loadReport(m_conf->val_compareBase(), m_base) ||
+         !loadReport(m_conf->val_compareTest(), m_test) ) {
+        return false;
+    }
+
+    match();
+    difference();
+
+    return true;
+}
+
+bool Comparison::loadReport(const string &fileName, ResultSet &rs) {
+
+    GzLineReader fin;
+
+    if ( !fin.open(fileName) ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to read!\n";
+        return false;
+    }
+
+    rs.fileName = fileName;
+
+    string str;
+
+    while ( fin.getline(str) && (str != "Calculation results") ) {
+    }
+
+    // caption of results table is the first non-empty row
+    while ( fin.getline(str) && str.empty() ) {
+    }
+
+    if ( str.empty() ) {
+        cout << ERRORMSGBLANK << "No calculation results in file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    const char delim = CSVDELIMETER[0];
+
+    // file column -> 0 for n, 1 for Me, 2 + k for result k
+    const size_t NOCOL = size_t(-1);
+    vector<size_t> colMap;
+
+    size_t pos = 0;
+
+    while ( true ) {
+
+        const size_t next = str.find(delim, pos);
+        const string caption = str.substr(pos, (next == string::npos) ? string::npos : (next - pos));
+
+        size_t col = NOCOL;
+
+        if ( caption == colCaptions[NCOL] ) {
+            col = 0;
+        }
+        else if ( caption == colCaptions[MECOL] ) {
+            col = 1;
+        }
+        else {
+            for ( size_t k=0; k<resCaptions.size(); k++ ) {
+                if ( caption == resCaptions[k] ) {
+                    col = 2 + k;
+                    break;
+                }
+            }
+        }
+
+        colMap.push_back(col);
+
+        if ( next == string::npos ) {
+            break;
+        }
+
+        pos = next + 1;
+    }
+
+    vector<bool> present(2 + resCaptions.size(), false);
+
+    for ( size_t c=0; c<colMap.size(); c++ ) {
+        if ( colMap[c] != NOCOL ) {
+            present[colMap[c]] = true;
+        }
+    }
+
+    rs.present.assign(present.begin() + 2, present.end());
+
+    if ( !present[0] || !present[1] ) {
+        cout << ERRORMSGBLANK << "No operating point columns in file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    vector<double> row(2 + resCaptions.size());
+
+    while ( fin.getline(str) && !str.empty() ) {
+
+        const char *first = str.data();
+        const char *end = first + str.size();
+
+        for ( size_t c=0; c<row.size(); c++ ) {
+            row[c] = std::numeric_limits<double>::quiet_NaN();
+        }
+
+        size_t k = 0;
+
+        while ( true ) {
+
+            const char *last = first;
+
+            while ( (last != end) && (*last != delim) ) {
+                last++;
+            }
+
+            if ( (k < colMap.size()) && (colMap[k] != NOCOL) ) {
+                parseNumber(first, last, row[colMap[k]]);
+            }
+
+            k++;
+
+            if ( last == end ) {
+                break;
+            }
+
+            first = last + 1;
+        }
+
+        rs.ma_n.push_back(row[0]);
+        rs.ma_Me.push_back(row[1]);
+
+        rs.ma_res.insert(rs.ma_res.end(), row.begin() + 2, row.end());
+    }
+
+    rs.n = rs.ma_n.size();
+
+    return true;
+}
+
+void Comparison::match() {
+
+    // base rows sorted by bin, hash table gives range of every bin
+    vector< std::pair<uint64_t, size_t> > keys(m_base.n);
+
+    for ( size_t i=0; i<m_base.n; i++ ) {
+        keys[i].first = binKey(std::llround(m_base.ma_n[i] / m_binN), std::llround(m_base.ma_Me[i] / m_binMe));
+        keys[i].second = i;
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    unordered_map<uint64_t, Bin> bins;
+    bins.reserve(m_base.n);
+
+    for ( size_t b=0; b<keys.size(); ) {
+
+        size_t e = b;
+
+        while ( (e < keys.size()) && (keys[e].first == keys[b].first) ) {
+            e++;
+        }
+
+        Bin &bin = bins[keys[b].first];
+        bin.begin = b;
+        bin.end = e;
+
+        // dense bins are searched by k-d tree instead of scanning
+        if ( (e - b) > BINSCANMAX ) {
+
+            for ( size_t k=b; k<e; k++ ) {
+                bin.rows.push_back(keys[k].second);
+            }
+
+            // stable sort keeps order of rows of every point
+            std::stable_sort(bin.rows.begin(), bin.rows.end(), [this](size_t r1, size_t r2) {
+                return (m_base.ma_n[r1] < m_base.ma_n[r2]) ||
+                       ((m_base.ma_n[r1] == m_base.ma_n[r2]) && (m_base.ma_Me[r1] < m_base.ma_Me[r2]));
+            });
+
+            vector<KdTree2::Point> points;
+
+            for ( size_t k=0; k<bin.rows.size(); k++ ) {
+
+                const size_t i = bin.rows[k];
+
+                if ( (k == 0) || (m_base.ma_n[i] != m_base.ma_n[bin.rows[k - 1]]) ||
+                     (m_base.ma_Me[i] != m_base.ma_Me[bin.rows[k - 1]]) ) {
+
+                    KdTree2::Point p = {m_base.ma_n[i] / m_binN, m_base.ma_Me[i] / m_binMe, points.size()};
+                    points.push_back(p);
+
+                    bin.groups.push_back(k);
+                }
+            }
+
+            bin.groups.push_back(bin.rows.size());
+            bin.next.assign(bin.groups.begin(), bin.groups.end() - 1);
+
+            bin.tree.reset(new KdTree2());
+            bin.tree->build(points);
+        }
+
+        b = e;
+    }
+
+    m_match.assign(m_test.n, NOMATCH);
+    m_matchedNum = 0;
+
+    // every base row is matched once, repeated operating points are
+    // matched in order of rows
+    vector<bool> used(m_base.n, false);
+
+    KdTree2::Neighbours nb;
+
+    for ( size_t j=0; j<m_test.n; j++ ) {
+
+        const double tn = m_test.ma_n[j] / m_binN;
+        const double tm = m_test.ma_Me[j] / m_binMe;
+
+        const int64_t bn = std::llround(tn);
+        const int64_t bm = std::llround(tm);
+
+        double best = 1; // squared distance in bins
+        size_t bestRow = NOMATCH;
+
+        Bin *bestBin = nullptr; // dense bin and point of the best row
+        size_t bestGroup = 0;
+
+        // closer unused row, equal distance goes to the first row
+        auto better = [&](double d, size_t i) {
+            return !used[i] && ((d < best) || ((d == best) && ((bestRow == NOMATCH) || (i < bestRow))));
+        };
+
+        // own bin first, neighbouring bins only if they can have a closer point
+        for ( size_t nbin=0; nbin<9; nbin++ ) {
+
+            const int64_t dn = binOrder[nbin][0];
+            const int64_t dm = binOrder[nbin][1];
+
+            const double en = std::max(0.0, std::fabs(tn - bn - dn) - 0.5);
+            const double em = std::max(0.0, std::fabs(tm - bm - dm) - 0.5);
+
+            if ( (en * en + em * em) > best ) {
+                continue;
+            }
+
+            unordered_map<uint64_t, Bin>::iterator it = bins.find(binKey(bn + dn, bm + dm));
+
+            if ( it == bins.end() ) {
+                continue;
+            }
+
+            Bin &bin = it->second;
+
+            if ( bin.tree ) {
+
+                // the tree has only points with unused rows, so the nearest
+                // one is enough unless it is farther than the best row, then
+                // the number of neighbours grows only for equal distances
+                for ( size_t k=1; ; k*=2 ) {
+
+                    bin.tree->nearest(tn, tm, k, nb);
+
+                    for ( size_t q=0; q<nb.size(); q++ ) {
+
+                        const size_t g = nb[q].second;
+
+                        if ( better(nb[q].first, bin.rows[bin.next[g]]) ) {
+                            best = nb[q].first;
+                            bestRow = bin.rows[bin.next[g]];
+                            bestBin = &bin;
+                            bestGroup = g;
+                        }
+                    }
+
+                    if ( (nb.size() < k) || (nb.back().first >= best) ) {
+                        break;
+                    }
+                }
+
+                continue;
+            }
+
+            for ( size_t k=bin.begin; k<bin.end; k++ ) {
+
+                const size_t i = keys[k].second;
+
+                const double en = m_base.ma_n[i] / m_binN - tn;
+                const double em = m_base.ma_Me[i] / m_binMe - tm;
+                const double d = en * en + em * em;
+
+                if ( better(d, i) ) {
+                    best = d;
+                    bestRow = i;
+                    bestBin = nullptr;
+                }
+            }
+        }
+
+        m_match[j] = bestRow;
+
+        if ( bestRow != NOMATCH ) {
+
+            used[bestRow] = true;
+            m_matchedNum++;
+
+            if ( bestBin && (++bestBin->next[bestGroup] == bestBin->groups[bestGroup + 1]) ) {
+                bestBin->tree->remove(m_base.ma_n[bestRow] / m_binN, m_base.ma_Me[bestRow] / m_binMe, bestGroup);
+            }
+        }
+    }
+}
+
+void Comparison::difference() {
+
+    // result columns present in both reports
+    m_cols.clear();
+
+    for ( size_t k=0; k<resCaptions.size(); k++ ) {
+        if ( m_base.present[k] && m_test.present[k] ) {
+            m_cols.push_back(k);
+        }
+    }
+
+    const size_t colNum = m_cols.size();
+    const size_t resNum = resCaptions.size();
+
+    ma_diff.assign(m_test.n * colNum, std::numeric_limits<double>::quiet_NaN());
+    m_stats.assign(colNum, DiffStats());
+
+    // rows are visited once, every matched base row is read as a whole
+    for ( size_t j=0; j<m_test.n; j++ ) {
+
+        if ( m_match[j] == NOMATCH ) {
+            continue;
+        }
+
+        const double *a = &m_base.ma_res[m_match[j] * resNum];
+        const double *b = &m_test.ma_res[j * resNum];
+
+        for ( size_t c=0; c<colNum; c++ ) {
+
+            const double d = b[m_cols[c]] - a[m_cols[c]];
+
+            ma_diff[j * colNum + c] = d;
+
+            if ( !std::isfinite(d) ) {
+                continue;
+            }
+
+            DiffStats &st = m_stats[c];
+
+            // Welford's algorithm
+            st.num++;
+            const double delta = d - st.mean;
+            st.mean += delta / st.num;
+            st.m2 += delta * (d - st.mean);
+
+            st.absSum += std::fabs(d);
+            st.absMax = std::max(st.absMax, std::fabs(d));
+
+            if ( a[m_cols[c]] != 0 ) {
+                st.relSum += d / std::fabs(a[m_cols[c]]) * 100;
+                st.relNum++;
+            }
+        }
+    }
+}
+
+bool Comparison::createReport() const {
+
+    const string fileName = reportFileName(CMPREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n"
+         << "Comparison of calculation reports\n\n"
+         << "Base report" << CSVDELIMETER << m_base.fileName << CSVDELIMETER << m_base.n << " rows\n"
+         << "Tested report" << CSVDELIMETER << m_test.fileName << CSVDELIMETER << m_test.n << " rows\n"
+         << "Bin of n" << CSVDELIMETER << m_binN << CSVDELIMETER << "min-1\n"
+         << "Bin of Me" << CSVDELIMETER << m_binMe << CSVDELIMETER << "Nm\n"
+         << "Matched rows" << CSVDELIMETER << m_matchedNum << "\n\n";
+
+    fout << "Summary of differences (tested - base)\n\n"
+         << "Parameter" << CSVDELIMETER
+         << "Points" << CSVDELIMETER
+         << "Mean" << CSVDELIMETER
+         << "Standard deviation" << CSVDELIMETER
+         << "Mean absolute" << CSVDELIMETER
+         << "Max absolute" << CSVDELIMETER
+         << "Mean relative[%]" << "\n";
+
+    for ( size_t c=0; c<m_cols.size(); c++ ) {
+
+        const DiffStats &st = m_stats[c];
+
+        fout << resCaptions[m_cols[c]] << CSVDELIMETER << st.num << CSVDELIMETER;
+
+        if ( st.num > 0 ) {
+            fout << setprecision(6) << st.mean << CSVDELIMETER
+                 << ((st.num > 1) ? std::sqrt(st.m2 / (st.num - 1)) : 0) << CSVDELIMETER
+                 << (st.absSum / st.num) << CSVDELIMETER
+                 << st.absMax << CSVDELIMETER;
+
+            if ( st.relNum > 0 ) {
+                fout << (st.relSum / st.relNum);
+            }
+        }
+
+        fout << "\n";
+    }
+
+    fout << "\n" << "Differences in matched operating points (tested - base)\n\n"
+         << colCaptions[NCOL] << CSVDELIMETER
+         << colCaptions[MECOL] << CSVDELIMETER
+         << "base " << colCaptions[NCOL] << CSVDELIMETER
+         << "base " << colCaptions[MECOL];
+
+    for ( size_t c=0; c<m_cols.size(); c++ ) {
+        fout << CSVDELIMETER << "d" << resCaptions[m_cols[c]];
+    }
+
+    fout << "\n";
+
+    // rows are formatted by formatFixed(), it is much faster than stream manipulators
+    string line;
+    char num[FIXEDBUFSIZE];
+
+    for ( size_t j=0; j<m_test.n; j++ ) {
+
+        const size_t i = m_match[j];
+
+        line.assign(num, formatFixed(m_test.ma_n[j], 0, num));
+        line += CSVDELIMETER;
+        line.append(num, formatFixed(m_test.ma_Me[j], 0, num));
+        line += CSVDELIMETER;
+
+        if ( i != NOMATCH ) {
+
+            line.append(num, formatFixed(m_base.ma_n[i], 0, num));
+            line += CSVDELIMETER;
+            line.append(num, formatFixed(m_base.ma_Me[i], 0, num));
+
+            for ( size_t c=0; c<m_cols.size(); c++ ) {
+
+                const double d = ma_diff[j * m_cols.size() + c];
+
+                line += CSVDELIMETER;
+
+                if ( std::isfinite(d) ) {
+                    line.append(num, formatFixed(d, 4, num));
+                }
+            }
+        }
+        else {
+            line += CSVDELIMETER;
+        }
+
+        line += "\n";
+        fout.write(line.data(), line.size());
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\"created.\n";
+
+    return true;
+}
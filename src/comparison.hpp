@@ -0,0 +1,107 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: comparison.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPARISON_HPP
+#define COMPARISON_HPP
+
+#include <vector>
+#include <memory>
+#include <string>
+
+#include "configuration.hpp"
+#include "kdtree.hpp"
+
+//
+// Comparison of two calculation reports. Operating points of the tested
+// report are matched with the base report by hash join on n and Me bins
+// (compareBinN, compareBinMe); the nearest base point in the same or a
+// neighbouring bin within one bin width is used. Matching is one-to-one:
+// tested rows are matched in order, every base point is used once and
+// repeated operating points are matched in order of rows. Bins with many
+// points are searched by k-d tree of distinct points.
+//
+
+class Comparison {
+
+public:
+
+    Comparison(const std::shared_ptr<Configuration> &conf);
+
+    bool calculate();
+    bool createReport() const;
+
+private:
+
+    struct ResultSet {
+        std::string fileName;
+        size_t n = 0;
+        std::vector<double> ma_n;
+        std::vector<double> ma_Me;
+        std::vector<double> ma_res; // n * resCaptions.size() elements, row by row
+        std::vector<bool> present;  // result columns found in report
+    };
+
+    // dense bin has a tree of distinct points, rows of every point are
+    // consumed in order and the point is removed from the tree after its last row
+    struct Bin {
+        size_t begin = 0;
+        size_t end = 0;
+        std::shared_ptr<KdTree2> tree;
+        std::vector<size_t> rows;   // rows grouped by point
+        std::vector<size_t> groups; // begin of every point in rows and the end
+        std::vector<size_t> next;   // first unused row of every point
+    };
+
+    struct DiffStats {
+        size_t num = 0;
+        size_t relNum = 0;
+        double mean = 0;
+        double m2 = 0;
+        double absSum = 0;
+        double absMax = 0;
+        double relSum = 0;
+    };
+
+    static bool loadReport(const std::string &, ResultSet &);
+
+    void match();
+    void difference();
+
+    std::shared_ptr<Configuration> m_conf;
+
+    double m_binN = 50;
+    double m_binMe = 20;
+
+    ResultSet m_base;
+    ResultSet m_test;
+
+    std::vector<size_t> m_match; // base row of every test row or NOMATCH
+    size_t m_matchedNum = 0;
+
+    std::vector<size_t> m_cols;      // result columns present in both reports
+    std::vector<double> ma_diff;     // m_test.n * m_cols.size() differences, row by row
+    std::vector<DiffStats> m_stats;  // per column of m_cols
+
+    static const size_t NOMATCH = size_t(-1);
+    static const size_t BINSCANMAX = 16;
+
+};
+
+#endif // COMPARISON_HPP
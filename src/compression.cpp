@@ -0,0 +1,314 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: compression.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "compression.hpp"
+#include "constants.hpp"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+
+// size of data block compressed at once
+#define GZBLOCKSIZE  (1 << 20)
+// number of blocks waiting for compression
+#define GZQUEUEDEPTH 8
+// fastest compression level, report writing must not be slower than disk
+#define GZLEVEL      1
+
+GzOStreamBuf::GzOStreamBuf() :
+    m_failed(false) {
+}
+
+GzOStreamBuf::~GzOStreamBuf() {
+    close();
+}
+
+bool GzOStreamBuf::open(const string &fileName, int level) {
+
+    if ( m_file ) {
+        return false;
+    }
+
+    const string mode = "wb" + std::to_string(level);
+    m_file = gzopen(fileName.c_str(), mode.c_str());
+
+    if ( !m_file ) {
+        return false;
+    }
+
+    gzbuffer(m_file, GZBLOCKSIZE);
+
+    m_failed = false;
+    m_stop = false;
+
+    m_block.resize(GZBLOCKSIZE);
+    setp(m_block.data(), m_block.data() + m_block.size());
+
+    m_writer = std::thread(&GzOStreamBuf::writeBlocks, this);
+
+    return true;
+}
+
+bool GzOStreamBuf::close() {
+
+    if ( !m_file ) {
+        return false;
+    }
+
+    pushBlock();
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cond.notify_all();
+    m_writer.join();
+
+    if ( gzclose(m_file) != Z_OK ) {
+        m_failed = true;
+    }
+
+    m_file = nullptr;
+    setp(nullptr, nullptr);
+
+    return !m_failed;
+}
+
+GzOStreamBuf::int_type GzOStreamBuf::overflow(int_type c) {
+
+    if ( !m_file ) {
+        return traits_type::eof();
+    }
+
+    pushBlock();
+
+    if ( !traits_type::eq_int_type(c, traits_type::eof()) ) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return m_failed ? traits_type::eof() : traits_type::not_eof(c);
+}
+
+int GzOStreamBuf::sync() {
+
+    // data is flushed on close only, compression of small blocks is inefficient
+    return m_failed ? -1 : 0;
+}
+
+void GzOStreamBuf::pushBlock() {
+
+    const size_t filled = pptr() - pbase();
+
+    if ( filled == 0 ) {
+        return;
+    }
+
+    m_block.resize(filled);
+
+    unique_lock<mutex> lock(m_mutex);
+
+    // memory is bounded by queue depth
+    m_cond.wait(lock, [this]() { return m_queue.size() < GZQUEUEDEPTH; });
+
+    m_queue.push_back(std::move(m_block));
+
+    if ( !m_free.empty() ) {
+        m_block = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    else {
+        m_block = vector<char>();
+    }
+
+    lock.unlock();
+    m_cond.notify_all();
+
+    m_block.resize(GZBLOCKSIZE);
+    setp(m_block.data(), m_block.data() + m_block.size());
+}
+
+void GzOStreamBuf::writeBlocks() {
+
+    while ( true ) {
+
+        vector<char> block;
+
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+
+            if ( m_queue.empty() ) {
+                return;
+            }
+
+            block = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        m_cond.notify_all();
+
+        if ( gzwrite(m_file, block.data(), static_cast<unsigned>(block.size())) != static_cast<int>(block.size()) ) {
+            m_failed = true;
+        }
+
+        lock_guard<mutex> lock(m_mutex);
+        m_free.push_back(std::move(block));
+    }
+}
+
+std::streamsize StdoutStreamBuf::xsputn(const char *s, std::streamsize n) {
+    return static_cast<std::streamsize>(std::fwrite(s, 1, static_cast<size_t>(n), stdout));
+}
+
+StdoutStreamBuf::int_type StdoutStreamBuf::overflow(int_type c) {
+
+    if ( traits_type::eq_int_type(c, traits_type::eof()) ) {
+        return traits_type::not_eof(c);
+    }
+
+    return (std::fputc(c, stdout) == EOF) ? traits_type::eof() : c;
+}
+
+int StdoutStreamBuf::sync() {
+    return ((std::fflush(stdout) == 0) && !std::ferror(stdout)) ? 0 : -1;
+}
+
+ReportStream::ReportStream(const string &fileName, size_t compression) :
+    std::ostream(nullptr),
+    m_compression(compression),
+    m_stdout(fileName == STDOUTNAME) {
+
+    if ( m_stdout ) {
+        rdbuf(&m_stdoutbuf);
+    }
+    else if ( m_compression == COMPRESSION_GZIP ) {
+        if ( m_gzbuf.open(fileName, GZLEVEL) ) {
+            rdbuf(&m_gzbuf);
+        }
+    }
+    else if ( m_compression == COMPRESSION_NONE ) {
+        if ( m_filebuf.open(fileName, std::ios_base::out | std::ios_base::trunc) ) {
+            rdbuf(&m_filebuf);
+        }
+    }
+
+    // unknown compression is never written as a plain file
+    if ( !rdbuf() ) {
+        setstate(std::ios_base::failbit);
+    }
+}
+
+bool ReportStream::close() {
+
+    if ( !rdbuf() ) {
+        return false;
+    }
+
+    flush();
+
+    bool ok = false;
+
+    if ( m_stdout ) {
+        ok = (m_stdoutbuf.pubsync() == 0);
+    }
+    else if ( m_compression == COMPRESSION_GZIP ) {
+        ok = m_gzbuf.close();
+    }
+    else {
+        ok = (m_filebuf.close() != nullptr);
+    }
+
+    if ( !ok ) {
+        setstate(std::ios_base::failbit);
+    }
+
+    return ok && good();
+}
+
+GzLineReader::GzLineReader() :
+    m_buf(1 << 16) {
+}
+
+GzLineReader::~GzLineReader() {
+    close();
+}
+
+bool GzLineReader::open(const string &fileName) {
+
+    close();
+
+    // plain files are read transparently
+    m_file = gzopen(fileName.c_str(), "rb");
+
+    if ( !m_file ) {
+        return false;
+    }
+
+    gzbuffer(m_file, 1 << 18);
+
+    return true;
+}
+
+bool GzLineReader::getline(string &s) {
+
+    s.clear();
+
+    if ( !m_file ) {
+        return false;
+    }
+
+    bool read = false;
+
+    while ( gzgets(m_file, m_buf.data(), static_cast<int>(m_buf.size())) ) {
+
+        read = true;
+
+        const size_t len = strlen(m_buf.data());
+        s.append(m_buf.data(), len);
+
+        if ( (len > 0) && (m_buf[len-1] == '\n') ) {
+            s.erase(s.size()-1);
+            break;
+        }
+    }
+
+    if ( !s.empty() && (s[s.size()-1] == '\r') ) {
+        s.erase(s.size()-1);
+    }
+
+    return read;
+}
+
+void GzLineReader::close() {
+
+    if ( m_file ) {
+        gzclose(m_file);
+        m_file = nullptr;
+    }
+}
@@ -0,0 +1,146 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: compression.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <streambuf>
+#include <ostream>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <atomic>
+
+#include <zlib.h>
+
+//
+// Stream buffer writing gzip file. Filled blocks are compressed and
+// written by a background thread, so the writing thread only copies data.
+//
+
+class GzOStreamBuf : public std::streambuf {
+
+public:
+
+    GzOStreamBuf();
+    ~GzOStreamBuf();
+
+    bool open(const std::string &, int);
+    bool close();
+    bool is_open() const {
+        return m_file != nullptr;
+    }
+
+protected:
+
+    int_type overflow(int_type);
+    int sync();
+
+private:
+
+    GzOStreamBuf(const GzOStreamBuf &) = delete;
+    GzOStreamBuf &operator=(const GzOStreamBuf &) = delete;
+
+    void pushBlock();
+    void writeBlocks();
+
+    gzFile m_file = nullptr;
+    std::atomic<bool> m_failed;
+    bool m_stop = false;
+
+    std::vector<char> m_block;
+    std::deque< std::vector<char> > m_queue;
+    std::vector< std::vector<char> > m_free;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_writer;
+
+};
+
+//
+// Stream buffer writing standard output through C stdio, so a report
+// can be written there while std::cout is redirected to messages.
+//
+
+class StdoutStreamBuf : public std::streambuf {
+
+protected:
+
+    std::streamsize xsputn(const char *, std::streamsize);
+    int_type overflow(int_type);
+    int sync();
+
+};
+
+//
+// Output stream of report file, compressed or not. File name STDOUTNAME
+// means standard output, it is never compressed.
+//
+
+class ReportStream : public std::ostream {
+
+public:
+
+    ReportStream(const std::string &, size_t);
+
+    bool close();
+
+private:
+
+    std::filebuf m_filebuf;
+    GzOStreamBuf m_gzbuf;
+    StdoutStreamBuf m_stdoutbuf;
+    size_t m_compression;
+    bool m_stdout;
+
+};
+
+//
+// Reading text lines of a gzip compressed or plain file.
+//
+
+class GzLineReader {
+
+public:
+
+    GzLineReader();
+    ~GzLineReader();
+
+    bool open(const std::string &);
+    bool getline(std::string &);
+    void close();
+
+private:
+
+    GzLineReader(const GzLineReader &) = delete;
+    GzLineReader &operator=(const GzLineReader &) = delete;
+
+    gzFile m_file = nullptr;
+    std::vector<char> m_buf;
+
+};
+
+#endif // COMPRESSION_HPP
@@ -21,15 +21,15 @@
 #include "configuration.hpp"
 #include "constants.hpp"
 #include "identification.hpp"
+#include "auxfunctions.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
+#include <memory>
+#include <utility>
 
-#define BOOST_NO_CXX11_SCOPED_ENUMS
-
-#include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -38,33 +38,62 @@ using std::string;
 using std::vector;
 using std::ifstream;
 using std::ofstream;
+using std::shared_ptr;
+using std::pair;
+using std::make_pair;
+
+namespace {
+
+// lexical_cast<size_t> wraps negative values around
+size_t unsignedValue(const string &value) {
+
+    if ( boost::trim_copy(value).compare(0, 1, "-") == 0 ) {
+        throw boost::bad_lexical_cast();
+    }
+
+    return boost::lexical_cast<size_t>(value);
+}
+
+size_t boundedValue(const string &name, const string &value, size_t min, size_t max) {
+
+    const size_t v = unsignedValue(value);
+
+    if ( (v < min) || (v > max) ) {
+        throw ConfigError("Parameter \"" + name + "\" must be from " + boost::lexical_cast<string>(min) +
+                          " to " + boost::lexical_cast<string>(max) + "!");
+    }
 
-Configuration::Configuration() {
+    return v;
 }
 
-void Configuration::readConfigFile() {
+} // namespace
 
-    const boost::filesystem::path cfgfile(CONFIGFILE);
+Configuration::Configuration() :
+    m_mcTolerances(colCaptions.size(), 0) {
+}
+
+bool Configuration::readConfigFile(const string &fileName) {
+
+    m_configFile = fileName;
 
-    if ( !boost::filesystem::exists(cfgfile) ) {
+    if ( !fileExists(fileName) ) {
 
-        cout << ERRORMSGBLANK << "Cofiguration file \"" << CONFIGFILE << "\" not found!\n"
+        cout << ERRORMSGBLANK << "Cofiguration file \"" << fileName << "\" not found!\n"
              << MSGBLANK << Identification{}.name() << " will create blank of configuration.\n"
-             << MSGBLANK << "Please edit file \"" << CONFIGFILE << "\".\n";
+             << MSGBLANK << "Please edit file \"" << fileName << "\".\n";
 
-        if ( !createBlank() ) {
-            cout << ERRORMSGBLANK << "Can not create file \"" << CONFIGFILE << "\"!\n"
-                 << WARNMSGBLANK << "Default values will be used.\n";
+        if ( !createBlank(fileName) ) {
+            cout << ERRORMSGBLANK << "Can not create file \"" << fileName << "\"!\n";
         }
 
-        return;
+        return false;
     }
 
-    ifstream fin(CONFIGFILE);
+    ifstream fin(fileName.c_str());
 
     if ( !fin ) {
-        cout << ERRORMSGBLANK << "Can not open file \"" << CONFIGFILE << "\" to read!\n";
-        return;
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to read!\n";
+        return false;
     }
 
     string s;
@@ -74,8 +103,25 @@ void Configuration::readConfigFile() {
 
         getline(fin, s);
 
+        // comments are not parameters even if they contain the delimiter
+        if ( s.compare(0, 2, "//") == 0 ) {
+            s.clear();
+            continue;
+        }
+
         if ( !s.empty() ) {
 
+            // "[name]" starts a configuration profile, parameters of profile
+            // override common parameters written before the first profile
+            if ( (s[0] == '[') && (s[s.size()-1] == ']') ) {
+
+                m_profiles.push_back(make_pair(s.substr(1, s.size()-2), vector< pair<string, string> >()));
+
+                s.clear();
+
+                continue;
+            }
+
             boost::split(elem, s, boost::is_any_of(PARAMDELIMITER));
 
             if ( elem.size() != 2 ) {
@@ -86,56 +132,13 @@ void Configuration::readConfigFile() {
                 continue;
             }
 
-            if ( elem[0] == "testObjDescr" ) {
-                m_testObjDescr = elem[1];
-            }
-            else if ( elem[0] == "acTypelp" ) {
-                m_acType_lp = boost::lexical_cast<size_t>(elem[1]);
-            }
-            else if ( elem[0] == "acTypehp" ) {
-                m_acType_hp = boost::lexical_cast<size_t>(elem[1]);
-            }
-            else if ( elem[0] == "B0_std" ) {
-                m_B0_std = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "T0_std" ) {
-                m_T0_std = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "Vh" ) {
-                m_Vh = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F1_S" ) {
-                m_F1_S = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F2_Pklp" ) {
-                m_F2_Pklp = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F3_Pkslp" ) {
-                m_F3_Pkslp = boost::lexical_cast<double>(elem[1]);
+            if ( m_profiles.empty() ) {
+                if ( !setParameter(elem[0], elem[1]) ) {
+                    cout << WARNMSGBLANK << "Unknown parameter \"" << elem[0] << "\" in file \"" << fileName << "\"! Skipped.\n";
+                }
             }
-            else if ( elem[0] == "F4_Pkhp" ) {
-                m_F4_Pkhp = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F5_Pkshp" ) {
-                m_F5_Pkshp = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F6_Pthp" ) {
-                m_F6_Pthp = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F7_Ptlp" ) {
-                m_F7_Ptlp = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "F8_Pr" ) {
-                m_F8_Pr = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "sysNum" ) {
-                m_sysNum = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "pipeNumHpOut" ) {
-                m_pipeNumHpOut = boost::lexical_cast<double>(elem[1]);
-            }
-            else if ( elem[0] == "pipeNumHpIn" ) {
-                m_pipeNumHpIn = boost::lexical_cast<double>(elem[1]);
+            else {
+                m_profiles.back().second.push_back(make_pair(elem[0], elem[1]));
             }
         }
 
@@ -144,14 +147,320 @@ void Configuration::readConfigFile() {
     }
 
     fin.close();
+
+    return true;
+}
+
+void Configuration::overrideParameter(const string &name, const string &value) {
+
+    if ( !setParameter(name, value) ) {
+        throw ConfigError("Unknown configuration parameter \"" + name + "\"!");
+    }
+
+    m_overrides.push_back(make_pair(name, value));
+}
+
+bool Configuration::setParameter(const string &name, const string &value) {
+
+    try {
+        return assignParameter(name, value);
+    }
+    catch ( const boost::bad_lexical_cast & ) {
+        throw ConfigError("Wrong value \"" + value + "\" of configuration parameter \"" + name + "\"!");
+    }
+}
+
+bool Configuration::assignParameter(const string &name, const string &value) {
+
+    if ( name == "srcFile" ) {
+        m_srcFile = value;
+    }
+    else if ( name == "outDir" ) {
+        m_outDir = value;
+    }
+    else if ( name == "reportStdout" ) {
+        m_reportStdout = unsignedValue(value);
+    }
+    else if ( name == "traceFile" ) {
+        m_traceFile = value;
+    }
+    else if ( name == "testObjDescr" ) {
+        m_testObjDescr = value;
+    }
+    else if ( name == "acTypelp" ) {
+        m_acType_lp = unsignedValue(value);
+    }
+    else if ( name == "acTypehp" ) {
+        m_acType_hp = unsignedValue(value);
+    }
+    else if ( name == "B0_std" ) {
+        m_B0_std = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "T0_std" ) {
+        m_T0_std = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "Vh" ) {
+        m_Vh = boost::lexical_cast<double>(value);
+    }
+    else if ( stationParam(name) < STATIONNUM ) {
+        m_F[stationParam(name)] = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "sysNum" ) {
+        m_sysNum = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "pipeNumHpOut" ) {
+        m_pipeNumHpOut = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "pipeNumHpIn" ) {
+        m_pipeNumHpIn = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "reportCompression" ) {
+        m_reportCompression = boundedValue(name, value, COMPRESSION_NONE, COMPRESSIONNUM - 1);
+    }
+    else if ( name == "pipeline" ) {
+        m_pipeline = boundedValue(name, value, 0, PIPEMAXTHREADS);
+    }
+    else if ( name == "pipeBlockRows" ) {
+        m_pipeBlockRows = boundedValue(name, value, 1, PIPEMAXBLOCKROWS);
+    }
+    else if ( name == "pipeQueueDepth" ) {
+        m_pipeQueueDepth = boundedValue(name, value, 1, PIPEMAXQUEUEDEPTH);
+    }
+    else if ( name == "ssWindow" ) {
+        m_ssWindow = unsignedValue(value);
+    }
+    else if ( name == "ssMinSamples" ) {
+        m_ssMinSamples = unsignedValue(value);
+    }
+    else if ( name == "ssTolN" ) {
+        m_ssTolN = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "ssTolMe" ) {
+        m_ssTolMe = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "ssTolGair" ) {
+        m_ssTolGair = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "trWindow" ) {
+        m_trWindow = unsignedValue(value);
+    }
+    else if ( name == "trStep" ) {
+        m_trStep = unsignedValue(value);
+    }
+    else if ( name == "mapBuild" ) {
+        m_mapBuild = unsignedValue(value);
+    }
+    else if ( name == "mapGridSize" ) {
+        m_mapGridSize = boundedValue(name, value, 2, MAPMAXGRIDSIZE);
+    }
+    else if ( name == "mapNeighbours" ) {
+        m_mapNeighbours = unsignedValue(value);
+    }
+    else if ( name == "mapContours" ) {
+        m_mapContours = unsignedValue(value);
+    }
+    else if ( name == "compareBase" ) {
+        m_compareBase = value;
+    }
+    else if ( name == "compareTest" ) {
+        m_compareTest = value;
+    }
+    else if ( name == "compareBinN" ) {
+        m_compareBinN = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "compareBinMe" ) {
+        m_compareBinMe = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "storeDir" ) {
+        m_storeDir = value;
+    }
+    else if ( name == "queryResult" ) {
+        m_queryResult = value;
+    }
+    else if ( name == "queryEngine" ) {
+        m_queryEngine = value;
+    }
+    else if ( name == "queryFrom" ) {
+        m_queryFrom = value;
+    }
+    else if ( name == "queryTo" ) {
+        m_queryTo = value;
+    }
+    else if ( name == "queryN" ) {
+        m_queryN = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "queryMe" ) {
+        m_queryMe = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "queryTolN" ) {
+        m_queryTolN = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "queryTolMe" ) {
+        m_queryTolMe = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "mcSamples" ) {
+        m_mcSamples = unsignedValue(value);
+    }
+    else if ( name == "mcThreads" ) {
+        m_mcThreads = unsignedValue(value);
+    }
+    else if ( name == "mcSeed" ) {
+        m_mcSeed = unsignedValue(value);
+    }
+    else if ( name == "mcTolerances" ) {
+
+        vector<string> tols;
+        boost::split(tols, value, boost::is_any_of(CSVDELIMETER));
+
+        if ( tols.size() != colCaptions.size() ) {
+            throw ConfigError("Parameter \"mcTolerances\" must have " +
+                              boost::lexical_cast<string>(colCaptions.size()) + " values!");
+        }
+
+        for ( size_t i=0; i<tols.size(); i++ ) {
+            m_mcTolerances[i] = boost::lexical_cast<double>(tols[i]);
+        }
+    }
+    else if ( name == "saResults" ) {
+
+        m_saResults.clear();
+
+        if ( !value.empty() ) {
+            boost::split(m_saResults, value, boost::is_any_of(CSVDELIMETER));
+        }
+    }
+    else if ( name == "invTarget" ) {
+        m_invTarget = value;
+    }
+    else if ( name == "invValue" ) {
+        m_invValue = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "invUnknown" ) {
+        m_invUnknown = value;
+    }
+    else if ( name == "invFt" ) {
+        m_invFt = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "invThreads" ) {
+        m_invThreads = unsignedValue(value);
+    }
+    else if ( name == "matchGrid" ) {
+        m_matchGrid = boundedValue(name, value, 0, MAPMAXGRIDSIZE);
+    }
+    else if ( name == "matchNMin" ) {
+        m_matchNMin = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "matchNMax" ) {
+        m_matchNMax = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "matchMeMin" ) {
+        m_matchMeMin = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "matchMeMax" ) {
+        m_matchMeMax = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "matchThreads" ) {
+        m_matchThreads = unsignedValue(value);
+    }
+    else if ( name == "rtInput" ) {
+        m_rtInput = value;
+    }
+    else if ( name == "rtOutput" ) {
+        m_rtOutput = value;
+    }
+    else if ( name == "rtCapacity" ) {
+        m_rtCapacity = unsignedValue(value);
+    }
+    else if ( name == "rtPoints" ) {
+        m_rtPoints = unsignedValue(value);
+    }
+    else if ( name == "rtLockMemory" ) {
+        m_rtLockMemory = unsignedValue(value);
+    }
+    else if ( name == "rtTagTime" ) {
+        m_rtTagTime = unsignedValue(value);
+    }
+    else if ( name == "batchList" ) {
+        m_batchList = value;
+    }
+    else if ( name == "statGroups" ) {
+        m_statGroups = unsignedValue(value);
+    }
+    else if ( name == "statBinN" ) {
+        m_statBinN = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "statBinMe" ) {
+        m_statBinMe = boost::lexical_cast<double>(value);
+    }
+    else if ( name == "statThreads" ) {
+        m_statThreads = unsignedValue(value);
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+vector< shared_ptr<Configuration> > Configuration::profiles() const {
+
+    vector< shared_ptr<Configuration> > confs;
+
+    if ( m_profiles.empty() ) {
+        confs.push_back(shared_ptr<Configuration>(new Configuration(*this)));
+        return confs;
+    }
+
+    for ( size_t p=0; p<m_profiles.size(); p++ ) {
+
+        shared_ptr<Configuration> conf(new Configuration(*this));
+
+        conf->m_profileName = m_profiles[p].first;
+        conf->m_profiles.clear();
+
+        for ( size_t i=0; i<m_profiles[p].second.size(); i++ ) {
+            if ( !conf->setParameter(m_profiles[p].second[i].first, m_profiles[p].second[i].second) ) {
+                cout << WARNMSGBLANK << "Unknown parameter \"" << m_profiles[p].second[i].first
+                     << "\" in profile \"" << m_profiles[p].first << "\"! Skipped.\n";
+            }
+        }
+
+        for ( size_t i=0; i<m_overrides.size(); i++ ) {
+            conf->setParameter(m_overrides[i].first, m_overrides[i].second);
+        }
+
+        confs.push_back(conf);
+    }
+
+    return confs;
 }
 
-bool Configuration::createBlank() const {
+string Configuration::stationParamName(size_t st) {
+    return "F" + boost::lexical_cast<string>(st + 1) + "_" + boost::erase_all_copy(stationCaptions[st], "_");
+}
+
+size_t Configuration::stationParam(const string &name) {
 
-    ofstream fout(CONFIGFILE);
+    for ( size_t st=0; st<STATIONNUM; st++ ) {
+        if ( name == stationParamName(st) ) {
+            return st;
+        }
+    }
+
+    return STATIONNUM;
+}
+
+TkrCalcParams Configuration::val_calcParams() const {
+    return tkrCalcParams(m_acType_lp, m_acType_hp, m_B0_std, m_T0_std, m_Vh, m_F,
+                         m_sysNum, m_pipeNumHpOut, m_pipeNumHpIn);
+}
+
+bool Configuration::createBlank(const string &fileName) const {
+
+    ofstream fout(fileName.c_str());
 
     if ( !fout ) {
-        cout << ERRORMSGBLANK << "Can not open file \"" << CONFIGFILE << "\" to write!\n";
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
         return false;
     }
 
@@ -159,10 +468,24 @@ bool Configuration::createBlank() const {
          << "// This is " << Identification{}.name() << " configuration file.\n"
          << "// Parameter-Value delimiter is symbol \"" << PARAMDELIMITER << "\".\n"
          << "// Text after \"//\" is comment.\n"
+         << "// Line \"[name]\" starts configuration profile \"name\". Parameters of profile\n"
+         << "// override parameters written before the first profile. Every profile\n"
+         << "// is calculated and reported separately.\n"
          << "//\n\n";
 
     fout << "// NOTE: In case of single stage turbocharging results will be in HP section.\n\n";
 
+    fout << "// Source data file, plain or gzip compressed\n"
+         << "srcFile" << PARAMDELIMITER << m_srcFile << "\n\n"
+         << "// Directory of reports. Empty - current directory\n"
+         << "outDir" << PARAMDELIMITER << m_outDir << "\n\n"
+         << "// Calculation report to standard output, messages to standard error.\n"
+         << "// 0 - disabled, 1 - enabled\n"
+         << "reportStdout" << PARAMDELIMITER << m_reportStdout << "\n\n"
+         << "// Timeline of calculation stages in Chrome trace-event format\n"
+         << "// (chrome://tracing, Perfetto). Empty - disabled\n"
+         << "traceFile" << PARAMDELIMITER << m_traceFile << "\n\n";
+
     fout << "// Engine description\n"
          << "testObjDescr" << PARAMDELIMITER << m_testObjDescr << "\n\n"
          << "// Aftercooler type (low pressure). 0 - air-air, 1 - coolant-air\n"
@@ -174,30 +497,171 @@ bool Configuration::createBlank() const {
          << "// Standard inlet temperature, degC\n"
          << "T0_std" << PARAMDELIMITER << m_T0_std << "\n\n"
          << "// Engine displacement, m3\n"
-         << "Vh" << PARAMDELIMITER << m_Vh << "\n\n"
-         << "// Sectional area in measurement point of S parameter, m2\n"
-         << "F1_S" << PARAMDELIMITER << m_F1_S << "\n\n"
-         << "// Sectional area in measurement point of Pklp parameter, m2\n"
-         << "F2_Pklp" << PARAMDELIMITER << m_F2_Pklp << "\n\n"
-         << "// Sectional area in measurement point of Pkslp parameter, m2\n"
-         << "F3_Pkslp" << PARAMDELIMITER << m_F3_Pkslp << "\n\n"
-         << "// Sectional area in measurement point of Pkhp parameter, m2\n"
-         << "F4_Pkhp" << PARAMDELIMITER << m_F4_Pkhp << "\n\n"
-         << "// Sectional area in measurement point of Pkshp parameter, m2\n"
-         << "F5_Pkshp" << PARAMDELIMITER << m_F5_Pkshp << "\n\n"
-         << "// Sectional area in measurement point of Pthp parameter, m2\n"
-         << "F6_Pthp" << PARAMDELIMITER << m_F6_Pthp << "\n\n"
-         << "// Sectional area in measurement point of Ptlp parameter, m2\n"
-         << "F7_Ptlp" << PARAMDELIMITER << m_F7_Ptlp << "\n\n"
-         << "// Sectional area in measurement point of Pr parameter, m2\n"
-         << "F8_Pr" << PARAMDELIMITER << m_F8_Pr << "\n\n"
-         << "// Number of engine charging systems\n"
+         << "Vh" << PARAMDELIMITER << m_Vh << "\n\n";
+
+    for ( size_t st=0; st<STATIONNUM; st++ ) {
+        fout << "// Sectional area in measurement point of " << boost::erase_all_copy(stationCaptions[st], "_") << " parameter, m2\n"
+             << stationParamName(st) << PARAMDELIMITER << m_F[st] << "\n\n";
+    }
+
+    fout << "// Number of engine charging systems\n"
          << "sysNum" << PARAMDELIMITER << m_sysNum << "\n\n"
          << "// Number of out pipes of high pressure (compressor)\n"
          << "pipeNumHpOut" << PARAMDELIMITER << m_pipeNumHpOut << "\n\n"
          << "// Number of in pipes of high pressure (turbine)\n"
          << "pipeNumHpIn" << PARAMDELIMITER << m_pipeNumHpIn << "\n\n";
 
+    fout << "// Compression of report files. 0 - none, 1 - gzip\n"
+         << "reportCompression" << PARAMDELIMITER << m_reportCompression << "\n\n";
+
+    fout << "// Pipelined execution (parsing, calculation and report writing overlap)\n\n"
+         << "// Number of calculation threads, up to " << PIPEMAXTHREADS << ". 0 - disabled\n"
+         << "pipeline" << PARAMDELIMITER << m_pipeline << "\n\n"
+         << "// Number of source data rows in one block, 1 to " << PIPEMAXBLOCKROWS << "\n"
+         << "pipeBlockRows" << PARAMDELIMITER << m_pipeBlockRows << "\n\n"
+         << "// Number of blocks in every queue between stages, 1 to " << PIPEMAXQUEUEDEPTH << "\n"
+         << "pipeQueueDepth" << PARAMDELIMITER << m_pipeQueueDepth << "\n\n";
+
+    fout << "// Steady-state detection in raw time series of source data\n\n"
+         << "// Number of samples in detection window. 0 - disabled (rows are operating points)\n"
+         << "ssWindow" << PARAMDELIMITER << m_ssWindow << "\n\n"
+         << "// Minimal number of samples averaged into operating point. 0 - ssWindow\n"
+         << "ssMinSamples" << PARAMDELIMITER << m_ssMinSamples << "\n\n"
+         << "// Tolerances of standard deviations of n (min-1), Me (Nm) and Gair (kg/h) in window\n"
+         << "ssTolN" << PARAMDELIMITER << m_ssTolN << "\n\n"
+         << "ssTolMe" << PARAMDELIMITER << m_ssTolMe << "\n\n"
+         << "ssTolGair" << PARAMDELIMITER << m_ssTolGair << "\n\n";
+
+    fout << "// Transient mode: moving average of raw time series of source data\n\n"
+         << "// Number of samples in moving average window. 0 - disabled\n"
+         << "trWindow" << PARAMDELIMITER << m_trWindow << "\n\n"
+         << "// Calculation every trStep samples (1 - at the sample rate)\n"
+         << "trStep" << PARAMDELIMITER << m_trStep << "\n\n";
+
+    fout << "// Compressor and turbine maps from points accumulated across runs\n"
+         << "// in file \"" << MAPPOINTSNAME << "[__profile].csv\" of outDir\n\n"
+         << "// Add points of this run and build maps. 0 - disabled, 1 - enabled\n"
+         << "mapBuild" << PARAMDELIMITER << m_mapBuild << "\n\n"
+         << "// Number of grid nodes along each axis, 2 to " << MAPMAXGRIDSIZE << "\n"
+         << "mapGridSize" << PARAMDELIMITER << m_mapGridSize << "\n\n"
+         << "// Number of nearest points for interpolation\n"
+         << "mapNeighbours" << PARAMDELIMITER << m_mapNeighbours << "\n\n"
+         << "// Number of efficiency contour levels\n"
+         << "mapContours" << PARAMDELIMITER << m_mapContours << "\n\n";
+
+    fout << "// Comparison of two calculation reports instead of calculation\n\n"
+         << "// Base and tested report files. Empty - disabled\n"
+         << "compareBase" << PARAMDELIMITER << m_compareBase << "\n\n"
+         << "compareTest" << PARAMDELIMITER << m_compareTest << "\n\n"
+         << "// Bins of n (min-1) and Me (Nm) for matching of operating points\n"
+         << "compareBinN" << PARAMDELIMITER << m_compareBinN << "\n\n"
+         << "compareBinMe" << PARAMDELIMITER << m_compareBinMe << "\n\n";
+
+    fout << "// Store of results of all runs with indexes by test object, date\n"
+         << "// and operating point\n\n"
+         << "// Directory of store. Empty - disabled\n"
+         << "storeDir" << PARAMDELIMITER << m_storeDir << "\n\n"
+         << "// Query of store instead of calculation: result caption, e.g. nu_sys[-].\n"
+         << "// Empty - disabled\n"
+         << "queryResult" << PARAMDELIMITER << m_queryResult << "\n\n"
+         << "// Test object description of runs. Empty - any\n"
+         << "queryEngine" << PARAMDELIMITER << m_queryEngine << "\n\n"
+         << "// First and last dates of runs, YYYY-MM-DD. Empty - any\n"
+         << "queryFrom" << PARAMDELIMITER << m_queryFrom << "\n\n"
+         << "queryTo" << PARAMDELIMITER << m_queryTo << "\n\n"
+         << "// Operating point n (min-1) and Me (Nm). Negative - any\n"
+         << "queryN" << PARAMDELIMITER << m_queryN << "\n\n"
+         << "queryMe" << PARAMDELIMITER << m_queryMe << "\n\n"
+         << "// Tolerances of operating point n (min-1) and Me (Nm)\n"
+         << "queryTolN" << PARAMDELIMITER << m_queryTolN << "\n\n"
+         << "queryTolMe" << PARAMDELIMITER << m_queryTolMe << "\n\n";
+
+    fout << "// Monte Carlo uncertainty propagation\n\n"
+         << "// Number of random samples per source data row. 0 - disabled\n"
+         << "mcSamples" << PARAMDELIMITER << m_mcSamples << "\n\n"
+         << "// Number of calculation threads. 0 - number of CPU cores\n"
+         << "mcThreads" << PARAMDELIMITER << m_mcThreads << "\n\n"
+         << "// Seed of random number generators, results do not depend on number of threads\n"
+         << "mcSeed" << PARAMDELIMITER << m_mcSeed << "\n\n"
+         << "// Standard uncertainties of source data columns in units of columns,\n"
+         << "// " << colCaptions.size() << " values delimited by symbol \"" << CSVDELIMETER << "\"\n"
+         << "mcTolerances" << PARAMDELIMITER;
+
+    for ( size_t i=0; i<m_mcTolerances.size(); i++ ) {
+
+        fout << m_mcTolerances[i];
+
+        if ( i != (m_mcTolerances.size()-1) ) {
+            fout << CSVDELIMETER;
+        }
+    }
+
+    fout << "\n\n";
+
+    fout << "// Sensitivity analysis\n\n"
+         << "// Results to differentiate with respect to source data columns,\n"
+         << "// captions of report delimited by symbol \"" << CSVDELIMETER << "\" (e.g. nu_sys[-]" << CSVDELIMETER << "Ft_hp[cm2]).\n"
+         << "// Empty value - disabled\n"
+         << "saResults" << PARAMDELIMITER << "\n\n";
+
+    fout << "// Inverse design\n\n"
+         << "// Target result: Pik_lp[-], Pik_hp[-], nu_tkr_lp[-], nu_tkr_hp[-] or nu_sys[-].\n"
+         << "// Empty value - disabled\n"
+         << "invTarget" << PARAMDELIMITER << m_invTarget << "\n\n"
+         << "// Target value\n"
+         << "invValue" << PARAMDELIMITER << m_invValue << "\n\n"
+         << "// Solved parameter of the stage of target: Ft_lp[cm2], Ft_hp[cm2], phi_lp[-] or phi_hp[-]\n"
+         << "invUnknown" << PARAMDELIMITER << m_invUnknown << "\n\n"
+         << "// Turbine area for solution of phi, cm2. 0 - measured area of every row\n"
+         << "invFt" << PARAMDELIMITER << m_invFt << "\n\n"
+         << "// Number of calculation threads. 0 - number of CPU cores\n"
+         << "invThreads" << PARAMDELIMITER << m_invThreads << "\n\n";
+
+    fout << "// Engine-turbocharger matching simulation over n-Me grid with compressor\n"
+         << "// and turbine maps (needs mapBuild=1)\n\n"
+         << "// Number of grid nodes along each axis, up to " << MAPMAXGRIDSIZE << ". 0 - disabled\n"
+         << "matchGrid" << PARAMDELIMITER << m_matchGrid << "\n\n"
+         << "// Range of n, min-1. Empty range - range of measured points\n"
+         << "matchNMin" << PARAMDELIMITER << m_matchNMin << "\n\n"
+         << "matchNMax" << PARAMDELIMITER << m_matchNMax << "\n\n"
+         << "// Range of Me, Nm. Empty range - range of measured points\n"
+         << "matchMeMin" << PARAMDELIMITER << m_matchMeMin << "\n\n"
+         << "matchMeMax" << PARAMDELIMITER << m_matchMeMax << "\n\n"
+         << "// Number of calculation threads. 0 - number of CPU cores\n"
+         << "matchThreads" << PARAMDELIMITER << m_matchThreads << "\n\n";
+
+    fout << "// Real-time calculation of operating points from POSIX shared memory ring\n"
+         << "// buffers instead of calculation of source data file. Layout of records\n"
+         << "// is described in realtime.hpp and shmring.hpp\n\n"
+         << "// Ring buffer of source points written by DAQ. Empty - disabled\n"
+         << "rtInput" << PARAMDELIMITER << m_rtInput << "\n\n"
+         << "// Ring buffer of results read by display software\n"
+         << "rtOutput" << PARAMDELIMITER << m_rtOutput << "\n\n"
+         << "// Number of records in ring buffers created by tkr (rounded up to power of two)\n"
+         << "rtCapacity" << PARAMDELIMITER << m_rtCapacity << "\n\n"
+         << "// Number of points to calculate. 0 - until Ctrl+C or SIGTERM\n"
+         << "rtPoints" << PARAMDELIMITER << m_rtPoints << "\n\n"
+         << "// Lock memory against paging for bounded latency. 0 - disabled, 1 - enabled\n"
+         << "rtLockMemory" << PARAMDELIMITER << m_rtLockMemory << "\n\n"
+         << "// Tag of source point is the time the DAQ published it, microseconds of\n"
+         << "// CLOCK_MONOTONIC, latency is measured from it. 0 - disabled (latency from\n"
+         << "// receiving of the point), 1 - enabled\n"
+         << "rtTagTime" << PARAMDELIMITER << m_rtTagTime << "\n\n"
+         << "// Batch calculation of source data files listed in this file, one per line.\n"
+         << "// Reports of every file are written to its own directory in outDir,\n"
+         << "// finished files are recorded in " << BATCHMANIFESTNAME << " and skipped on restart\n"
+         << "// while the file and the configuration are not changed. Empty - disabled\n"
+         << "batchList" << PARAMDELIMITER << m_batchList << "\n\n"
+         << "// Mean, standard deviation, min and max of results grouped by operating\n"
+         << "// points (bins of n and Me). 0 - disabled, 1 - enabled\n"
+         << "statGroups" << PARAMDELIMITER << m_statGroups << "\n\n"
+         << "// Bins of n [min-1] and Me [Nm] of grouped statistics\n"
+         << "statBinN" << PARAMDELIMITER << m_statBinN << "\n\n"
+         << "statBinMe" << PARAMDELIMITER << m_statBinMe << "\n\n"
+         << "// Number of threads of grouped statistics without pipeline. 0 - auto.\n"
+         << "// With pipeline every compute thread keeps its own statistics\n"
+         << "statThreads" << PARAMDELIMITER << m_statThreads << "\n\n";
+
     fout.close();
 
     return true;
@@ -22,6 +22,27 @@
 #define CONFIGURATION_HPP
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <stdexcept>
+
+#include "tkrkernel.hpp"
+
+//
+// Unknown name or wrong value of configuration parameter, the run ends
+// with EXITCONFIG.
+//
+
+class ConfigError : public std::runtime_error {
+
+public:
+
+    explicit ConfigError(const std::string &what) :
+        std::runtime_error(what) {
+    }
+
+};
 
 class Configuration {
 
@@ -29,8 +50,36 @@ public:
 
     Configuration();
 
-    void readConfigFile();
+    bool readConfigFile(const std::string &fileName = CONFIGFILE);
+
+    // command line value, it overrides common and profile parameters,
+    // ConfigError if the name is unknown or the value is wrong
+    void overrideParameter(const std::string &, const std::string &);
+
+    std::vector< std::shared_ptr<Configuration> > profiles() const;
 
+    std::string val_profileName() const {
+        return m_profileName;
+    }
+
+    std::string val_configFile() const {
+        return m_configFile;
+    }
+    const std::vector< std::pair<std::string, std::string> > &val_overrides() const {
+        return m_overrides;
+    }
+    std::string val_srcFile() const {
+        return m_srcFile;
+    }
+    std::string val_outDir() const {
+        return m_outDir;
+    }
+    size_t val_reportStdout() const {
+        return m_reportStdout;
+    }
+    std::string val_traceFile() const {
+        return m_traceFile;
+    }
     std::string val_testObjDescr() const {
         return m_testObjDescr;
     }
@@ -49,43 +98,207 @@ public:
     double val_Vh() const {
         return m_Vh;
     }
-    double val_F1_S() const {
-        return m_F1_S;
+    double val_F(size_t st) const {
+        return m_F[st];
+    }
+    double val_sysNum() const {
+        return m_sysNum;
+    }
+    double val_pipeNumHpOut() const {
+        return m_pipeNumHpOut;
     }
-    double val_F2_Pklp() const {
-        return m_F2_Pklp;
+    double val_pipeNumHpIn() const {
+        return m_pipeNumHpIn;
     }
-    double val_F3_Pkslp() const {
-        return m_F3_Pkslp;
+    TkrCalcParams val_calcParams() const;
+    size_t val_reportCompression() const {
+        return m_reportCompression;
     }
-    double val_F4_Pkhp() const {
-        return m_F4_Pkhp;
+    size_t val_pipeline() const {
+        return m_pipeline;
     }
-    double val_F5_Pkshp() const {
-        return m_F5_Pkshp;
+    size_t val_pipeBlockRows() const {
+        return m_pipeBlockRows;
     }
-    double val_F6_Pthp() const {
-        return m_F6_Pthp;
+    size_t val_pipeQueueDepth() const {
+        return m_pipeQueueDepth;
     }
-    double val_F7_Ptlp() const {
-        return m_F7_Ptlp;
+    size_t val_ssWindow() const {
+        return m_ssWindow;
     }
-    double val_F8_Pr() const {
-        return m_F8_Pr;
+    size_t val_ssMinSamples() const {
+        return m_ssMinSamples;
     }
-    double val_sysNum() const {
-        return m_sysNum;
+    double val_ssTolN() const {
+        return m_ssTolN;
     }
-    double val_pipeNumHpOut() const {
-        return m_pipeNumHpOut;
+    double val_ssTolMe() const {
+        return m_ssTolMe;
     }
-    double val_pipeNumHpIn() const {
-        return m_pipeNumHpIn;
+    double val_ssTolGair() const {
+        return m_ssTolGair;
+    }
+    size_t val_trWindow() const {
+        return m_trWindow;
+    }
+    size_t val_trStep() const {
+        return m_trStep;
+    }
+    size_t val_mapBuild() const {
+        return m_mapBuild;
+    }
+    size_t val_mapGridSize() const {
+        return m_mapGridSize;
+    }
+    size_t val_mapNeighbours() const {
+        return m_mapNeighbours;
+    }
+    size_t val_mapContours() const {
+        return m_mapContours;
+    }
+    std::string val_compareBase() const {
+        return m_compareBase;
+    }
+    std::string val_compareTest() const {
+        return m_compareTest;
+    }
+    double val_compareBinN() const {
+        return m_compareBinN;
+    }
+    double val_compareBinMe() const {
+        return m_compareBinMe;
+    }
+    std::string val_storeDir() const {
+        return m_storeDir;
+    }
+    std::string val_queryResult() const {
+        return m_queryResult;
+    }
+    std::string val_queryEngine() const {
+        return m_queryEngine;
+    }
+    std::string val_queryFrom() const {
+        return m_queryFrom;
+    }
+    std::string val_queryTo() const {
+        return m_queryTo;
+    }
+    double val_queryN() const {
+        return m_queryN;
+    }
+    double val_queryMe() const {
+        return m_queryMe;
+    }
+    double val_queryTolN() const {
+        return m_queryTolN;
+    }
+    double val_queryTolMe() const {
+        return m_queryTolMe;
+    }
+    size_t val_mcSamples() const {
+        return m_mcSamples;
+    }
+    size_t val_mcThreads() const {
+        return m_mcThreads;
+    }
+    size_t val_mcSeed() const {
+        return m_mcSeed;
+    }
+    std::vector<double> val_mcTolerances() const {
+        return m_mcTolerances;
+    }
+    std::vector<std::string> val_saResults() const {
+        return m_saResults;
+    }
+    std::string val_invTarget() const {
+        return m_invTarget;
+    }
+    double val_invValue() const {
+        return m_invValue;
+    }
+    std::string val_invUnknown() const {
+        return m_invUnknown;
+    }
+    double val_invFt() const {
+        return m_invFt;
+    }
+    size_t val_invThreads() const {
+        return m_invThreads;
+    }
+    size_t val_matchGrid() const {
+        return m_matchGrid;
+    }
+    double val_matchNMin() const {
+        return m_matchNMin;
+    }
+    double val_matchNMax() const {
+        return m_matchNMax;
+    }
+    double val_matchMeMin() const {
+        return m_matchMeMin;
+    }
+    double val_matchMeMax() const {
+        return m_matchMeMax;
+    }
+    size_t val_matchThreads() const {
+        return m_matchThreads;
+    }
+    std::string val_rtInput() const {
+        return m_rtInput;
+    }
+    std::string val_rtOutput() const {
+        return m_rtOutput;
+    }
+    size_t val_rtCapacity() const {
+        return m_rtCapacity;
+    }
+    size_t val_rtPoints() const {
+        return m_rtPoints;
+    }
+    size_t val_rtLockMemory() const {
+        return m_rtLockMemory;
+    }
+    size_t val_rtTagTime() const {
+        return m_rtTagTime;
+    }
+
+    std::string val_batchList() const {
+        return m_batchList;
+    }
+
+    size_t val_statGroups() const {
+        return m_statGroups;
+    }
+    double val_statBinN() const {
+        return m_statBinN;
+    }
+    double val_statBinMe() const {
+        return m_statBinMe;
+    }
+    size_t val_statThreads() const {
+        return m_statThreads;
     }
 
 private:
 
-    bool createBlank() const;
+    bool createBlank(const std::string &) const;
+
+    // false if the name is unknown, ConfigError if the value is wrong
+    bool setParameter(const std::string &, const std::string &);
+    bool assignParameter(const std::string &, const std::string &);
+
+    static std::string stationParamName(size_t);
+    static size_t stationParam(const std::string &);
+
+    std::string m_profileName;
+    std::vector< std::pair< std::string, std::vector< std::pair<std::string, std::string> > > > m_profiles;
+    std::vector< std::pair<std::string, std::string> > m_overrides;
+
+    std::string m_configFile = CONFIGFILE;
+    std::string m_srcFile = SRCDATAFILE; // plain or gzip compressed source data file
+    std::string m_outDir;             // directory of reports, empty - current directory
+    size_t m_reportStdout = 0;        // calculation report to standard output
+    std::string m_traceFile;          // Chrome trace-event file, empty - disabled
 
     std::string m_testObjDescr = "YMZ-......., TKR-.......";
     size_t m_acType_lp    = 0;        // aftercooler type
@@ -93,17 +306,69 @@ private:
     double m_B0_std       = 101.3;    // kPa
     double m_T0_std       = 20;       // degC
     double m_Vh           = 0.007014; // engine displacement, m3
-    double m_F1_S         = 0.0177;   // sectional area in measurement point, m2
-    double m_F2_Pklp      = 0.0058;   // sectional area in measurement point, m2
-    double m_F3_Pkslp     = 0.0058;   // sectional area in measurement point, m2
-    double m_F4_Pkhp      = 0.0042;   // sectional area in measurement point, m2
-    double m_F5_Pkshp     = 0.0058;   // sectional area in measurement point, m2
-    double m_F6_Pthp      = 0.0045;   // sectional area in measurement point, m2
-    double m_F7_Ptlp      = 0.0050;   // sectional area in measurement point, m2
-    double m_F8_Pr        = 0.0078;   // sectional area in measurement point, m2
+    double m_F[STATIONNUM] = {        // sectional areas in measurement points, m2
+        0.0177, 0.0058, 0.0058, 0.0042, 0.0058, 0.0045, 0.0050, 0.0078
+    };
     double m_sysNum       = 1;        // number of charging systems on the engine
     double m_pipeNumHpOut = 1;        // number of hp out pipes
     double m_pipeNumHpIn  = 1;        // number of hp in pipes
+    size_t m_reportCompression = 0;   // compression of report files
+    size_t m_pipeline     = 0;        // number of pipeline compute threads, 0 - disabled
+    size_t m_pipeBlockRows = 4096;    // number of source data rows in pipeline block
+    size_t m_pipeQueueDepth = 4;      // number of blocks in every pipeline queue
+    size_t m_ssWindow     = 0;        // samples in steady-state detection window, 0 - disabled
+    size_t m_ssMinSamples = 0;        // minimal samples in steady-state point
+    double m_ssTolN       = 5;        // tolerance of n standard deviation, min-1
+    double m_ssTolMe      = 5;        // tolerance of Me standard deviation, Nm
+    double m_ssTolGair    = 5;        // tolerance of Gair standard deviation, kg/h
+    size_t m_trWindow     = 0;        // samples in transient moving average window, 0 - disabled
+    size_t m_trStep       = 1;        // samples between transient rows
+    size_t m_mapBuild     = 0;        // build compressor and turbine maps, 0 - disabled
+    size_t m_mapGridSize  = 50;       // number of map grid nodes along each axis
+    size_t m_mapNeighbours = 8;       // number of points for map interpolation
+    size_t m_mapContours  = 10;       // number of efficiency contour levels
+    std::string m_compareBase;        // base report for comparison, empty - disabled
+    std::string m_compareTest;        // tested report for comparison
+    double m_compareBinN  = 50;       // bin of n for matching of operating points, min-1
+    double m_compareBinMe = 20;       // bin of Me for matching of operating points, Nm
+    std::string m_storeDir;           // directory of results store, empty - disabled
+    std::string m_queryResult;        // result caption for query of store, empty - disabled
+    std::string m_queryEngine;        // test object description of queried runs, empty - any
+    std::string m_queryFrom;          // first date of queried runs YYYY-MM-DD, empty - any
+    std::string m_queryTo;            // last date of queried runs YYYY-MM-DD, empty - any
+    double m_queryN       = -1;       // n of queried operating point, min-1, negative - any
+    double m_queryMe      = -1;       // Me of queried operating point, Nm, negative - any
+    double m_queryTolN    = 25;       // tolerance of n of queried operating point, min-1
+    double m_queryTolMe   = 10;       // tolerance of Me of queried operating point, Nm
+    size_t m_mcSamples    = 0;        // number of Monte Carlo samples per row, 0 - disabled
+    size_t m_mcThreads    = 0;        // number of Monte Carlo threads, 0 - auto
+    size_t m_mcSeed       = 1;        // seed of Monte Carlo random number generators
+    std::vector<double> m_mcTolerances; // standard uncertainties of source data columns
+    std::vector<std::string> m_saResults; // results for sensitivity analysis, empty - disabled
+    std::string m_invTarget;          // target result of inverse design, empty - disabled
+    double m_invValue     = 0;        // target value
+    std::string m_invUnknown = "Ft_hp[cm2]"; // solved result, Ft or phi of one stage
+    double m_invFt        = 0;        // turbine area for solution of phi, cm2, 0 - measured
+    size_t m_invThreads   = 0;        // number of inverse design threads, 0 - auto
+    size_t m_matchGrid    = 0;        // grid nodes of matching simulation along each axis, 0 - disabled
+    double m_matchNMin    = 0;        // range of n of grid, min-1, empty range - measured range
+    double m_matchNMax    = 0;
+    double m_matchMeMin   = 0;        // range of Me of grid, Nm, empty range - measured range
+    double m_matchMeMax   = 0;
+    size_t m_matchThreads = 0;        // number of matching simulation threads, 0 - auto
+    std::string m_rtInput;            // shared memory ring buffer of source points, empty - disabled
+    std::string m_rtOutput = "tkr_results"; // shared memory ring buffer of results
+    size_t m_rtCapacity   = 1024;     // records in created ring buffers
+    size_t m_rtPoints     = 0;        // points to calculate, 0 - until stopped
+    size_t m_rtLockMemory = 1;        // lock memory of real-time calculation, 0 - disabled
+    size_t m_rtTagTime    = 0;        // tag of input record is its publishing time, 0 - disabled
+
+    std::string m_batchList;          // file with list of source data files, empty - disabled
+
+    size_t m_statGroups  = 0;         // statistics of results grouped by n and Me, 0 - disabled
+    double m_statBinN    = 50;        // bin of n, min-1
+    double m_statBinMe   = 20;        // bin of Me, Nm
+    size_t m_statThreads = 0;         // number of threads without pipeline, 0 - auto
 };
 
 #endif // CONFIGURATION_HPP
@@ -27,18 +27,52 @@
 #define CONFIGFILE     "tkr.conf"
 #define SRCDATAFILE    "src.csv"
 #define REPORTNAME     "TKR_calc_report"
+#define UNCREPORTNAME  "TKR_uncertainty_report"
+#define SAREPORTNAME   "TKR_sensitivity_report"
+#define MAPREPORTNAME  "TKR_map_report"
+#define CMPREPORTNAME  "TKR_compare_report"
+#define MAPPOINTSNAME  "TKR_map_points"
+#define QRYREPORTNAME  "TKR_query_report"
+#define INVREPORTNAME  "TKR_inverse_report"
+#define MATREPORTNAME  "TKR_matching_report"
+#define STATREPORTNAME "TKR_statistics_report"
+#define BATCHMANIFESTNAME "TKR_batch_manifest.csv"
+#define STDOUTNAME     "-"
 #define PARAMDELIMITER "="
 #define CSVDELIMETER   ";"
 #define TABLECAPSTRNUM 1
+#define SRCERRMAXNUM   20
+#define FIXEDBUFSIZE   352
 #define ERRORMSGBLANK  "tkr ERROR =>\t"
 #define WARNMSGBLANK   "tkr WARNING =>\t"
 #define MSGBLANK       "tkr ->\t"
 
+// exit codes
+#define EXITOK     0
+#define EXITFAILED 1 // calculation or writing of reports failed
+#define EXITUSAGE  2 // wrong command line
+#define EXITCONFIG 3 // configuration can not be read
+
 enum {
     ACTYPE_AIRAIR,
     ACTYPE_COOLANTAIR
 };
 
+enum {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSIONNUM
+};
+
+#define GZEXT ".gz"
+
+// pipeline: maximal number of compute threads, rows in block and blocks in queue
+#define PIPEMAXTHREADS    256
+#define PIPEMAXBLOCKROWS  1048576
+#define PIPEMAXQUEUEDEPTH 1024
+
+#define SRCCOLNUM 23
+
 const std::vector<std::string> colCaptions = {
     "n[min-1]",
     "Me[Nm]",
@@ -65,7 +99,271 @@ const std::vector<std::string> colCaptions = {
     "Tcool[degC]"
 };
 
+const std::vector<std::string> resCaptions = {
+    "nuv[-]",
+    "E1[-]",
+    "E2[-]",
+    "Gair_lp_r[kg/s]",
+    "Pik_lp[-]",
+    "nuad_lp[-]",
+    "Ncomp_lp[kW]",
+    "Gexh_lp_r[(kg/s)*sqrt(K)/kPa]",
+    "Pit_lp[-]",
+    "nute_lp[-]",
+    "muft_lp[cm2]",
+    "Nt_dis_lp[kW]",
+    "phi_lp[-]",
+    "Ft_lp[cm2]",
+    "Gair_hp_r[kg/s]",
+    "Pik_hp[-]",
+    "nuad_hp[-]",
+    "Ncomp_hp[kW]",
+    "Gexh_hp_r[(kg/s)*sqrt(K)/kPa]",
+    "Pit_hp[-]",
+    "nute_hp[-]",
+    "muft_hp[cm2]",
+    "Nt_dis_hp[kW]",
+    "phi_hp[-]",
+    "Ft_hp[cm2]",
+    "nu_tkr_lp[-]",
+    "nu_tkr_hp[-]",
+    "nu_sys[-]"
+};
+
+// result columns in order of resCaptions
+enum {
+    RES_NUV,
+    RES_E1,
+    RES_E2,
+    RES_GAIR_LP_R,
+    RES_PIK_LP,
+    RES_NUAD_LP,
+    RES_NCOMP_LP,
+    RES_GEXH_LP_R,
+    RES_PIT_LP,
+    RES_NUTE_LP,
+    RES_MUFT_LP,
+    RES_NT_DIS_LP,
+    RES_PHI_LP,
+    RES_FT_LP,
+    RES_GAIR_HP_R,
+    RES_PIK_HP,
+    RES_NUAD_HP,
+    RES_NCOMP_HP,
+    RES_GEXH_HP_R,
+    RES_PIT_HP,
+    RES_NUTE_HP,
+    RES_MUFT_HP,
+    RES_NT_DIS_HP,
+    RES_PHI_HP,
+    RES_FT_HP,
+    RES_NUTKR_LP,
+    RES_NUTKR_HP,
+    RES_NUSYS,
+    RESNUM
+};
+
+// pressure/temperature measurement points (stations)
+enum {
+    ST_S,
+    ST_PK_LP,
+    ST_PKS_LP,
+    ST_PK_HP,
+    ST_PKS_HP,
+    ST_PT_HP,
+    ST_PT_LP,
+    ST_PR,
+    STATIONNUM
+};
+
+// source data columns of station pressures and temperatures
+#define STPCOL 6
+#define STTCOL 14
+
+// source data columns of engine operating point
+#define NCOL    0
+#define MECOL   1
+#define GAIRCOL 4
+
+const std::vector<std::string> stationCaptions = {
+    "S",
+    "Pk_lp",
+    "Pks_lp",
+    "Pk_hp",
+    "Pks_hp",
+    "Pt_hp",
+    "Pt_lp",
+    "Pr"
+};
+
+enum {
+    GAS_AIR,
+    GAS_EXH
+};
+
+struct GasConstants {
+    double m;      // flow function constant
+    double beta;   // (k-1)/(k+1)
+    double lambda; // gas dynamic function constant
+    double kexp;   // k/(k-1)
+};
+
+const GasConstants gasConstants[] = {
+    {20.317, 0.16667, 1.57744, 3.5},    // air
+    {25.639, 0.14894, 1.58529, 3.85714} // exhaust gas
+};
+
+const size_t stationGas[STATIONNUM] = {
+    GAS_AIR, GAS_AIR, GAS_AIR, GAS_AIR, GAS_AIR, GAS_EXH, GAS_EXH, GAS_EXH
+};
+
+// multiplier from source data pressure units (kPa or bar) to kPa
+const double stationPUnit[STATIONNUM] = {
+    1.0, 100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 1.0
+};
+
+// physical ranges of source data columns in units of colCaptions;
+// rows with values out of range, NaN or denormals are not calculated
+const double srcColMin[SRCCOLNUM] = {
+    1,    -1e5, -1e5, 0,   1e-3, 0.5,         // n Me Ne Gfuel Gair B0
+    -100, -1,   -1,   -1,  -1,   -1,  -1,     // S Pk_lp Pks_lp Pk_hp Pks_hp Pt_hp Pt_lp
+    -100,                                     // Pr
+    -60,  -60,  -60,  -60, -60,  -60, -60,    // T0 Tk_lp Tks_lp Tk_hp Tks_hp Tt_hp Tt_lp
+    -60,                                      // Tr
+    -60                                       // Tcool
+};
+const double srcColMax[SRCCOLNUM] = {
+    1e4,  1e5,  1e5,  1e5, 1e6,  1.2,
+    100,  20,   20,   20,  20,   20,  20,
+    1000,
+    80,   1200, 1200, 1200, 1200, 1200, 1200,
+    1200,
+    200
+};
+
+#define STBIT(s) (1u << (s))
+
+// low pressure stage stations, not measured on single stage engines: the
+// high pressure compressor inlet is then ambient (B0, T0) and the high
+// pressure turbine outlet is the Pr station
+#define STLPSTAGE (STBIT(ST_PK_LP) | STBIT(ST_PKS_LP) | STBIT(ST_PT_LP))
+
+// stations used by every result; results depending on a station which is
+// not measured (zero pressure and temperature, e.g. single stage rigs) are
+// masked, high pressure stage results do not depend on STLPSTAGE stations
+const unsigned resStations[RESNUM] = {
+    STBIT(ST_PKS_HP),                                           // nuv
+    STBIT(ST_S) | STBIT(ST_PK_LP) | STBIT(ST_PKS_LP),           // E1
+    STBIT(ST_S) | STBIT(ST_PK_HP) | STBIT(ST_PKS_HP),           // E2
+    STBIT(ST_S),                                                // Gair_lp_r
+    STBIT(ST_S) | STBIT(ST_PK_LP),                              // Pik_lp
+    STBIT(ST_S) | STBIT(ST_PK_LP),                              // nuad_lp
+    STBIT(ST_S) | STBIT(ST_PK_LP),                              // Ncomp_lp
+    STBIT(ST_PT_LP) | STBIT(ST_PR),                             // Gexh_lp_r
+    STBIT(ST_PT_LP) | STBIT(ST_PR),                             // Pit_lp
+    STBIT(ST_S) | STBIT(ST_PK_LP) | STBIT(ST_PT_LP) | STBIT(ST_PR), // nute_lp
+    STBIT(ST_PT_LP) | STBIT(ST_PR),                             // muft_lp
+    STBIT(ST_PT_LP) | STBIT(ST_PR),                             // Nt_dis_lp
+    STBIT(ST_PT_LP) | STBIT(ST_PR),                             // phi_lp
+    STBIT(ST_PT_LP) | STBIT(ST_PR),                             // Ft_lp
+    0,                                                          // Gair_hp_r
+    STBIT(ST_PK_HP),                                            // Pik_hp
+    STBIT(ST_PK_HP),                                            // nuad_hp
+    STBIT(ST_PK_HP),                                            // Ncomp_hp
+    STBIT(ST_PT_HP),                                            // Gexh_hp_r
+    STBIT(ST_PT_HP),                                            // Pit_hp
+    STBIT(ST_PK_HP) | STBIT(ST_PT_HP),                          // nute_hp
+    STBIT(ST_PT_HP),                                            // muft_hp
+    STBIT(ST_PT_HP),                                            // Nt_dis_hp
+    STBIT(ST_PT_HP),                                            // phi_hp
+    STBIT(ST_PT_HP),                                            // Ft_hp
+    STBIT(ST_S) | STBIT(ST_PK_LP) | STBIT(ST_PT_LP) | STBIT(ST_PR), // nu_tkr_lp
+    STBIT(ST_PK_HP) | STBIT(ST_PT_HP),                          // nu_tkr_hp
+    STBIT(ST_S) | STBIT(ST_PK_LP) | STBIT(ST_PKS_LP) | STBIT(ST_PK_HP) |
+    STBIT(ST_PT_HP) | STBIT(ST_PT_LP) | STBIT(ST_PR)            // nu_sys
+};
+
+// compressor and turbine maps
+enum {
+    MAP_COMP_LP,
+    MAP_COMP_HP,
+    MAP_TURB_LP,
+    MAP_TURB_HP,
+    MAPNUM
+};
+
+struct MapDef {
+    const char *name;
+    size_t x;     // result column of flow
+    size_t y;     // result column of pressure ratio
+    size_t z[2];  // result columns of interpolated values, efficiency is the first
+    size_t zNum;
+};
+
+const MapDef mapDefs[MAPNUM] = {
+    {"compressor_lp", RES_GAIR_LP_R, RES_PIK_LP, {RES_NUAD_LP, 0        }, 1},
+    {"compressor_hp", RES_GAIR_HP_R, RES_PIK_HP, {RES_NUAD_HP, 0        }, 1},
+    {"turbine_lp",    RES_GEXH_LP_R, RES_PIT_LP, {RES_NUTE_LP, RES_FT_LP}, 2},
+    {"turbine_hp",    RES_GEXH_HP_R, RES_PIT_HP, {RES_NUTE_HP, RES_FT_HP}, 2}
+};
+
+// grid nodes farther from measured points (in grid cells) are not interpolated
+#define MAPMAXCELLS 3.0
+
+// maximal number of grid nodes along each axis, the grid is kept in memory
+#define MAPMAXGRIDSIZE 1000
+
+// results store: table of runs and partitions of operating points by bins of n
+#define STORERUNSNAME "runs.csv"
+#define STORELOCKNAME "store.lock"
+#define STOREPARTNAME "points_n"
+#define STOREBINN     50.0
+
+// trace: initial and maximal number of events in buffer of one thread
+#define TRACEBLOCKEVENTS 4096
+#define TRACEMAXEVENTS   1000000
+
 #define FTDEFACCUR 0.001
 #define MAXITER 100.0
 
+// inverse design: range of wastegate flow fraction, initial step of
+// bracketing from warm start, accuracy and iterations of root finder
+#define INVPHIMAX   0.95
+#define INVPHISTEP  0.02
+#define INVPHIACCUR 1e-5
+#define INVMAXITER  50
+
+// matching simulation: iterations and relative accuracy of compressor
+// pressure ratios, relative step of derivatives, maximal relative step
+// of iteration, maximal turbine pressure ratio
+#define MATCHMAXITER  50
+#define MATCHACCUR    1e-6
+#define MATCHDIFFSTEP 1e-5
+#define MATCHMAXSTEP  0.1
+#define MATCHPITMAX   8.0
+
+// real-time calculation: doubles in records of input and output ring
+// buffers, polls of empty input ring buffer before yielding the CPU
+#define RTSRCRECORD (SRCCOLNUM + 1)
+#define RTRESRECORD (RESNUM + 2)
+#define RTIDLESPINS 1000
+
+// latency histogram: buckets per power of two and total number of buckets
+#define LATSUBBUCKETS 16
+#define LATBUCKETNUM  (64 * LATSUBBUCKETS)
+
+// batch manifest: fields of record and states of items
+#define BATCHFIELDSNUM 5
+#define BATCHSTARTED   "started"
+#define BATCHDONE      "done"
+#define BATCHFAILED    "failed"
+
+// batch manifest: 64-bit FNV-1a hash of files and buffer of file reading
+#define FNVOFFSET        14695981039346656037ULL
+#define FNVPRIME         1099511628211ULL
+#define BATCHHASHBUFSIZE 65536
+
+// grouped statistics: minimal number of rows per thread
+#define STATTHREADROWS 65536
+
 #endif // CONSTANTS_HPP
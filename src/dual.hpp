@@ -0,0 +1,214 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: dual.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DUAL_HPP
+#define DUAL_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+//
+// Dual number for forward mode automatic differentiation.
+// Value and N partial derivatives are propagated through every operation.
+//
+
+template<size_t N>
+class Dual {
+
+public:
+
+    Dual(double v = 0) :
+        m_v(v) {
+        m_d.fill(0);
+    }
+
+    // independent variable number i
+    Dual(double v, size_t i) :
+        m_v(v) {
+        m_d.fill(0);
+        m_d[i] = 1.0;
+    }
+
+    double val() const {
+        return m_v;
+    }
+    double der(size_t i) const {
+        return m_d[i];
+    }
+
+    Dual &operator+=(const Dual &b) {
+        m_v += b.m_v;
+        for ( size_t i=0; i<N; i++ ) {
+            m_d[i] += b.m_d[i];
+        }
+        return *this;
+    }
+    Dual &operator-=(const Dual &b) {
+        m_v -= b.m_v;
+        for ( size_t i=0; i<N; i++ ) {
+            m_d[i] -= b.m_d[i];
+        }
+        return *this;
+    }
+    Dual &operator*=(const Dual &b) {
+        for ( size_t i=0; i<N; i++ ) {
+            m_d[i] = m_d[i] * b.m_v + m_v * b.m_d[i];
+        }
+        m_v *= b.m_v;
+        return *this;
+    }
+    Dual &operator/=(const Dual &b) {
+        m_v /= b.m_v;
+        for ( size_t i=0; i<N; i++ ) {
+            m_d[i] = (m_d[i] - m_v * b.m_d[i]) / b.m_v;
+        }
+        return *this;
+    }
+
+    Dual &operator*=(double b) {
+        m_v *= b;
+        for ( size_t i=0; i<N; i++ ) {
+            m_d[i] *= b;
+        }
+        return *this;
+    }
+    Dual &operator/=(double b) {
+        m_v /= b;
+        for ( size_t i=0; i<N; i++ ) {
+            m_d[i] /= b;
+        }
+        return *this;
+    }
+
+    friend Dual operator-(const Dual &a) {
+        Dual r(a);
+        r *= -1.0;
+        return r;
+    }
+
+    friend Dual operator+(Dual a, const Dual &b) {
+        return a += b;
+    }
+    friend Dual operator-(Dual a, const Dual &b) {
+        return a -= b;
+    }
+    friend Dual operator*(Dual a, const Dual &b) {
+        return a *= b;
+    }
+    friend Dual operator/(Dual a, const Dual &b) {
+        return a /= b;
+    }
+
+    friend Dual operator+(Dual a, double b) {
+        a.m_v += b;
+        return a;
+    }
+    friend Dual operator+(double a, Dual b) {
+        b.m_v += a;
+        return b;
+    }
+    friend Dual operator-(Dual a, double b) {
+        a.m_v -= b;
+        return a;
+    }
+    friend Dual operator-(double a, const Dual &b) {
+        Dual r(-b);
+        r.m_v += a;
+        return r;
+    }
+    friend Dual operator*(Dual a, double b) {
+        return a *= b;
+    }
+    friend Dual operator*(double a, Dual b) {
+        return b *= a;
+    }
+    friend Dual operator/(Dual a, double b) {
+        return a /= b;
+    }
+    friend Dual operator/(double a, const Dual &b) {
+        Dual r(a / b.m_v);
+        const double k = -r.m_v / b.m_v;
+        for ( size_t i=0; i<N; i++ ) {
+            r.m_d[i] = k * b.m_d[i];
+        }
+        return r;
+    }
+
+    friend bool operator<(const Dual &a, const Dual &b) {
+        return a.m_v < b.m_v;
+    }
+    friend bool operator>(const Dual &a, const Dual &b) {
+        return a.m_v > b.m_v;
+    }
+    friend bool operator<=(const Dual &a, const Dual &b) {
+        return a.m_v <= b.m_v;
+    }
+    friend bool operator>=(const Dual &a, const Dual &b) {
+        return a.m_v >= b.m_v;
+    }
+    friend bool operator==(const Dual &a, double b) {
+        return a.m_v == b;
+    }
+    friend bool operator<(const Dual &a, double b) {
+        return a.m_v < b;
+    }
+    friend bool operator>(const Dual &a, double b) {
+        return a.m_v > b;
+    }
+    friend bool operator<=(const Dual &a, double b) {
+        return a.m_v <= b;
+    }
+    friend bool operator>=(const Dual &a, double b) {
+        return a.m_v >= b;
+    }
+
+    // f(a) with derivative df/da
+    friend Dual chain(const Dual &a, double f, double dfda) {
+        Dual r(f);
+        for ( size_t i=0; i<N; i++ ) {
+            r.m_d[i] = dfda * a.m_d[i];
+        }
+        return r;
+    }
+
+    friend Dual sqrt(const Dual &a) {
+        const double f = std::sqrt(a.m_v);
+        return chain(a, f, 0.5 / f);
+    }
+    friend Dual pow(const Dual &a, double b) {
+        const double f = std::pow(a.m_v, b);
+        return chain(a, f, b * std::pow(a.m_v, b - 1.0));
+    }
+    friend Dual log(const Dual &a) {
+        return chain(a, std::log(a.m_v), 1.0 / a.m_v);
+    }
+    friend Dual fabs(const Dual &a) {
+        return (a.m_v < 0) ? -a : a;
+    }
+
+private:
+
+    double m_v;
+    std::array<double, N> m_d;
+
+};
+
+#endif // DUAL_HPP
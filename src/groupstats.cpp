@@ -0,0 +1,241 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: groupstats.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "groupstats.hpp"
+#include "constants.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <cmath>
+#include <iomanip>
+#include <algorithm>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::cout;
+using std::setprecision;
+
+GroupStats::GroupStats(const shared_ptr<Configuration> &conf) :
+    m_conf(conf),
+    m_binN(conf->val_statBinN()),
+    m_binMe(conf->val_statBinMe()) {
+
+    if ( !(m_binN > 0) ) {
+        m_binN = 1;
+    }
+
+    if ( !(m_binMe > 0) ) {
+        m_binMe = 1;
+    }
+}
+
+void GroupStats::addRows(const TkrParameters &tkr) {
+
+    const size_t num = tkr.val_rowsNum();
+
+    size_t thrnum = m_conf->val_statThreads();
+
+    if ( thrnum == 0 ) {
+        thrnum = std::thread::hardware_concurrency();
+    }
+
+    thrnum = std::min(std::max(thrnum, size_t(1)), std::max(num / STATTHREADROWS, size_t(1)));
+
+    if ( thrnum == 1 ) {
+        addRows(tkr, 0, num);
+        return;
+    }
+
+    vector<GroupStats> partials(thrnum, GroupStats(m_conf));
+    vector<std::thread> threads;
+
+    for ( size_t t=0; t<thrnum; t++ ) {
+        threads.push_back(std::thread([&partials, &tkr, num, thrnum, t]() {
+            partials[t].addRows(tkr, num * t / thrnum, num * (t + 1) / thrnum);
+        }));
+    }
+
+    for ( size_t t=0; t<threads.size(); t++ ) {
+        threads[t].join();
+    }
+
+    for ( size_t t=0; t<thrnum; t++ ) {
+        merge(partials[t]);
+    }
+}
+
+void GroupStats::addRows(const TkrParameters &tkr, size_t first, size_t last) {
+
+    const vector<double> &n = tkr.val_n();
+    const vector<double> &Me = tkr.val_Me();
+
+    const vector<double> *cols[RESNUM];
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        cols[k] = &tkr.resultColumn(k);
+    }
+
+    // repeated operating points usually follow each other
+    Bin *bin = nullptr;
+    BinKey key(0, 0);
+
+    for ( size_t i=first; i<last; i++ ) {
+
+        if ( tkr.isMasked(i) || !std::isfinite(n[i]) || !std::isfinite(Me[i]) ) {
+            continue;
+        }
+
+        const BinKey rowKey(std::llround(n[i] / m_binN), std::llround(Me[i] / m_binMe));
+
+        if ( (bin == nullptr) || (rowKey != key) ) {
+            key = rowKey;
+            bin = &m_bins[key];
+        }
+
+        bin->rows++;
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            add(bin->res[k], (*cols[k])[i]);
+        }
+
+        m_rows++;
+    }
+}
+
+void GroupStats::merge(const GroupStats &other) {
+
+    for ( auto it=other.m_bins.begin(); it!=other.m_bins.end(); ++it ) {
+
+        Bin &bin = m_bins[it->first];
+
+        bin.rows += it->second.rows;
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            merge(bin.res[k], it->second.res[k]);
+        }
+    }
+
+    m_rows += other.m_rows;
+}
+
+bool GroupStats::createReport() const {
+
+    const string fileName = reportFileName(STATREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n"
+         << "Statistics of results grouped by operating points\n\n"
+         << "Source data file" << CSVDELIMETER << m_conf->val_srcFile() << "\n"
+         << "Bin of n" << CSVDELIMETER << m_binN << CSVDELIMETER << "min-1\n"
+         << "Bin of Me" << CSVDELIMETER << m_binMe << CSVDELIMETER << "Nm\n"
+         << "Rows" << CSVDELIMETER << m_rows << "\n"
+         << "Bins" << CSVDELIMETER << m_bins.size() << "\n\n";
+
+    fout << colCaptions[NCOL] << CSVDELIMETER << colCaptions[MECOL] << CSVDELIMETER << "rows";
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        fout << CSVDELIMETER << resCaptions[k] << " mean"
+             << CSVDELIMETER << resCaptions[k] << " std"
+             << CSVDELIMETER << resCaptions[k] << " min"
+             << CSVDELIMETER << resCaptions[k] << " max";
+    }
+
+    fout << "\n";
+
+    for ( auto it=m_bins.begin(); it!=m_bins.end(); ++it ) {
+
+        fout << setprecision(6) << (it->first.first * m_binN) << CSVDELIMETER
+             << (it->first.second * m_binMe) << CSVDELIMETER
+             << it->second.rows;
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+
+            const Stats &st = it->second.res[k];
+
+            // values not calculated in all rows of the bin are left empty
+            if ( st.num == 0 ) {
+                fout << CSVDELIMETER << CSVDELIMETER << CSVDELIMETER << CSVDELIMETER;
+                continue;
+            }
+
+            fout << CSVDELIMETER << st.mean
+                 << CSVDELIMETER << ((st.num > 1) ? std::sqrt(st.m2 / (st.num - 1)) : 0)
+                 << CSVDELIMETER << st.min
+                 << CSVDELIMETER << st.max;
+        }
+
+        fout << "\n";
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\"created.\n";
+
+    return true;
+}
+
+void GroupStats::add(Stats &st, double x) {
+
+    if ( !std::isfinite(x) ) {
+        return;
+    }
+
+    // Welford's algorithm
+    st.num++;
+    const double delta = x - st.mean;
+    st.mean += delta / st.num;
+    st.m2 += delta * (x - st.mean);
+
+    st.min = std::min(st.min, x);
+    st.max = std::max(st.max, x);
+}
+
+void GroupStats::merge(Stats &st, const Stats &other) {
+
+    if ( other.num == 0 ) {
+        return;
+    }
+
+    const double num = static_cast<double>(st.num + other.num);
+    const double delta = other.mean - st.mean;
+
+    st.mean += delta * other.num / num;
+    st.m2 += other.m2 + delta * delta * st.num * other.num / num;
+    st.num += other.num;
+
+    st.min = std::min(st.min, other.min);
+    st.max = std::max(st.max, other.max);
+}
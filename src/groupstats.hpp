@@ -0,0 +1,87 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: groupstats.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GROUPSTATS_HPP
+#define GROUPSTATS_HPP
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <limits>
+
+#include "configuration.hpp"
+#include "constants.hpp"
+#include "tkrparameters.hpp"
+
+//
+// Statistics of results grouped by operating points. Rows are binned by
+// n and Me (bins of statBinN and statBinMe centered on multiples of bin
+// size), mean, standard deviation, min and max of every result column
+// of a bin are accumulated by Welford's algorithm in one pass. Rows are
+// not kept, memory depends on the number of bins only.
+//
+// Every thread accumulates its own partial statistics, partials are
+// merged at the end by the parallel form of the algorithm (Chan et al.).
+//
+
+class GroupStats {
+
+public:
+
+    GroupStats(const std::shared_ptr<Configuration> &conf);
+
+    void addRows(const TkrParameters &);
+    void addRows(const TkrParameters &, size_t first, size_t last);
+    void merge(const GroupStats &);
+
+    bool createReport() const;
+
+private:
+
+    struct Stats {
+        size_t num = 0;
+        double mean = 0;
+        double m2 = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+    };
+
+    struct Bin {
+        size_t rows = 0;
+        Stats res[RESNUM];
+    };
+
+    typedef std::pair<int64_t, int64_t> BinKey; // bins of n and Me
+
+    static void add(Stats &, double);
+    static void merge(Stats &, const Stats &);
+
+    std::shared_ptr<Configuration> m_conf;
+
+    double m_binN = 50;
+    double m_binMe = 20;
+
+    std::map<BinKey, Bin> m_bins; // ordered by n, then by Me
+    size_t m_rows = 0;
+
+};
+
+#endif // GROUPSTATS_HPP
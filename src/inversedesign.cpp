@@ -0,0 +1,413 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/inversedesign.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inversedesign.hpp"
+#include "tkrsourcedata.hpp"
+#include "tkrkernel.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+using std::cout;
+using std::string;
+using std::vector;
+using std::shared_ptr;
+
+namespace {
+
+const double NOSOLUTION = std::numeric_limits<double>::quiet_NaN();
+
+// turbine of one stage, values do not depend on Ft and phi
+struct TurbineData {
+    double Gexh; // kg/s
+    double Tt;   // turbine inlet temperature, K
+    double rhog; // density of gas after turbine, kg/m3
+    double Nt;   // required isentropic power, kW
+};
+
+// Ft for wastegate flow fraction phi, 0 if turbine can not produce required power
+double turbineFt(const TurbineData &d, double phi, double &Pit) {
+
+    const double Nmax = d.Gexh * (1 - phi) * 1.10892 * d.Tt;
+
+    if ( !(d.Nt < Nmax) || !(d.Nt > 0) ) {
+        Pit = NOSOLUTION;
+        return 0;
+    }
+
+    Pit = pow(1 - d.Nt / Nmax, -1 / 0.2593);
+
+    const double Cad = pow(2000 * d.Nt / d.Gexh / (1 - phi), 0.5);
+    const double muft = d.Gexh * (1 - phi) / d.rhog / Cad * 10000.0;
+
+    return tkrFt(muft, Pit);
+}
+
+// Root of Ft(phi) = Ft in [0, INVPHIMAX]. Ft decreases with phi, so the
+// bracket is searched from the guess in the direction of the root with
+// growing steps, then refined by Illinois regula falsi.
+double solvePhi(const TurbineData &d, double Ft, double guess, size_t &evals, double &Pit) {
+
+    auto f = [&](double phi) {
+        evals++;
+        return turbineFt(d, phi, Pit) - Ft;
+    };
+
+    double a = std::min(std::max(guess, 0.0), INVPHIMAX);
+    double fa = f(a);
+
+    if ( fa == 0 ) {
+        return a;
+    }
+
+    double b = a;
+    double fb = fa;
+    double step = INVPHISTEP;
+
+    while ( (fa > 0) == (fb > 0) ) {
+
+        if ( (fa > 0) ? (a == INVPHIMAX) : (a == 0) ) {
+            return NOSOLUTION;
+        }
+
+        b = (fa > 0) ? std::min(a + step, INVPHIMAX) : std::max(a - step, 0.0);
+        fb = f(b);
+
+        if ( fb == 0 ) {
+            return b;
+        }
+
+        if ( (fa > 0) == (fb > 0) ) {
+            a = b;
+            fa = fb;
+            step *= 2;
+        }
+    }
+
+    for ( size_t iter=0; iter<INVMAXITER; iter++ ) {
+
+        const double c = b - fb * (b - a) / (fb - fa);
+        const double fc = f(c);
+
+        if ( (fc > 0) != (fb > 0) ) {
+            a = b;
+            fa = fb;
+        }
+        else {
+            fa *= 0.5;
+        }
+
+        b = c;
+        fb = fc;
+
+        if ( (fc == 0) || (std::fabs(b - a) < INVPHIACCUR) ) {
+            break;
+        }
+    }
+
+    // Pit of the last evaluation belongs to b
+    return b;
+}
+
+} // namespace
+
+InverseDesign::InverseDesign(const shared_ptr<Configuration> &cfg) {
+    m_conf = cfg;
+}
+
+bool InverseDesign::selectParameters() {
+
+    const string target = m_conf->val_invTarget();
+    const string unknown = m_conf->val_invUnknown();
+
+    const size_t targets[] = {RES_PIK_LP, RES_PIK_HP, RES_NUTKR_LP, RES_NUTKR_HP, RES_NUSYS};
+    const size_t unknowns[] = {RES_FT_LP, RES_FT_HP, RES_PHI_LP, RES_PHI_HP};
+
+    m_target = RESNUM;
+    m_unknown = RESNUM;
+
+    for ( size_t k=0; k<(sizeof(targets) / sizeof(targets[0])); k++ ) {
+        if ( resCaptions[targets[k]] == target ) {
+            m_target = targets[k];
+        }
+    }
+
+    for ( size_t k=0; k<(sizeof(unknowns) / sizeof(unknowns[0])); k++ ) {
+        if ( resCaptions[unknowns[k]] == unknown ) {
+            m_unknown = unknowns[k];
+        }
+    }
+
+    if ( m_target == RESNUM ) {
+        cout << ERRORMSGBLANK << "Unknown target \"" << target << "\" of inverse design!\n";
+        return false;
+    }
+
+    if ( m_unknown == RESNUM ) {
+        cout << ERRORMSGBLANK << "Unknown solved parameter \"" << unknown << "\" of inverse design!\n";
+        return false;
+    }
+
+    m_stage = ((m_unknown == RES_FT_HP) || (m_unknown == RES_PHI_HP)) ? 1 : 0;
+    m_solvePhi = (m_unknown == RES_PHI_LP) || (m_unknown == RES_PHI_HP);
+
+    const bool targetHp = (m_target == RES_PIK_HP) || (m_target == RES_NUTKR_HP);
+
+    if ( (m_target != RES_NUSYS) && (targetHp != (m_stage == 1)) ) {
+        cout << ERRORMSGBLANK << "Target \"" << target << "\" and solved parameter \""
+             << unknown << "\" of inverse design belong to different stages!\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool InverseDesign::calculate(const vector< vector<double> > &v) {
+
+    if ( v.empty() || !selectParameters() ) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    m_srcdata = &v;
+    m_n = v.size();
+
+    ma_n.resize(m_n);
+    ma_Me.resize(m_n);
+    ma_targetMeas.resize(m_n);
+    ma_unknownMeas.resize(m_n);
+    ma_unknown.resize(m_n);
+    ma_Pit.resize(m_n);
+    ma_evals.resize(m_n);
+
+    size_t thrnum = m_conf->val_invThreads();
+
+    if ( thrnum == 0 ) {
+        thrnum = std::thread::hardware_concurrency();
+    }
+    if ( thrnum == 0 ) {
+        thrnum = 1;
+    }
+    if ( thrnum > m_n ) {
+        thrnum = m_n;
+    }
+
+    // contiguous ranges keep neighbouring points in one thread for warm starts
+    vector<std::thread> threads;
+
+    for ( size_t t=1; t<thrnum; t++ ) {
+        threads.push_back(std::thread(&InverseDesign::calculateRows, this, m_n * t / thrnum, m_n * (t + 1) / thrnum));
+    }
+
+    calculateRows(0, m_n / thrnum);
+
+    for ( size_t t=0; t<threads.size(); t++ ) {
+        threads[t].join();
+    }
+
+    m_srcdata = nullptr;
+
+    size_t evals = 0;
+    size_t solved = 0;
+
+    for ( size_t i=0; i<m_n; i++ ) {
+        evals += ma_evals[i];
+        solved += std::isfinite(ma_unknown[i]);
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    cout << MSGBLANK << "Inverse design: " << solved << " of " << m_n << " rows solved, "
+         << std::round(100.0 * evals / m_n) / 100.0 << " evaluations per row, "
+         << static_cast<size_t>(std::ceil(ms)) << " ms.\n";
+
+    if ( solved < m_n ) {
+        cout << WARNMSGBLANK << "Target of inverse design can not be reached in " << (m_n - solved) << " rows.\n";
+    }
+
+    return true;
+}
+
+void InverseDesign::calculateRows(size_t first, size_t last) {
+
+    const TkrCalcParams params = m_conf->val_calcParams();
+    const double value = m_conf->val_invValue();
+    const double givenFt = m_conf->val_invFt();
+
+    // shared validation and preCalculate of the range
+    const vector< vector<double> > rows(m_srcdata->begin() + first, m_srcdata->begin() + last);
+
+    if ( rows.empty() ) {
+        return;
+    }
+
+    TkrSourceData src;
+    src.calculate(rows);
+
+    double prevPhi = NOSOLUTION;
+
+    for ( size_t j=0; j<rows.size(); j++ ) {
+
+        const size_t i = first + j;
+
+        ma_n[i] = rows[j][NCOL];
+        ma_Me[i] = rows[j][MECOL];
+        ma_evals[i] = 0;
+
+        if ( src.isMasked(j) || (src.val_absentStations(j) & resStations[m_unknown]) ) {
+            ma_targetMeas[i] = ma_unknownMeas[i] = ma_unknown[i] = ma_Pit[i] = NOSOLUTION;
+            continue;
+        }
+
+        TkrRow<double> r;
+
+        src.loadRow(j, r);
+        tkrCalculate(r, params);
+
+        ma_targetMeas[i] = tkrResult(r, m_target);
+        ma_unknownMeas[i] = tkrResult(r, m_unknown);
+
+        const double Ncomp = m_stage ? r.Ncomp_hp : r.Ncomp_lp;
+        const double nuad  = m_stage ? r.nuad_hp : r.nuad_lp;
+        const double nute  = m_stage ? r.nute_hp : r.nute_lp;
+
+        TurbineData d;
+        d.Gexh = r.G_real[GAS_EXH];
+        d.Tt   = m_stage ? r.st_T_r[ST_PT_HP] : r.st_T_r[ST_PT_LP];
+        d.rhog = m_stage ? r.rhog_hp : r.rhog_lp;
+
+        // required turbine power, efficiencies of the row are kept
+        if ( (m_target == RES_PIK_LP) || (m_target == RES_PIK_HP) ) {
+
+            const double Tin = m_stage ? r.st_T_r[ST_PKS_LP] : r.st_T_r[ST_S];
+            const double NcompTarget = r.G_real[GAS_AIR] * 1.009 * Tin * (pow(value, 0.2857) - 1);
+
+            d.Nt = NcompTarget * 0.95 / (nute * nuad);
+        }
+        else if ( m_target == RES_NUSYS ) {
+            d.Nt = 0.95 * Ncomp / (value / (m_stage ? r.nutkr_lp : r.nutkr_hp));
+        }
+        else {
+            d.Nt = 0.95 * Ncomp / value;
+        }
+
+        double Pit = NOSOLUTION;
+
+        if ( m_solvePhi ) {
+
+            const double Ft = (givenFt > 0) ? givenFt : (m_stage ? r.Ft_hp : r.Ft_lp);
+            const double guess = std::isfinite(prevPhi) ? prevPhi : ma_unknownMeas[i];
+
+            ma_unknown[i] = (Ft > 0) ? solvePhi(d, Ft, guess, ma_evals[i], Pit) : NOSOLUTION;
+
+            if ( std::isfinite(ma_unknown[i]) ) {
+                prevPhi = ma_unknown[i];
+            }
+        }
+        else {
+
+            const double phi = m_stage ? r.phi_hp : r.phi_lp;
+            const double Ft = turbineFt(d, phi, Pit);
+
+            ma_evals[i] = 1;
+            ma_unknown[i] = (Ft > 0) ? Ft : NOSOLUTION;
+        }
+
+        ma_Pit[i] = std::isfinite(ma_unknown[i]) ? Pit : NOSOLUTION;
+    }
+}
+
+bool InverseDesign::createReport() const {
+
+    const string fileName = reportFileName(INVREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n";
+
+    if ( !m_conf->val_profileName().empty() ) {
+        fout << "Configuration profile: " << m_conf->val_profileName() << "\n\n";
+    }
+
+    const string &target = resCaptions[m_target];
+    const string &unknown = resCaptions[m_unknown];
+
+    fout << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
+         << "Inverse design\n\n"
+         << "Target" << CSVDELIMETER << target << CSVDELIMETER << m_conf->val_invValue() << "\n"
+         << "Solved parameter" << CSVDELIMETER << unknown << "\n";
+
+    if ( m_solvePhi ) {
+        fout << "Turbine area Ft[cm2]" << CSVDELIMETER;
+
+        if ( m_conf->val_invFt() > 0 ) {
+            fout << m_conf->val_invFt() << "\n";
+        }
+        else {
+            fout << "measured\n";
+        }
+    }
+
+    fout << "\n"
+         << "n[min-1]" << CSVDELIMETER
+         << "Me[Nm]"   << CSVDELIMETER
+         << target << " measured" << CSVDELIMETER
+         << unknown << " measured" << CSVDELIMETER
+         << unknown << " required" << CSVDELIMETER
+         << "Pit" << (m_stage ? "_hp" : "_lp") << "[-] required" << CSVDELIMETER
+         << "Evaluations" << "\n";
+
+    // rows without solution have empty cells
+    for ( size_t i=0; i<m_n; i++ ) {
+        fout << cell(ma_n[i], 0)           << CSVDELIMETER
+             << cell(ma_Me[i], 0)          << CSVDELIMETER
+             << cell(ma_targetMeas[i], 3)  << CSVDELIMETER
+             << cell(ma_unknownMeas[i], 3) << CSVDELIMETER
+             << cell(ma_unknown[i], 3)     << CSVDELIMETER
+             << cell(ma_Pit[i], 3)         << CSVDELIMETER << ma_evals[i] << "\n";
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\" created.\n";
+
+    return true;
+}
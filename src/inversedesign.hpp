@@ -0,0 +1,73 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/inversedesign.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INVERSEDESIGN_HPP
+#define INVERSEDESIGN_HPP
+
+#include <vector>
+#include <memory>
+
+#include "configuration.hpp"
+
+//
+// Inverse design: for every source data row finds turbine area Ft or
+// wastegate flow fraction phi of one stage which gives the target value of
+// Pik, nu_tkr or nu_sys of the row. Compressor and turbine efficiencies,
+// flows and temperatures are taken from the forward calculation of the
+// row. Rows are divided into contiguous ranges between threads, the root
+// finder of phi starts from the solution of the previous row.
+//
+
+class InverseDesign {
+
+public:
+
+    InverseDesign(const std::shared_ptr<Configuration> &conf);
+
+    bool calculate(const std::vector< std::vector<double> > &);
+    bool createReport() const;
+
+private:
+
+    bool selectParameters();
+    void calculateRows(size_t, size_t);
+
+    std::shared_ptr<Configuration> m_conf;
+
+    const std::vector< std::vector<double> > *m_srcdata = nullptr;
+
+    size_t m_n = 0;
+
+    size_t m_target = 0;  // target result column
+    size_t m_unknown = 0; // solved result column
+    size_t m_stage = 0;   // 0 - low pressure, 1 - high pressure
+    bool m_solvePhi = false;
+
+    std::vector<double> ma_n;
+    std::vector<double> ma_Me;
+    std::vector<double> ma_targetMeas;  // measured value of target result
+    std::vector<double> ma_unknownMeas; // measured value of solved result
+    std::vector<double> ma_unknown;     // solution, NaN if target can not be reached
+    std::vector<double> ma_Pit;         // turbine pressure ratio of solution
+    std::vector<size_t> ma_evals;       // evaluations of turbine model
+
+};
+
+#endif // INVERSEDESIGN_HPP
@@ -0,0 +1,201 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: kdtree.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KDTREE_HPP
+#define KDTREE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+//
+// Static two-dimensional k-d tree. Nodes are stored implicitly in one
+// array: median of range [b, e) is the node, its subtrees are the ranges
+// on both sides, split axis alternates with depth. Points can be removed,
+// numbers of remaining points in subtrees let searches skip empty ones.
+//
+
+class KdTree2 {
+
+public:
+
+    struct Point {
+        double x;
+        double y;
+        size_t id;
+    };
+
+    KdTree2() {
+    }
+
+    void build(const std::vector<Point> &points) {
+        ma_nodes = points;
+        ma_alive.assign(ma_nodes.size(), 0);
+        ma_removed.assign(ma_nodes.size(), false);
+        build(0, ma_nodes.size(), 0);
+    }
+
+    // removes point id with coordinates x, y, returns false if it is not found
+    bool remove(double x, double y, size_t id) {
+        return remove(0, ma_nodes.size(), 0, x, y, id);
+    }
+
+    size_t size() const {
+        return ma_nodes.size();
+    }
+
+    typedef std::vector< std::pair<double, size_t> > Neighbours;
+
+    // k nearest points as pairs of squared distance and id sorted by distance,
+    // result vector is reused by the caller, so the tree is shared by threads
+    void nearest(double x, double y, size_t k, Neighbours &res) const {
+
+        res.clear();
+
+        if ( k > 0 ) {
+            search(0, ma_nodes.size(), 0, x, y, k, res);
+        }
+
+        std::sort_heap(res.begin(), res.end());
+
+        for ( size_t i=0; i<res.size(); i++ ) {
+            res[i].second = ma_nodes[res[i].second].id;
+        }
+    }
+
+private:
+
+    static bool lessX(const Point &a, const Point &b) {
+        return a.x < b.x;
+    }
+    static bool lessY(const Point &a, const Point &b) {
+        return a.y < b.y;
+    }
+
+    void build(size_t b, size_t e, size_t depth) {
+
+        if ( b >= e ) {
+            return;
+        }
+
+        const size_t m = b + (e - b) / 2;
+
+        ma_alive[m] = e - b;
+
+        if ( (e - b) < 2 ) {
+            return;
+        }
+
+        std::nth_element(ma_nodes.begin() + b, ma_nodes.begin() + m, ma_nodes.begin() + e,
+                         (depth % 2 == 0) ? lessX : lessY);
+
+        build(b, m, depth + 1);
+        build(m + 1, e, depth + 1);
+    }
+
+    bool remove(size_t b, size_t e, size_t depth, double x, double y, size_t id) {
+
+        if ( b >= e ) {
+            return false;
+        }
+
+        const size_t m = b + (e - b) / 2;
+        const Point &p = ma_nodes[m];
+
+        if ( ma_alive[m] == 0 ) {
+            return false;
+        }
+
+        bool found = false;
+
+        if ( (p.id == id) && !ma_removed[m] ) {
+            ma_removed[m] = true;
+            found = true;
+        }
+        else {
+
+            // points equal to the split value can be on both sides
+            const double diff = (depth % 2 == 0) ? (x - p.x) : (y - p.y);
+
+            found = ((diff <= 0) && remove(b, m, depth + 1, x, y, id)) ||
+                    ((diff >= 0) && remove(m + 1, e, depth + 1, x, y, id));
+        }
+
+        if ( found ) {
+            ma_alive[m]--;
+        }
+
+        return found;
+    }
+
+    void search(size_t b, size_t e, size_t depth, double x, double y, size_t k, Neighbours &heap) const {
+
+        if ( b >= e ) {
+            return;
+        }
+
+        const size_t m = b + (e - b) / 2;
+
+        if ( ma_alive[m] == 0 ) {
+            return;
+        }
+
+        const Point &p = ma_nodes[m];
+
+        const double dx = p.x - x;
+        const double dy = p.y - y;
+        const double d2 = dx * dx + dy * dy;
+
+        // max-heap of k best candidates, removed node only splits the space
+        if ( !ma_removed[m] ) {
+            if ( heap.size() < k ) {
+                heap.push_back(std::make_pair(d2, m));
+                std::push_heap(heap.begin(), heap.end());
+            }
+            else if ( d2 < heap.front().first ) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = std::make_pair(d2, m);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+
+        const double diff = (depth % 2 == 0) ? (x - p.x) : (y - p.y);
+
+        const size_t nb = (diff < 0) ? b : (m + 1);
+        const size_t ne = (diff < 0) ? m : e;
+        const size_t fb = (diff < 0) ? (m + 1) : b;
+        const size_t fe = (diff < 0) ? e : m;
+
+        search(nb, ne, depth + 1, x, y, k, heap);
+
+        // far subtree only if splitting line is closer than the worst candidate
+        if ( (heap.size() < k) || ((diff * diff) < heap.front().first) ) {
+            search(fb, fe, depth + 1, x, y, k, heap);
+        }
+    }
+
+    std::vector<Point> ma_nodes;
+    std::vector<size_t> ma_alive;  // remaining points in subtree of node
+    std::vector<bool> ma_removed;
+
+};
+
+#endif // KDTREE_HPP
@@ -0,0 +1,126 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: latencyhistogram.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "constants.hpp"
+
+//
+// Histogram of latencies in nanoseconds with buckets of fixed relative
+// width: values below LATSUBBUCKETS have own buckets, every next power of
+// two is divided into LATSUBBUCKETS buckets, so percentiles are accurate
+// to 1/LATSUBBUCKETS. Counters are a member array, record() does not
+// allocate and does not throw.
+//
+
+class LatencyHistogram {
+
+public:
+
+    LatencyHistogram() {
+        clear();
+    }
+
+    void clear() noexcept {
+
+        for ( size_t b=0; b<LATBUCKETNUM; b++ ) {
+            ma_counts[b] = 0;
+        }
+
+        m_count = 0;
+        m_max = 0;
+    }
+
+    void record(uint64_t ns) noexcept {
+
+        ma_counts[bucket(ns)]++;
+        m_count++;
+
+        if ( ns > m_max ) {
+            m_max = ns;
+        }
+    }
+
+    // upper bound of bucket of the percentile p (0 - 100), ns
+    uint64_t percentile(double p) const noexcept {
+
+        const uint64_t rank = static_cast<uint64_t>(p / 100.0 * m_count + 0.5);
+        uint64_t sum = 0;
+
+        for ( size_t b=0; b<LATBUCKETNUM; b++ ) {
+
+            sum += ma_counts[b];
+
+            if ( (sum >= rank) && (sum > 0) ) {
+                return (upperBound(b) < m_max) ? upperBound(b) : m_max;
+            }
+        }
+
+        return m_max;
+    }
+
+    uint64_t val_count() const {
+        return m_count;
+    }
+    uint64_t val_max() const {
+        return m_max;
+    }
+
+private:
+
+    static size_t bucket(uint64_t v) noexcept {
+
+        if ( v < LATSUBBUCKETS ) {
+            return static_cast<size_t>(v);
+        }
+
+        // v >> e is in [LATSUBBUCKETS, 2 * LATSUBBUCKETS)
+        size_t e = 0;
+
+        while ( (v >> e) >= (2 * LATSUBBUCKETS) ) {
+            e++;
+        }
+
+        return (e + 1) * LATSUBBUCKETS + static_cast<size_t>((v >> e) - LATSUBBUCKETS);
+    }
+
+    static uint64_t upperBound(size_t b) noexcept {
+
+        if ( b < LATSUBBUCKETS ) {
+            return b;
+        }
+
+        const size_t e = b / LATSUBBUCKETS - 1;
+        const uint64_t m = b % LATSUBBUCKETS + LATSUBBUCKETS;
+
+        return ((m + 1) << e) - 1;
+    }
+
+    uint64_t ma_counts[LATBUCKETNUM];
+    uint64_t m_count = 0;
+    uint64_t m_max = 0;
+
+};
+
+#endif // LATENCYHISTOGRAM_HPP
@@ -23,11 +23,26 @@
 #include <string>
 #include <vector>
 
+#include <boost/lexical_cast.hpp>
+
 #include "configuration.hpp"
-#include "identification.hpp"
 #include "constants.hpp"
 #include "auxfunctions.hpp"
+#include "tkrsourcedata.hpp"
 #include "tkrparameters.hpp"
+#include "uncertainty.hpp"
+#include "sensitivity.hpp"
+#include "pipeline.hpp"
+#include "turbomaps.hpp"
+#include "comparison.hpp"
+#include "resultsstore.hpp"
+#include "inversedesign.hpp"
+#include "matching.hpp"
+#include "realtime.hpp"
+#include "batch.hpp"
+#include "groupstats.hpp"
+#include "cli.hpp"
+#include "trace.hpp"
 
 using std::unique_ptr;
 using std::shared_ptr;
@@ -35,30 +50,376 @@ using std::string;
 using std::vector;
 using std::cout;
 using std::cin;
+using std::cerr;
 
-int main() {
+// calculation of source data file of configuration with all analyses of profiles
+static bool calculate(const shared_ptr<Configuration> &conf) {
 
-    cout << "\n\t" << Identification{}.name() << " v" << Identification{}.version() << "\n"
-         << "\t" << Identification{}.description() << "\n\n"
-         << "Copyright (C) " << Identification{}.copyrightYears() << " " << Identification{}.authors() << "\n\n"
-         << Identification{}.licenseInformation() << "\n\n";
+    const vector< shared_ptr<Configuration> > profiles = conf->profiles();
 
-    shared_ptr<Configuration> conf(new Configuration());
-    conf->readConfigFile();
+    bool srcNeeded = (conf->val_pipeline() == 0);
+
+    for ( size_t p=0; p<profiles.size(); p++ ) {
+        if ( (profiles[p]->val_mcSamples() > 0) || !profiles[p]->val_saResults().empty() ||
+             !profiles[p]->val_invTarget().empty() || (profiles[p]->val_matchGrid() > 0) ) {
+            srcNeeded = true;
+        }
+    }
+
+    vector< vector<double> > srcdata;
+
+    if ( srcNeeded ) {
+        TRACESCOPE("read source data");
+        srcdata = srcData(conf);
+    }
+
+    // points of compressor and turbine maps of every profile
+    vector< vector<MapPoint> > mapPoints(profiles.size());
 
-    vector< vector<double> > srcdata = srcData();
+    unique_ptr<ResultsStore> store;
 
-    unique_ptr<TkrParameters> tkr(new TkrParameters(conf));
-    
-    if ( tkr->calculate(srcdata) ) {
-        tkr->createReport();
+    if ( !conf->val_storeDir().empty() ) {
+
+        store.reset(new ResultsStore(conf));
+
+        if ( !store->open() || !store->beginRuns(profiles) ) {
+            cout << WARNMSGBLANK << "Results will not be stored.\n";
+            store.reset();
+        }
+    }
+
+    bool resultsNeeded = static_cast<bool>(store);
+
+    for ( size_t p=0; p<profiles.size(); p++ ) {
+        if ( profiles[p]->val_mapBuild() ) {
+            resultsNeeded = true;
+        }
+    }
+
+    // results of every profile are passed here in source order
+    const Pipeline::ResultHandler handleResults = [&](size_t p, const TkrParameters &tkr) {
+
+        if ( profiles[p]->val_mapBuild() ) {
+            TurboMaps::extractPoints(tkr, mapPoints[p]);
+        }
+
+        if ( store ) {
+            store->addRows(p, tkr);
+        }
+    };
+
+    bool statsNeeded = false;
+
+    for ( size_t p=0; p<profiles.size(); p++ ) {
+        if ( profiles[p]->val_statGroups() ) {
+            statsNeeded = true;
+        }
+    }
+
+    // grouped statistics of every profile, partial per compute thread
+    vector< vector<GroupStats> > stats(profiles.size());
+
+    bool calculated = true;
+    bool ok = true;
+
+    if ( conf->val_pipeline() > 0 ) {
+
+        unique_ptr<Pipeline> pipeline(new Pipeline(profiles));
+
+        if ( resultsNeeded ) {
+            pipeline->setResultHandler(handleResults);
+        }
+
+        if ( statsNeeded ) {
+
+            for ( size_t p=0; p<profiles.size(); p++ ) {
+                if ( profiles[p]->val_statGroups() ) {
+                    stats[p].assign(pipeline->val_threads(), GroupStats(profiles[p]));
+                }
+            }
+
+            pipeline->setComputeHandler([&stats](size_t w, size_t p, const TkrParameters &tkr) {
+                if ( !stats[p].empty() ) {
+                    stats[p][w].addRows(tkr, 0, tkr.val_rowsNum());
+                }
+            });
+        }
+
+        if ( !pipeline->run() ) {
+            cout << ERRORMSGBLANK << "Calculation failed!\n";
+            calculated = false;
+        }
     }
     else {
-        cout << ERRORMSGBLANK << "Calculation failed!\n";
+
+        shared_ptr<TkrSourceData> src(new TkrSourceData());
+        vector< shared_ptr<TkrParameters> > tkrs;
+
+        for ( size_t p=0; p<profiles.size(); p++ ) {
+            tkrs.push_back(shared_ptr<TkrParameters>(new TkrParameters(profiles[p])));
+        }
+
+        if ( src->calculate(srcdata) && TkrParameters::calculate(tkrs, src) ) {
+
+            src->val_validation().print();
+
+            cout << MSGBLANK << "Calculation completed.\n";
+
+            for ( size_t p=0; p<tkrs.size(); p++ ) {
+
+                ok = tkrs[p]->createReport() && ok;
+                handleResults(p, *tkrs[p]);
+
+                if ( profiles[p]->val_statGroups() ) {
+                    TRACESCOPE("grouped statistics");
+                    stats[p].push_back(GroupStats(profiles[p]));
+                    stats[p][0].addRows(*tkrs[p]);
+                }
+            }
+        }
+        else {
+            cout << ERRORMSGBLANK << "Calculation failed!\n";
+            calculated = false;
+        }
+    }
+
+    if ( store && calculated ) {
+        TRACESCOPE("commit results");
+        ok = store->commitRuns() && ok;
+    }
+
+    ok = calculated && ok;
+
+    for ( size_t p=0; p<profiles.size(); p++ ) {
+
+        if ( calculated && !stats[p].empty() ) {
+
+            for ( size_t w=1; w<stats[p].size(); w++ ) {
+                stats[p][0].merge(stats[p][w]);
+            }
+
+            ok = stats[p][0].createReport() && ok;
+        }
+
+        if ( profiles[p]->val_mapBuild() ) {
+
+            TRACESCOPE("build maps");
+
+            unique_ptr<TurboMaps> maps(new TurboMaps(profiles[p]));
+
+            maps->loadPoints();
+            maps->addPoints(mapPoints[p]);
+
+            if ( maps->savePoints() ) {
+                maps->build();
+                ok = maps->createReport() && ok;
+            }
+            else {
+                ok = false;
+            }
+
+            if ( profiles[p]->val_matchGrid() > 0 ) {
+
+                TRACESCOPE("matching");
+
+                unique_ptr<Matching> match(new Matching(profiles[p]));
+
+                if ( match->calculate(srcdata, *maps) ) {
+                    ok = match->createReport() && ok;
+                }
+                else {
+                    cout << ERRORMSGBLANK << "Matching simulation failed!\n";
+                    ok = false;
+                }
+            }
+        }
+        else if ( profiles[p]->val_matchGrid() > 0 ) {
+            cout << WARNMSGBLANK << "Matching simulation needs compressor and turbine maps (mapBuild=1)! Skipped.\n";
+        }
+
+        if ( profiles[p]->val_mcSamples() > 0 ) {
+
+            TRACESCOPE("uncertainty");
+
+            unique_ptr<Uncertainty> unc(new Uncertainty(profiles[p]));
+
+            if ( unc->calculate(srcdata) ) {
+                cout << MSGBLANK << "Uncertainty calculation completed.\n";
+                ok = unc->createReport() && ok;
+            }
+            else {
+                cout << ERRORMSGBLANK << "Uncertainty calculation failed!\n";
+                ok = false;
+            }
+        }
+
+        if ( !profiles[p]->val_saResults().empty() ) {
+
+            TRACESCOPE("sensitivity");
+
+            unique_ptr<Sensitivity> sa(new Sensitivity(profiles[p]));
+
+            if ( sa->calculate(srcdata) ) {
+                cout << MSGBLANK << "Sensitivity analysis completed.\n";
+                ok = sa->createReport() && ok;
+            }
+            else {
+                cout << ERRORMSGBLANK << "Sensitivity analysis failed!\n";
+                ok = false;
+            }
+        }
+
+        if ( !profiles[p]->val_invTarget().empty() ) {
+
+            TRACESCOPE("inverse design");
+
+            unique_ptr<InverseDesign> inv(new InverseDesign(profiles[p]));
+
+            if ( inv->calculate(srcdata) ) {
+                ok = inv->createReport() && ok;
+            }
+            else {
+                cout << ERRORMSGBLANK << "Inverse design failed!\n";
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+static int run(const CliOptions &opts) {
+
+    // reading of configuration is recorded when trace file is known
+    const uint64_t configBegin = Trace::now();
+
+    shared_ptr<Configuration> conf(new Configuration());
+
+    // default configuration file is optional, blank is created and defaults are used
+    if ( !conf->readConfigFile(opts.configFile) && opts.configGiven ) {
+        return EXITCONFIG;
+    }
+
+    for ( size_t i=0; i<opts.parameters.size(); i++ ) {
+        conf->overrideParameter(opts.parameters[i].first, opts.parameters[i].second);
+    }
+
+    if ( !conf->val_traceFile().empty() ) {
+        Trace::start(conf->val_traceFile());
+        Trace::setThreadName("main");
+        Trace::record("read configuration", configBegin, Trace::now());
+    }
+
+    // standard output is reserved for the report
+    if ( conf->val_reportStdout() && !opts.quiet ) {
+        cout.rdbuf(cerr.rdbuf());
+    }
+
+    if ( !conf->val_outDir().empty() && !makeDirs(conf->val_outDir()) ) {
+        cout << ERRORMSGBLANK << "Can not create directory \"" << conf->val_outDir() << "\"!\n";
+        return EXITFAILED;
+    }
+
+    // comparison of reports replaces calculation
+    if ( !conf->val_compareBase().empty() ) {
+
+        unique_ptr<Comparison> cmp(new Comparison(conf));
+
+        if ( !cmp->calculate() ) {
+            cout << ERRORMSGBLANK << "Comparison failed!\n";
+            return EXITFAILED;
+        }
+
+        cout << MSGBLANK << "Comparison completed.\n";
+
+        return cmp->createReport() ? EXITOK : EXITFAILED;
+    }
+
+    // query of results store replaces calculation
+    if ( !conf->val_queryResult().empty() ) {
+
+        unique_ptr<ResultsStore> store(new ResultsStore(conf));
+
+        if ( !store->open() || !store->query() ) {
+            cout << ERRORMSGBLANK << "Query failed!\n";
+            return EXITFAILED;
+        }
+
+        cout << MSGBLANK << "Query completed.\n";
+
+        return store->createReport() ? EXITOK : EXITFAILED;
+    }
+
+    // real-time calculation of points from shared memory replaces calculation
+    if ( !conf->val_rtInput().empty() ) {
+
+        unique_ptr<RealTime> rt(new RealTime(conf));
+
+        return rt->run() ? EXITOK : EXITFAILED;
+    }
+
+    // batch over list of source data files replaces single calculation
+    if ( !conf->val_batchList().empty() ) {
+
+        unique_ptr<Batch> batch(new Batch(conf));
+
+        return batch->run(calculate) ? EXITOK : EXITFAILED;
+    }
+
+    return calculate(conf) ? EXITOK : EXITFAILED;
+}
+
+int main(int argc, char **argv) {
+
+    CliOptions opts;
+
+    if ( !parseCommandLine(argc, argv, opts) ) {
+        printUsage(cerr);
+        return EXITUSAGE;
     }
 
-    cout << "\n\nPress any key to exit...";
-    cin.get();
+    if ( opts.help ) {
+        printUsage(cout);
+        return EXITOK;
+    }
+
+    if ( opts.version ) {
+        printVersion(cout);
+        return EXITOK;
+    }
+
+    std::streambuf *coutBuf = cout.rdbuf();
+    ErrorFilterBuf errorsOnly(cerr.rdbuf());
+
+    if ( opts.quiet ) {
+        cout.rdbuf(&errorsOnly);
+    }
+
+    int code = EXITOK;
+
+    try {
+        code = run(opts);
+    }
+    catch ( const ConfigError &e ) {
+        cout << ERRORMSGBLANK << e.what() << "\n";
+        code = EXITCONFIG;
+    }
+    catch ( const boost::bad_lexical_cast & ) {
+        cout << ERRORMSGBLANK << "Wrong value of configuration parameter!\n";
+        code = EXITCONFIG;
+    }
+
+    if ( !Trace::finish() && (code == EXITOK) ) {
+        code = EXITFAILED;
+    }
+
+    cout.flush();
+    cout.rdbuf(coutBuf);
+
+    if ( opts.pause ) {
+        cout << "\n\nPress Enter to exit...";
+        cin.get();
+    }
 
-    return 0;
+    return code;
 }
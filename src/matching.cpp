@@ -0,0 +1,652 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: matching.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "matching.hpp"
+#include "tkrsourcedata.hpp"
+#include "tkrkernel.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+using std::cout;
+using std::string;
+using std::vector;
+using std::shared_ptr;
+
+namespace {
+
+const double NOVALUE = std::numeric_limits<double>::quiet_NaN();
+
+// engine values interpolated between measured points
+enum {
+    ENG_GE,     // specific fuel consumption, kg/(kW*h)
+    ENG_NUV,    // volumetric efficiency
+    ENG_TT_HP,  // high pressure turbine inlet temperature, K
+    ENG_TT_LP,  // ratio of low and high pressure turbine inlet temperatures
+    ENG_TR,     // ratio of temperature after turbines and inlet temperature of the last turbine
+    ENG_TKS_LP, // temperatures after charge air coolers, K
+    ENG_TKS_HP,
+    ENG_PKS_LP, // pressure ratios of charge air coolers
+    ENG_PKS_HP,
+    ENG_PHI_LP, // wastegate flow fractions
+    ENG_PHI_HP,
+    ENG_DPR,    // pressure after turbines above ambient, kPa
+    ENG_FT_LP,  // turbine areas, cm2
+    ENG_FT_HP,
+    ENG_PIK_LP, // compressor pressure ratios, initial values of iteration
+    ENG_PIK_HP,
+    ENGNUM
+};
+
+enum {
+    MATCH_CONVERGED,
+    MATCH_NOTCONVERGED,
+    MATCH_OUTOFMAPS,
+    MATCH_NOTURBINEFLOW,
+    MATCHSTATUSNUM
+};
+
+const string statusCaptions[MATCHSTATUSNUM] = {
+    "converged",
+    "not converged",
+    "out of maps",
+    "no turbine flow"
+};
+
+// Pit at which turbine of area Ft passes gas flow G, NaN if Pit > MATCHPITMAX is needed.
+// Flow through the turbine grows with Pit, so the root is bracketed by [1, MATCHPITMAX]
+// and refined by Illinois regula falsi.
+double turbinePit(double Ft, double muPit2, double Tt, double rhog, double G) {
+
+    auto f = [&](double Pit) {
+        const double muft = Ft * muPit2 * (0.421189 * std::log(Pit) + 0.707889);
+        const double Cad = std::sqrt(2000 * 1.10892 * Tt * (1 - 1 / pow(Pit, 0.2593)));
+        return muft * rhog * Cad / 10000.0 - G;
+    };
+
+    double a = 1;
+    double fa = -G;
+    double b = MATCHPITMAX;
+    double fb = f(b);
+
+    if ( !(fb >= 0) || !(G > 0) ) {
+        return NOVALUE;
+    }
+
+    for ( size_t iter=0; iter<MATCHMAXITER; iter++ ) {
+
+        const double c = b - fb * (b - a) / (fb - fa);
+        const double fc = f(c);
+
+        if ( (fc > 0) != (fb > 0) ) {
+            a = b;
+            fa = fb;
+        }
+        else {
+            fa *= 0.5;
+        }
+
+        b = c;
+        fb = fc;
+
+        if ( (fc == 0) || (std::fabs(b - a) < MATCHACCUR) ) {
+            break;
+        }
+    }
+
+    return b;
+}
+
+} // namespace
+
+Matching::Matching(const shared_ptr<Configuration> &cfg) {
+    m_conf = cfg;
+}
+
+bool Matching::setEnginePoints(const vector< vector<double> > &v) {
+
+    const TkrCalcParams params = m_conf->val_calcParams();
+
+    TkrSourceData src;
+
+    if ( !src.calculate(v) ) {
+        return false;
+    }
+
+    vector<KdTree2::Point> points;
+
+    ma_engine.clear();
+
+    // two stages if any point has all stations measured, single stage if
+    // only the low pressure stage is not measured
+    size_t stageRows[2] = {0, 0};
+
+    for ( size_t i=0; i<src.val_rowsNum(); i++ ) {
+        if ( !src.isMasked(i) ) {
+            stageRows[0] += (src.val_absentStations(i) == STLPSTAGE);
+            stageRows[1] += (src.val_absentStations(i) == 0);
+        }
+    }
+
+    m_stages = ( (stageRows[1] == 0) && (stageRows[0] > 0) ) ? 1 : 2;
+
+    const unsigned absent = (m_stages == 1) ? STLPSTAGE : 0;
+
+    if ( m_stages == 1 ) {
+        cout << MSGBLANK << "Matching simulation: low pressure stage is not measured, single stage turbocharging.\n";
+    }
+
+    for ( size_t i=0; i<src.val_rowsNum(); i++ ) {
+
+        if ( src.isMasked(i) || (src.val_absentStations(i) != absent) ) {
+            continue;
+        }
+
+        TkrRow<double> r;
+
+        src.loadRow(i, r);
+        tkrCalculate(r, params);
+
+        double e[ENGNUM];
+
+        e[ENG_GE]     = r.Gfuel / r.Ne;
+        e[ENG_NUV]    = r.nuv;
+        e[ENG_TT_HP]  = r.st_T_r[ST_PT_HP];
+        e[ENG_TT_LP]  = r.st_T_r[ST_PT_LP] / r.st_T_r[ST_PT_HP];
+        e[ENG_TR]     = r.st_T_r[ST_PR] / r.st_T_r[(m_stages == 1) ? ST_PT_HP : ST_PT_LP];
+        e[ENG_TKS_LP] = r.st_T_r[ST_PKS_LP];
+        e[ENG_TKS_HP] = r.st_T_r[ST_PKS_HP];
+        e[ENG_PKS_LP] = r.st_P_dyn[ST_PKS_LP] / r.st_P_dyn[ST_PK_LP];
+        e[ENG_PKS_HP] = r.st_P_dyn[ST_PKS_HP] / r.st_P_dyn[ST_PK_HP];
+        e[ENG_PHI_LP] = r.phi_lp;
+        e[ENG_PHI_HP] = r.phi_hp;
+        e[ENG_DPR]    = r.st_P_dyn[ST_PR] - r.B0_r;
+        e[ENG_FT_LP]  = r.Ft_lp;
+        e[ENG_FT_HP]  = r.Ft_hp;
+        e[ENG_PIK_LP] = r.Pik_lp;
+        e[ENG_PIK_HP] = r.Pik_hp;
+
+        // low pressure stage is ambient
+        if ( m_stages == 1 ) {
+            e[ENG_TT_LP]  = 0;
+            e[ENG_TKS_LP] = 0;
+            e[ENG_PKS_LP] = 1;
+            e[ENG_PHI_LP] = 0;
+            e[ENG_FT_LP]  = 0;
+            e[ENG_PIK_LP] = 1;
+        }
+
+        bool valid = ((r.Ft_lp > 0) || (m_stages == 1)) && (r.Ft_hp > 0) && (r.n > 0) && (r.Ne > 0);
+
+        for ( size_t k=0; k<ENGNUM; k++ ) {
+            valid = valid && std::isfinite(e[k]);
+        }
+
+        if ( !valid ) {
+            continue;
+        }
+
+        if ( points.empty() ) {
+            m_nMin = m_nMax = r.n;
+            m_MeMin = m_MeMax = r.Me;
+        }
+        else {
+            m_nMin = std::min(m_nMin, r.n);
+            m_nMax = std::max(m_nMax, r.n);
+            m_MeMin = std::min(m_MeMin, r.Me);
+            m_MeMax = std::max(m_MeMax, r.Me);
+        }
+
+        KdTree2::Point p = {r.n, r.Me, points.size()};
+        points.push_back(p);
+
+        ma_engine.insert(ma_engine.end(), e, e + ENGNUM);
+    }
+
+    if ( points.empty() ) {
+        cout << ERRORMSGBLANK << "No valid operating points for matching simulation!\n";
+        return false;
+    }
+
+    if ( m_nMax == m_nMin ) {
+        m_nMax = m_nMin + 1;
+    }
+
+    if ( m_MeMax == m_MeMin ) {
+        m_MeMax = m_MeMin + 1;
+    }
+
+    // tree in coordinates normalized to the measured range
+    for ( size_t i=0; i<points.size(); i++ ) {
+        points[i].x = (points[i].x - m_nMin) / (m_nMax - m_nMin);
+        points[i].y = (points[i].y - m_MeMin) / (m_MeMax - m_MeMin);
+    }
+
+    m_engineTree.build(points);
+
+    return true;
+}
+
+void Matching::interpolateEngine(double n, double Me, KdTree2::Neighbours &nb, double *e) const {
+
+    const double xn = (n - m_nMin) / (m_nMax - m_nMin);
+    const double yn = (Me - m_MeMin) / (m_MeMax - m_MeMin);
+
+    m_engineTree.nearest(xn, yn, std::max<size_t>(m_conf->val_mapNeighbours(), 1), nb);
+
+    // query in measured point
+    if ( nb[0].first < 1e-24 ) {
+        std::copy(&ma_engine[nb[0].second * ENGNUM], &ma_engine[nb[0].second * ENGNUM] + ENGNUM, e);
+        return;
+    }
+
+    double wsum = 0;
+
+    std::fill(e, e + ENGNUM, 0.0);
+
+    for ( size_t i=0; i<nb.size(); i++ ) {
+
+        const double w = 1.0 / nb[i].first;
+        const double *v = &ma_engine[nb[i].second * ENGNUM];
+
+        for ( size_t k=0; k<ENGNUM; k++ ) {
+            e[k] += w * v[k];
+        }
+
+        wsum += w;
+    }
+
+    for ( size_t k=0; k<ENGNUM; k++ ) {
+        e[k] /= wsum;
+    }
+}
+
+bool Matching::calculate(const vector< vector<double> > &v, const TurboMaps &maps) {
+
+    if ( v.empty() || !setEnginePoints(v) ) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    m_maps = &maps;
+
+    const size_t gridSize = std::min(std::max<size_t>(m_conf->val_matchGrid(), 2), size_t(MAPMAXGRIDSIZE));
+
+    double nMin = m_nMin;
+    double nMax = m_nMax;
+    double MeMin = m_MeMin;
+    double MeMax = m_MeMax;
+
+    if ( m_conf->val_matchNMin() < m_conf->val_matchNMax() ) {
+        nMin = m_conf->val_matchNMin();
+        nMax = m_conf->val_matchNMax();
+    }
+
+    if ( m_conf->val_matchMeMin() < m_conf->val_matchMeMax() ) {
+        MeMin = m_conf->val_matchMeMin();
+        MeMax = m_conf->val_matchMeMax();
+    }
+
+    ma_points.resize(gridSize * gridSize);
+
+    for ( size_t j=0; j<gridSize; j++ ) {
+        for ( size_t i=0; i<gridSize; i++ ) {
+
+            MatchPoint &p = ma_points[j * gridSize + i];
+
+            p.n = nMin + (nMax - nMin) * i / (gridSize - 1);
+            p.Me = MeMin + (MeMax - MeMin) * j / (gridSize - 1);
+        }
+    }
+
+    size_t thrnum = m_conf->val_matchThreads();
+
+    if ( thrnum == 0 ) {
+        thrnum = std::thread::hardware_concurrency();
+    }
+    if ( thrnum == 0 ) {
+        thrnum = 1;
+    }
+    if ( thrnum > ma_points.size() ) {
+        thrnum = ma_points.size();
+    }
+
+    // contiguous ranges keep neighbouring nodes in one thread for warm starts
+    const size_t num = ma_points.size();
+
+    vector<std::thread> threads;
+
+    for ( size_t t=1; t<thrnum; t++ ) {
+        threads.push_back(std::thread(&Matching::calculatePoints, this, num * t / thrnum, num * (t + 1) / thrnum));
+    }
+
+    calculatePoints(0, num / thrnum);
+
+    for ( size_t t=0; t<threads.size(); t++ ) {
+        threads[t].join();
+    }
+
+    m_maps = nullptr;
+
+    size_t statusNum[MATCHSTATUSNUM] = {0, 0, 0, 0};
+    size_t iter = 0;
+
+    for ( size_t i=0; i<num; i++ ) {
+        statusNum[ma_points[i].status]++;
+        iter += ma_points[i].iter;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    cout << MSGBLANK << "Matching simulation: " << statusNum[MATCH_CONVERGED] << " of " << num
+         << " grid points converged, " << std::round(100.0 * iter / num) / 100.0 << " iterations per point, "
+         << static_cast<size_t>(std::ceil(ms)) << " ms.\n";
+
+    for ( size_t s=MATCH_NOTCONVERGED; s<MATCHSTATUSNUM; s++ ) {
+        if ( statusNum[s] > 0 ) {
+            cout << WARNMSGBLANK << "Matching simulation: " << statusNum[s] << " grid points " << statusCaptions[s] << ".\n";
+        }
+    }
+
+    return true;
+}
+
+void Matching::calculatePoints(size_t first, size_t last) {
+
+    KdTree2::Neighbours nb;
+
+    double guess[2] = {NOVALUE, NOVALUE};
+
+    for ( size_t i=first; i<last; i++ ) {
+
+        MatchPoint &p = ma_points[i];
+
+        calculatePoint(p, guess, nb);
+
+        if ( p.status == MATCH_CONVERGED ) {
+            guess[0] = p.Pik[0];
+            guess[1] = p.Pik[1];
+        }
+    }
+}
+
+size_t Matching::balance(const double *e, const double *Pik, MatchPoint &p, double *res) const {
+
+    const double P0 = m_conf->val_B0_std();
+    const double T0 = m_conf->val_T0_std() + 273;
+    const double sysNum = m_conf->val_sysNum();
+
+    const double Ne = p.Me * p.n / 9549.0;
+    const double Gfuel = e[ENG_GE] * Ne / 3600.0;
+
+    const size_t first = 2 - m_stages;
+
+    // high pressure turbine of single stage exhausts to the Pr station
+    const double Tr = e[ENG_TT_HP] * ((first == 0) ? e[ENG_TT_LP] : 1) * e[ENG_TR];
+    const double Pr = P0 + e[ENG_DPR];
+    const double Tt[2] = {(first == 0) ? e[ENG_TT_HP] * e[ENG_TT_LP] : Tr, e[ENG_TT_HP]};
+    const double phi[2] = {e[ENG_PHI_LP], e[ENG_PHI_HP]};
+    const double Ft[2] = {e[ENG_FT_LP], e[ENG_FT_HP]};
+    const double Tks_lp = (first == 0) ? e[ENG_TKS_LP] : T0;
+
+    // charge air path
+    const double Pk_lp = P0 * Pik[0];
+    const double Pks_lp = Pk_lp * e[ENG_PKS_LP];
+    const double Pk_hp = Pks_lp * Pik[1];
+    const double Pks_hp = Pk_hp * e[ENG_PKS_HP];
+
+    const double Gair = e[ENG_NUV] * m_conf->val_Vh() / sysNum * p.n * Pks_hp / (0.12 * 288.294 * e[ENG_TKS_HP]);
+    const double Gexh = Gair + Gfuel / sysNum;
+
+    // turbines from the exit: pressure after the last turbine is known
+    double Pt[2] = {Pr, Pr};
+
+    p.Pit[0] = NOVALUE;
+
+    if ( first == 0 ) {
+
+        p.Pit[0] = turbinePit(Ft[0], tkrMuPit2(Ft[0]), Tt[0], Pr * 1000.0 / 287.497 / Tr, Gexh * (1 - phi[0]));
+        Pt[0] = Pr * p.Pit[0];
+
+        if ( !std::isfinite(p.Pit[0]) ) {
+            return MATCH_NOTURBINEFLOW;
+        }
+    }
+
+    p.Pit[1] = turbinePit(Ft[1], tkrMuPit2(Ft[1]), Tt[1], Pt[0] * 1000.0 / 287.497 / Tt[0], Gexh * (1 - phi[1]));
+    Pt[1] = Pt[0] * p.Pit[1];
+
+    if ( !std::isfinite(p.Pit[1]) ) {
+        return MATCH_NOTURBINEFLOW;
+    }
+
+    // ambient conditions are the standard ones
+    const double Gair_r[2] = {Gair, Gair * P0 / Pks_lp * std::sqrt(Tks_lp / T0)};
+    const double Tin[2] = {T0, Tks_lp};
+
+    res[0] = 0;
+
+    p.Pik[0] = Pik[0];
+    p.nuad[0] = NOVALUE;
+    p.nute[0] = NOVALUE;
+    p.Ft[0] = NOVALUE;
+    p.nutkr[0] = NOVALUE;
+
+    for ( size_t k=first; k<2; k++ ) {
+
+        const double Gexh_r = Gexh * std::sqrt(Tt[k]) / Pt[k] * (1 - phi[k]);
+
+        p.nuad[k] = m_maps->interpolate(MAP_COMP_LP + k, 0, Gair_r[k], Pik[k]);
+        p.nute[k] = m_maps->interpolate(MAP_TURB_LP + k, 0, Gexh_r, p.Pit[k]);
+
+        if ( !std::isfinite(p.nuad[k]) || !std::isfinite(p.nute[k]) ) {
+            return MATCH_OUTOFMAPS;
+        }
+
+        // power balance with the definition of nute of the forward calculation
+        const double Nt_dis = Gexh * (1 - phi[k]) * 1.10892 * Tt[k] * (1 - 1 / pow(p.Pit[k], 0.2593));
+        const double Ncomp = Nt_dis * p.nute[k] * p.nuad[k] / 0.95;
+
+        res[k] = pow(1 + Ncomp / (Gair * 1.009 * Tin[k]), 1 / 0.2857) - Pik[k];
+
+        p.Pik[k] = Pik[k];
+        p.Ft[k] = Ft[k];
+        p.nutkr[k] = p.nuad[k] * p.nute[k];
+    }
+
+    p.Gair = Gair * 3600.0;
+    p.Pk_hp = Pk_hp;
+
+    return MATCH_CONVERGED;
+}
+
+void Matching::calculatePoint(MatchPoint &p, const double *guess, KdTree2::Neighbours &nb) const {
+
+    double e[ENGNUM];
+
+    interpolateEngine(p.n, p.Me, nb, e);
+
+    double Pik[2] = {e[ENG_PIK_LP], e[ENG_PIK_HP]};
+
+    if ( std::isfinite(guess[0]) ) {
+        Pik[0] = guess[0];
+        Pik[1] = guess[1];
+    }
+
+    // Newton iteration on residuals of power balances of both stages with
+    // Jacobian by finite differences, steps are limited to MATCHMAXSTEP
+    MatchPoint tmp = p;
+
+    for ( p.iter=1; p.iter<=MATCHMAXITER; p.iter++ ) {
+
+        double res[2];
+
+        p.status = balance(e, Pik, p, res);
+
+        if ( p.status != MATCH_CONVERGED ) {
+            return;
+        }
+
+        if ( std::max(std::fabs(res[0]) / Pik[0], std::fabs(res[1]) / Pik[1]) < MATCHACCUR ) {
+            return;
+        }
+
+        // single stage: only the high pressure ratio is iterated, the low
+        // pressure one stays 1 with zero residual
+        const size_t first = 2 - m_stages;
+
+        double J[2][2] = {{1, 0}, {0, 1}};
+        bool jacobian = true;
+
+        for ( size_t k=first; k<2; k++ ) {
+
+            double Pikh[2] = {Pik[0], Pik[1]};
+            double resh[2];
+
+            const double h = MATCHDIFFSTEP * Pik[k];
+
+            Pikh[k] += h;
+
+            if ( balance(e, Pikh, tmp, resh) != MATCH_CONVERGED ) {
+                jacobian = false;
+                break;
+            }
+
+            J[0][k] = (resh[0] - res[0]) / h;
+            J[1][k] = (resh[1] - res[1]) / h;
+        }
+
+        const double det = J[0][0] * J[1][1] - J[0][1] * J[1][0];
+
+        double d[2] = {res[0], res[1]};
+
+        if ( jacobian && (std::fabs(det) > 1e-12) ) {
+            d[0] = -(J[1][1] * res[0] - J[0][1] * res[1]) / det;
+            d[1] = -(J[0][0] * res[1] - J[1][0] * res[0]) / det;
+        }
+
+        for ( size_t k=first; k<2; k++ ) {
+            const double maxStep = MATCHMAXSTEP * Pik[k];
+            Pik[k] += std::max(-maxStep, std::min(d[k], maxStep));
+        }
+    }
+
+    p.iter = MATCHMAXITER;
+    p.status = MATCH_NOTCONVERGED;
+}
+
+bool Matching::createReport() const {
+
+    const string fileName = reportFileName(MATREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n";
+
+    if ( !m_conf->val_profileName().empty() ) {
+        fout << "Configuration profile: " << m_conf->val_profileName() << "\n\n";
+    }
+
+    fout << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
+         << "Engine-turbocharger matching simulation\n\n"
+         << "Ambient pressure[kPa]" << CSVDELIMETER << m_conf->val_B0_std() << "\n"
+         << "Ambient temperature[degC]" << CSVDELIMETER << m_conf->val_T0_std() << "\n"
+         << "Turbocharging stages" << CSVDELIMETER << m_stages << "\n\n"
+         << "n[min-1]" << CSVDELIMETER
+         << "Me[Nm]" << CSVDELIMETER
+         << "Gair[kg/h]" << CSVDELIMETER
+         << "Pk_hp[kPa]" << CSVDELIMETER
+         << resCaptions[RES_PIK_LP] << CSVDELIMETER
+         << resCaptions[RES_NUAD_LP] << CSVDELIMETER
+         << resCaptions[RES_PIT_LP] << CSVDELIMETER
+         << resCaptions[RES_NUTE_LP] << CSVDELIMETER
+         << resCaptions[RES_FT_LP] << CSVDELIMETER
+         << resCaptions[RES_PIK_HP] << CSVDELIMETER
+         << resCaptions[RES_NUAD_HP] << CSVDELIMETER
+         << resCaptions[RES_PIT_HP] << CSVDELIMETER
+         << resCaptions[RES_NUTE_HP] << CSVDELIMETER
+         << resCaptions[RES_FT_HP] << CSVDELIMETER
+         << resCaptions[RES_NUTKR_LP] << CSVDELIMETER
+         << resCaptions[RES_NUTKR_HP] << CSVDELIMETER
+         << resCaptions[RES_NUSYS] << CSVDELIMETER
+         << "Iterations" << CSVDELIMETER
+         << "Status" << "\n";
+
+    // points without solution have empty cells
+    auto put = [&fout](double val, int prec) {
+        fout << cell(val, prec) << CSVDELIMETER;
+    };
+
+    for ( size_t i=0; i<ma_points.size(); i++ ) {
+
+        const MatchPoint &p = ma_points[i];
+        const bool ok = (p.status == MATCH_CONVERGED);
+
+        put(p.n, 0);
+        put(p.Me, 0);
+        put(ok ? p.Gair : NOVALUE, 1);
+        put(ok ? p.Pk_hp : NOVALUE, 2);
+
+        // low pressure stage of single stage turbocharging is empty
+        for ( size_t k=0; k<2; k++ ) {
+
+            const bool stage = ok && (k >= 2 - m_stages);
+
+            put(stage ? p.Pik[k] : NOVALUE, 3);
+            put(stage ? p.nuad[k] : NOVALUE, 3);
+            put(stage ? p.Pit[k] : NOVALUE, 3);
+            put(stage ? p.nute[k] : NOVALUE, 3);
+            put(stage ? p.Ft[k] : NOVALUE, 3);
+        }
+
+        put(ok ? p.nutkr[0] : NOVALUE, 3);
+        put(ok ? p.nutkr[1] : NOVALUE, 3);
+        put(ok ? (p.nutkr[0] * p.nutkr[1]) : NOVALUE, 3);
+
+        fout << p.iter << CSVDELIMETER << statusCaptions[p.status] << "\n";
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\" created.\n";
+
+    return true;
+}
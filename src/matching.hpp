@@ -0,0 +1,100 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: matching.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATCHING_HPP
+#define MATCHING_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "configuration.hpp"
+#include "kdtree.hpp"
+#include "turbomaps.hpp"
+
+//
+// Grid point of matching simulation.
+//
+
+struct MatchPoint {
+    double n;
+    double Me;
+    size_t status;
+    size_t iter;
+    double Gair;     // kg/h
+    double Pk_hp;    // boost pressure, kPa
+    double Pik[2];   // low and high pressure stages
+    double nuad[2];
+    double Pit[2];
+    double nute[2];
+    double Ft[2];
+    double nutkr[2];
+};
+
+//
+// Engine-turbocharger matching simulation. In every node of the n-Me grid
+// the mass flow and power balances of both turbochargers are solved by
+// Newton iteration on compressor pressure ratios: air flow
+// follows from volumetric efficiency and boost pressure, turbine pressure
+// ratios from turbine areas and exhaust flow, efficiencies from grids of
+// the compressor and turbine maps. Engine values (fuel consumption, volumetric
+// efficiency, temperatures, wastegate fractions, turbine areas Ft) are
+// interpolated between measured operating points of the run.
+// If the low pressure stage is not measured in any point (single stage
+// turbocharging), only the high pressure stage is balanced with ambient
+// conditions at its inlet and turbine outlet, as in the forward calculation.
+//
+
+class Matching {
+
+public:
+
+    Matching(const std::shared_ptr<Configuration> &conf);
+
+    bool calculate(const std::vector< std::vector<double> > &, const TurboMaps &);
+    bool createReport() const;
+
+private:
+
+    bool setEnginePoints(const std::vector< std::vector<double> > &);
+    void interpolateEngine(double, double, KdTree2::Neighbours &, double *) const;
+    void calculatePoints(size_t, size_t);
+    void calculatePoint(MatchPoint &, const double *, KdTree2::Neighbours &) const;
+    size_t balance(const double *, const double *, MatchPoint &, double *) const;
+
+    std::shared_ptr<Configuration> m_conf;
+
+    const TurboMaps *m_maps = nullptr;
+
+    size_t m_stages = 2;               // 1 - only high pressure stage
+
+    double m_nMin = 0;
+    double m_nMax = 0;
+    double m_MeMin = 0;
+    double m_MeMax = 0;
+
+    KdTree2 m_engineTree;              // measured points in normalized n, Me
+    std::vector<double> ma_engine;     // ENGNUM values of every measured point
+
+    std::vector<MatchPoint> ma_points; // n changes first
+
+};
+
+#endif // MATCHING_HPP
@@ -0,0 +1,197 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: numparser.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "numparser.hpp"
+
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+#include <cmath>
+
+namespace {
+
+// powers of ten exactly representable in double
+const double exactPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAXEXACTPOW10 22
+#define MAXEXACTMANT  (uint64_t(1) << 53)
+#define MAXMANTDIGITS 19
+#define MAXNUMLENGTH  64
+
+bool isDigit(char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+bool isSpace(char c) {
+    return (c == ' ') || (c == '\t');
+}
+
+// Correctly rounded conversion by strtod for the cases fast path can not handle.
+bool parseSlow(const char *first, const char *last, double &val) {
+
+    char buf[MAXNUMLENGTH + 1];
+    const size_t len = last - first;
+
+    if ( len > MAXNUMLENGTH ) {
+        return false;
+    }
+
+    for ( size_t i=0; i<len; i++ ) {
+        buf[i] = (first[i] == ',') ? '.' : first[i];
+    }
+
+    buf[len] = '\0';
+
+    char *end = 0;
+    errno = 0;
+    const double v = std::strtod(buf, &end);
+
+    // strtod also accepts "nan", "inf" and "infinity", they are not measured values
+    if ( (end != (buf + len)) || (errno == ERANGE && v != 0) || !std::isfinite(v) ) {
+        return false;
+    }
+
+    val = v;
+
+    return true;
+}
+
+} // namespace
+
+bool parseNumber(const char *first, const char *last, double &val) {
+
+    while ( (first != last) && isSpace(*first) ) {
+        first++;
+    }
+
+    while ( (first != last) && isSpace(*(last-1)) ) {
+        last--;
+    }
+
+    if ( first == last ) {
+        return false;
+    }
+
+    const char *p = first;
+    bool negative = false;
+
+    if ( (*p == '-') || (*p == '+') ) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mant = 0;
+    size_t mantDigits = 0;
+    size_t digits = 0;
+    int exp10 = 0;
+
+    while ( (p != last) && isDigit(*p) ) {
+
+        if ( mantDigits < MAXMANTDIGITS ) {
+            mant = mant * 10 + (*p - '0');
+            mantDigits += (mant != 0);
+        }
+        else {
+            exp10++;
+        }
+
+        digits++;
+        p++;
+    }
+
+    if ( (p != last) && ((*p == '.') || (*p == ',')) ) {
+
+        p++;
+
+        while ( (p != last) && isDigit(*p) ) {
+
+            if ( mantDigits < MAXMANTDIGITS ) {
+                mant = mant * 10 + (*p - '0');
+                mantDigits += (mant != 0);
+                exp10--;
+            }
+
+            digits++;
+            p++;
+        }
+    }
+
+    if ( digits == 0 ) {
+        // inf, nan and other special forms
+        return parseSlow(first, last, val);
+    }
+
+    if ( (p != last) && ((*p == 'e') || (*p == 'E')) ) {
+
+        p++;
+
+        bool expNegative = false;
+
+        if ( (p != last) && ((*p == '-') || (*p == '+')) ) {
+            expNegative = (*p == '-');
+            p++;
+        }
+
+        if ( (p == last) || !isDigit(*p) ) {
+            return false;
+        }
+
+        int e = 0;
+
+        while ( (p != last) && isDigit(*p) ) {
+
+            if ( e < 100000 ) {
+                e = e * 10 + (*p - '0');
+            }
+
+            p++;
+        }
+
+        exp10 += expNegative ? -e : e;
+    }
+
+    if ( p != last ) {
+        return false;
+    }
+
+    // Clinger's fast path: both mantissa and power of ten are exact,
+    // so one multiplication or division gives correctly rounded result
+    if ( (mantDigits < MAXMANTDIGITS) && (mant <= MAXEXACTMANT) &&
+         (exp10 >= -MAXEXACTPOW10) && (exp10 <= MAXEXACTPOW10) ) {
+
+        double v = static_cast<double>(mant);
+
+        if ( exp10 < 0 ) {
+            v /= exactPow10[-exp10];
+        }
+        else {
+            v *= exactPow10[exp10];
+        }
+
+        val = negative ? -v : v;
+
+        return true;
+    }
+
+    return parseSlow(first, last, val);
+}
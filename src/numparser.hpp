@@ -0,0 +1,32 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: numparser.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NUMPARSER_HPP
+#define NUMPARSER_HPP
+
+//
+// Conversion of text to double without exceptions. Both '.' and ','
+// are accepted as decimal separator. Returns false if the whole
+// range [first, last) is not a finite number, val is not changed then.
+//
+
+bool parseNumber(const char *first, const char *last, double &val);
+
+#endif // NUMPARSER_HPP
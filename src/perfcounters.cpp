@@ -0,0 +1,155 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/perfcounters.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "perfcounters.hpp"
+
+#include <limits>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+const char *perfCaptions[PERFNUM] = {
+    "cycles",
+    "instructions",
+    "cache misses",
+    "branch misses"
+};
+
+#ifdef __linux__
+
+namespace {
+
+const uint64_t perfConfigs[PERFNUM] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+int openCounter(uint64_t config) {
+
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+} // namespace
+
+#endif
+
+PerfCounters::PerfCounters() {
+
+    for ( size_t i=0; i<PERFNUM; i++ ) {
+        m_fd[i] = -1;
+        m_count[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+bool PerfCounters::open() {
+
+    bool any = false;
+
+#ifdef __linux__
+    for ( size_t i=0; i<PERFNUM; i++ ) {
+
+        if ( m_fd[i] < 0 ) {
+            m_fd[i] = openCounter(perfConfigs[i]);
+        }
+
+        any = any || (m_fd[i] >= 0);
+    }
+#endif
+
+    return any;
+}
+
+void PerfCounters::close() {
+
+    for ( size_t i=0; i<PERFNUM; i++ ) {
+
+#ifdef __linux__
+        if ( m_fd[i] >= 0 ) {
+            ::close(m_fd[i]);
+        }
+#endif
+
+        m_fd[i] = -1;
+    }
+}
+
+void PerfCounters::start() {
+
+#ifdef __linux__
+    for ( size_t i=0; i<PERFNUM; i++ ) {
+        if ( m_fd[i] >= 0 ) {
+            ioctl(m_fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+
+    for ( size_t i=0; i<PERFNUM; i++ ) {
+
+        m_count[i] = std::numeric_limits<double>::quiet_NaN();
+
+#ifdef __linux__
+        if ( m_fd[i] < 0 ) {
+            continue;
+        }
+
+        ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        // value, time enabled, time running
+        uint64_t data[3] = {0, 0, 0};
+
+        if ( read(m_fd[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) ) {
+            continue;
+        }
+
+        // counter was never scheduled
+        if ( data[2] == 0 ) {
+            continue;
+        }
+
+        m_count[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+#endif
+    }
+}
@@ -0,0 +1,76 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/perfcounters.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERFNUM
+};
+
+extern const char *perfCaptions[PERFNUM];
+
+//
+// Hardware counters of the calling thread (Linux perf_event_open, user
+// space only). Counters which can not be opened (no PMU in a container or
+// virtual machine, perf_event_paranoid, other OS) are unavailable, their
+// values are NaN. Counters multiplexed by the kernel are scaled to the
+// whole measured interval.
+//
+
+class PerfCounters {
+
+public:
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // returns false if no counter is available
+    bool open();
+    void close();
+
+    void start();
+    void stop();
+
+    bool isAvailable(size_t i) const {
+        return m_fd[i] >= 0;
+    }
+    double val_count(size_t i) const {
+        return m_count[i];
+    }
+
+private:
+
+    int m_fd[PERFNUM];
+    double m_count[PERFNUM];
+
+};
+
+#endif // PERFCOUNTERS_HPP
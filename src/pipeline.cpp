@@ -0,0 +1,341 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: pipeline.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pipeline.hpp"
+#include "constants.hpp"
+#include "auxfunctions.hpp"
+#include "compression.hpp"
+#include "srcdatareader.hpp"
+#include "srcdatafilter.hpp"
+#include "tkrsourcedata.hpp"
+#include "tkrparameters.hpp"
+#include "trace.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+
+#include <boost/lexical_cast.hpp>
+
+using std::vector;
+using std::string;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::ostringstream;
+using std::thread;
+using std::cout;
+
+Pipeline::Pipeline(const vector< shared_ptr<Configuration> > &profiles) :
+    m_profiles(profiles) {
+
+    // configuration rejects values out of range, here they are only clamped
+    m_threads    = std::min(std::max(profiles[0]->val_pipeline(), size_t(1)), size_t(PIPEMAXTHREADS));
+    m_blockRows  = std::min(std::max(profiles[0]->val_pipeBlockRows(), size_t(1)), size_t(PIPEMAXBLOCKROWS));
+    m_queueDepth = std::min(std::max(profiles[0]->val_pipeQueueDepth(), size_t(1)), size_t(PIPEMAXQUEUEDEPTH));
+
+    for ( size_t w=0; w<m_threads; w++ ) {
+        m_inQueues.push_back(unique_ptr<BlockQueue>(new BlockQueue(m_queueDepth)));
+        m_outQueues.push_back(unique_ptr<BlockQueue>(new BlockQueue(m_queueDepth)));
+    }
+}
+
+bool Pipeline::run() {
+
+    thread parser(&Pipeline::parse, this);
+    vector<thread> workers;
+
+    for ( size_t w=0; w<m_threads; w++ ) {
+        workers.push_back(thread(&Pipeline::compute, this, w));
+    }
+
+    const bool ok = write();
+
+    parser.join();
+
+    for ( size_t w=0; w<workers.size(); w++ ) {
+        workers[w].join();
+    }
+
+    return ok;
+}
+
+void Pipeline::parse() {
+
+    Trace::setThreadName("parser");
+
+    const bool tracing = Trace::isEnabled();
+
+    SrcDataReader reader;
+    size_t b = 0;
+
+    if ( reader.open(m_profiles[0]->val_srcFile()) ) {
+
+        BlockPtr block(new Block());
+        vector<double> row;
+
+        uint64_t blockBegin = tracing ? Trace::now() : 0;
+
+        const unique_ptr<SrcDataFilter> filter = srcDataFilter(m_profiles[0]);
+
+        while ( filter ? filter->readRow(reader, row) : reader.readRow(row) ) {
+
+            block->src.push_back(row);
+
+            if ( block->src.size() == m_blockRows ) {
+
+                if ( tracing ) {
+                    Trace::record("parse block", blockBegin, Trace::now());
+                }
+
+                {
+                    TRACESCOPE("wait queue");
+                    m_inQueues[b++ % m_threads]->push(std::move(block));
+                }
+
+                block.reset(new Block());
+
+                if ( tracing ) {
+                    blockBegin = Trace::now();
+                }
+            }
+        }
+
+        if ( !block->src.empty() ) {
+
+            if ( tracing ) {
+                Trace::record("parse block", blockBegin, Trace::now());
+            }
+
+            TRACESCOPE("wait queue");
+            m_inQueues[b++ % m_threads]->push(std::move(block));
+        }
+
+        if ( filter ) {
+            filter->printSummary();
+        }
+
+        reader.printErrors();
+
+        if ( b == 0 ) {
+            cout << ERRORMSGBLANK << "No source data (\n";
+        }
+    }
+
+    // writer stops at the first end marker, the rest let compute threads exit
+    for ( size_t w=0; w<m_threads; w++ ) {
+
+        BlockPtr last(new Block());
+        last->last = true;
+
+        m_inQueues[(b + w) % m_threads]->push(std::move(last));
+    }
+}
+
+void Pipeline::compute(size_t w) {
+
+    Trace::setThreadName("compute " + boost::lexical_cast<string>(w + 1));
+
+    vector< shared_ptr<TkrParameters> > tkrs;
+
+    for ( size_t p=0; p<m_profiles.size(); p++ ) {
+        tkrs.push_back(shared_ptr<TkrParameters>(new TkrParameters(m_profiles[p])));
+    }
+
+    BlockPtr block;
+
+    while ( true ) {
+
+        {
+            TRACESCOPE("wait block");
+            m_inQueues[w]->pop(block);
+        }
+
+        if ( block->last ) {
+            m_outQueues[w]->push(std::move(block));
+            return;
+        }
+
+        // results are passed to the writer with the block
+        if ( m_handler ) {
+            for ( size_t p=0; p<m_profiles.size(); p++ ) {
+                tkrs[p].reset(new TkrParameters(m_profiles[p]));
+            }
+        }
+
+        shared_ptr<TkrSourceData> src(new TkrSourceData());
+        src->calculate(block->src);
+        TkrParameters::calculate(tkrs, src);
+
+        block->validation = src->val_validation();
+
+        if ( m_computeHandler ) {
+            for ( size_t p=0; p<m_profiles.size(); p++ ) {
+                m_computeHandler(w, p, *tkrs[p]);
+            }
+        }
+
+        // source rows are not needed after calculation
+        vector< vector<double> >().swap(block->src);
+
+        TRACESCOPE("format block");
+
+        ostringstream srcText;
+        tkrs[0]->writeSourceTable(srcText);
+        block->srcText = srcText.str();
+
+        block->resText.resize(tkrs.size());
+
+        for ( size_t p=0; p<tkrs.size(); p++ ) {
+
+            ostringstream resText;
+            tkrs[p]->writeResultsTable(resText);
+            block->resText[p] = resText.str();
+        }
+
+        if ( m_handler ) {
+            block->tkrs = tkrs;
+        }
+
+        TRACESCOPE("wait queue");
+        m_outQueues[w]->push(std::move(block));
+    }
+}
+
+bool Pipeline::write() {
+
+    const size_t profNum = m_profiles.size();
+
+    vector< shared_ptr<TkrParameters> > tkrs;
+    vector<string> fileNames;
+    vector< unique_ptr<ReportStream> > fouts;
+    vector<std::FILE *> resFiles; // results are placed after source data table
+
+    for ( size_t p=0; p<profNum; p++ ) {
+        tkrs.push_back(shared_ptr<TkrParameters>(new TkrParameters(m_profiles[p])));
+        fileNames.push_back(m_profiles[p]->val_reportStdout() ? string(STDOUTNAME) : reportFileName(REPORTNAME, *m_profiles[p]));
+    }
+
+    bool ok = true;
+    size_t b = 0;
+    BlockPtr block;
+    SrcValidation validation;
+
+    while ( true ) {
+
+        {
+            TRACESCOPE("wait block");
+            m_outQueues[b % m_threads]->pop(block);
+        }
+
+        if ( block->last ) {
+            break;
+        }
+
+        TRACESCOPE("write block");
+
+        // reports are created when the first block is calculated
+        if ( (b == 0) && m_reports ) {
+
+            for ( size_t p=0; p<profNum; p++ ) {
+
+                fouts.push_back(unique_ptr<ReportStream>(new ReportStream(fileNames[p], m_profiles[p]->val_reportCompression())));
+                resFiles.push_back(std::tmpfile());
+
+                if ( !(*fouts[p]) || !resFiles[p] ) {
+                    cout << ERRORMSGBLANK << "Can not open file \"" << fileNames[p] << "\" to write!\n";
+                    ok = false;
+
+                    if ( resFiles[p] ) {
+                        std::fclose(resFiles[p]);
+                        resFiles[p] = 0;
+                    }
+                }
+                else {
+                    tkrs[p]->writeHeader(*fouts[p]);
+                }
+            }
+        }
+
+        for ( size_t p=0; p<profNum; p++ ) {
+
+            if ( m_reports && resFiles[p] ) {
+                *fouts[p] << block->srcText;
+                std::fwrite(block->resText[p].data(), 1, block->resText[p].size(), resFiles[p]);
+            }
+
+            if ( m_handler ) {
+                m_handler(p, *block->tkrs[p]);
+            }
+        }
+
+        validation.merge(block->validation);
+
+        b++;
+    }
+
+    // end markers of other compute threads
+    for ( size_t w=1; w<m_threads; w++ ) {
+        m_outQueues[(b + w) % m_threads]->pop(block);
+    }
+
+    if ( b == 0 ) {
+        return false;
+    }
+
+    TRACESCOPE("finish reports");
+
+    validation.print();
+
+    cout << MSGBLANK << "Calculation completed.\n";
+
+    vector<char> buf(1 << 16);
+
+    for ( size_t p=0; p<resFiles.size(); p++ ) {
+
+        if ( !resFiles[p] ) {
+            continue;
+        }
+
+        tkrs[p]->writeResultsCaption(*fouts[p]);
+
+        std::rewind(resFiles[p]);
+
+        size_t n = 0;
+
+        while ( (n = std::fread(buf.data(), 1, buf.size(), resFiles[p])) > 0 ) {
+            fouts[p]->write(buf.data(), n);
+        }
+
+        const bool resOk = !std::ferror(resFiles[p]);
+        std::fclose(resFiles[p]);
+
+        if ( !fouts[p]->close() || !resOk ) {
+            cout << ERRORMSGBLANK << "Can not write file \"" << fileNames[p] << "\"!\n";
+            ok = false;
+            continue;
+        }
+
+        cout << MSGBLANK << "Report file \"" << fileNames[p] << "\"created.\n";
+    }
+
+    return ok;
+}
@@ -0,0 +1,105 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: pipeline.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+
+#include "configuration.hpp"
+#include "spscqueue.hpp"
+#include "tkrparameters.hpp"
+
+//
+// Pipelined calculation: parser thread reads source data into blocks of rows,
+// compute threads calculate blocks for all configuration profiles and format
+// them, writer (calling thread) puts blocks into reports in source order.
+// Stages are connected by bounded queues, so memory usage is limited by
+// block size and queue depth instead of source data size.
+//
+
+class Pipeline {
+
+public:
+
+    Pipeline(const std::vector< std::shared_ptr<Configuration> > &profiles);
+
+    // called by writer for every calculated block of every profile in source order
+    typedef std::function<void (size_t profile, const TkrParameters &)> ResultHandler;
+
+    void setResultHandler(const ResultHandler &handler) {
+        m_handler = handler;
+    }
+
+    // called by compute thread for every calculated block of every profile, out of order
+    typedef std::function<void (size_t thread, size_t profile, const TkrParameters &)> ComputeHandler;
+
+    void setComputeHandler(const ComputeHandler &handler) {
+        m_computeHandler = handler;
+    }
+
+    // report files are not written, results are taken by the handlers only
+    void setReports(bool reports) {
+        m_reports = reports;
+    }
+
+    size_t val_threads() const {
+        return m_threads;
+    }
+
+    bool run();
+
+private:
+
+    struct Block {
+        bool last = false;
+        std::vector< std::vector<double> > src;
+        std::string srcText;
+        std::vector<std::string> resText; // per profile
+        std::vector< std::shared_ptr<TkrParameters> > tkrs; // per profile, if result handler is set
+        SrcValidation validation;
+    };
+
+    typedef std::unique_ptr<Block> BlockPtr;
+    typedef SpscQueue<BlockPtr> BlockQueue;
+
+    void parse();
+    void compute(size_t);
+    bool write();
+
+    std::vector< std::shared_ptr<Configuration> > m_profiles;
+
+    size_t m_threads    = 1;
+    size_t m_blockRows  = 4096;
+    size_t m_queueDepth = 4;
+    bool m_reports      = true;
+
+    std::vector< std::unique_ptr<BlockQueue> > m_inQueues;  // parser -> compute thread
+    std::vector< std::unique_ptr<BlockQueue> > m_outQueues; // compute thread -> writer
+
+    ResultHandler m_handler;
+    ComputeHandler m_computeHandler;
+
+};
+
+#endif // PIPELINE_HPP
@@ -0,0 +1,196 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: realtime.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "realtime.hpp"
+#include "tkrkernel.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+using std::cout;
+using std::shared_ptr;
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+} // namespace
+
+RealTime::RealTime(const shared_ptr<Configuration> &cfg) {
+    m_conf = cfg;
+}
+
+bool RealTime::run() {
+
+    if ( !start() ) {
+        return false;
+    }
+
+    process();
+    finish();
+
+    return true;
+}
+
+bool RealTime::start() {
+
+    if ( !m_input.open(m_conf->val_rtInput(), RTSRCRECORD, m_conf->val_rtCapacity()) ||
+         !m_output.open(m_conf->val_rtOutput(), RTRESRECORD, m_conf->val_rtCapacity()) ||
+         !prepare() ) {
+        return false;
+    }
+
+    m_params = m_conf->val_calcParams();
+
+    stopRequested = 0;
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    cout << MSGBLANK << "Real-time calculation from \"" << m_conf->val_rtInput() << "\" to \""
+         << m_conf->val_rtOutput() << "\" started. Press Ctrl+C to stop.\n";
+    cout.flush();
+
+    return true;
+}
+
+void RealTime::process() {
+
+    const size_t limit = m_conf->val_rtPoints();
+    const bool tagTime = (m_conf->val_rtTagTime() != 0);
+
+    double src[RTSRCRECORD];
+    double res[RTRESRECORD];
+    TkrRow<double> r;
+    size_t idle = 0;
+
+    while ( !stopRequested && ((limit == 0) || (m_points < limit)) ) {
+
+        if ( !m_input.pop(src) ) {
+            if ( ++idle >= RTIDLESPINS ) {
+                std::this_thread::yield();
+                idle = 0;
+            }
+            continue;
+        }
+
+        idle = 0;
+
+        // steady_clock is CLOCK_MONOTONIC, the clock of the DAQ timestamps
+        const auto received = std::chrono::steady_clock::now();
+
+        const uint32_t invalid = calculatePoint(m_params, r, src, res);
+        const bool pushed = m_output.push(res);
+
+        const auto now = std::chrono::steady_clock::now();
+        const double ns = tagTime
+            ? std::chrono::duration<double, std::nano>(now.time_since_epoch()).count() - src[0] * 1e3
+            : std::chrono::duration<double, std::nano>(now - received).count();
+
+        m_latency.record((ns > 0) ? static_cast<uint64_t>(ns) : 0);
+
+        m_points++;
+        m_invalid += (invalid != 0);
+        m_dropped += !pushed;
+    }
+}
+
+void RealTime::finish() {
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    cout << MSGBLANK << "Real-time calculation stopped: " << m_points << " points calculated.\n";
+
+    printLatency();
+
+    if ( m_invalid > 0 ) {
+        cout << WARNMSGBLANK << m_invalid << " points with invalid source data.\n";
+    }
+
+    if ( m_dropped > 0 ) {
+        cout << WARNMSGBLANK << "Results of " << m_dropped << " points dropped, output ring buffer was full.\n";
+    }
+}
+
+uint32_t RealTime::calculatePoint(const TkrCalcParams &params, TkrRow<double> &r, const double *src, double *res) noexcept {
+
+    const uint32_t invalid = tkrCalculateChecked(r, src + 1, params);
+
+    res[0] = src[0];
+    res[1] = invalid;
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        res[k + 2] = tkrResult(r, k);
+    }
+
+    return invalid;
+}
+
+bool RealTime::prepare() {
+
+#ifndef _WIN32
+    // pages mapped later (stack growth, ring buffers) are locked too
+    if ( m_conf->val_rtLockMemory() && (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) ) {
+        cout << WARNMSGBLANK << "Memory can not be locked: " << std::strerror(errno) << ". Latency may grow on page faults.\n";
+    }
+#endif
+
+    m_input.touch();
+    m_output.touch();
+
+    m_latency.clear();
+
+    // the first calls of the kernel initialize its static tables
+    const TkrCalcParams params = m_conf->val_calcParams();
+    double src[RTSRCRECORD] = {0};
+    double res[RTRESRECORD];
+    TkrRow<double> r;
+
+    calculatePoint(params, r, src, res);
+
+    return true;
+}
+
+void RealTime::printLatency() const {
+
+    if ( m_latency.val_count() == 0 ) {
+        return;
+    }
+
+    cout << MSGBLANK << "Latency of points, us: p50 " << (m_latency.percentile(50) / 1e3)
+         << ", p99 " << (m_latency.percentile(99) / 1e3)
+         << ", p99.9 " << (m_latency.percentile(99.9) / 1e3)
+         << ", max " << (m_latency.val_max() / 1e3) << ".\n";
+}
@@ -0,0 +1,96 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: realtime.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+#include <memory>
+#include <cstddef>
+
+#include "configuration.hpp"
+#include "shmring.hpp"
+#include "latencyhistogram.hpp"
+#include "tkrkernel.hpp"
+
+//
+// Real-time calculation of operating points written continuously by the
+// test bench DAQ. Source records are consumed from shared memory ring
+// buffer rtInput, every point is calculated by the row kernel and its
+// results are published into ring buffer rtOutput for display software.
+//
+// Record of rtInput, RTSRCRECORD doubles:
+//     [0]              tag of point chosen by the producer (time, number),
+//                      with rtTagTime publishing time, microseconds of
+//                      CLOCK_MONOTONIC
+//     [1 .. SRCCOLNUM] source values in order of colCaptions
+//
+// Record of rtOutput, RTRESRECORD doubles:
+//     [0]              tag of source point
+//     [1]              bits (1 << c) of invalid source columns c, 0 - valid point
+//     [2 .. RESNUM+1]  results in order of resCaptions, NaN - not calculated
+//
+// If the output ring is full, results of the point are dropped, so slow
+// display software never stops consumption of the DAQ points.
+//
+// Everything the loop needs is prepared before the first point: ring
+// buffers are mapped and touched, memory is locked if rtLockMemory is set.
+// The loop polls the empty input ring without sleeping and yields the CPU
+// after RTIDLESPINS polls. Calculation of a point does not allocate, does
+// not throw and does no I/O. Latencies from publishing (rtTagTime) or
+// receiving of a point to publishing of its results are collected into a
+// histogram printed when the calculation stops.
+//
+
+class RealTime {
+
+public:
+
+    RealTime(const std::shared_ptr<Configuration> &conf);
+
+    // run() is start(), process() and finish()
+    bool run();
+
+    bool start();
+    void process();
+    void finish();
+
+    // calculation of one input record into output record, returns bits of invalid columns
+    static uint32_t calculatePoint(const TkrCalcParams &, TkrRow<double> &, const double *, double *) noexcept;
+
+private:
+
+    bool prepare();
+    void printLatency() const;
+
+    std::shared_ptr<Configuration> m_conf;
+    TkrCalcParams m_params = TkrCalcParams();
+
+    ShmRing m_input;
+    ShmRing m_output;
+
+    size_t m_points = 0;
+    size_t m_invalid = 0;
+    size_t m_dropped = 0;
+
+    LatencyHistogram m_latency;
+
+};
+
+#endif // REALTIME_HPP
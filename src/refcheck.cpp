@@ -0,0 +1,786 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: refcheck.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//
+// Accuracy check of calculation paths against the frozen scalar reference
+// (tkrreference.cpp). Every path is run over a generated corpus of typical
+// operating points and edge cases (near-singular flow function Y, zero
+// flow, phi <= 0.04 and E > 1 clamps, singular and non-converging Ft
+// solver, not measured low pressure stage) for several configurations.
+// Paths are the sequential and shared source calculations, the pipeline
+// with small blocks, the C interface, the real-time point calculation, the
+// row kernel and dual numbers. For every result column maximal absolute
+// and relative errors and distance in ULP are reported.
+// A value fails if it is out of the ULP limit or out of the relative limit
+// of its path, failed columns are listed in the result of the path. Paths
+// with validation of source data must leave results of invalid rows and
+// not measured stations empty (NaN), these values are counted separately. Exit code is 0 if all values of all paths pass.
+//
+
+#include "tkrreference.hpp"
+#include "tkrkernel.hpp"
+#include "tkrsourcedata.hpp"
+#include "tkrparameters.hpp"
+#include "configuration.hpp"
+#include "constants.hpp"
+#include "dual.hpp"
+#include "pipeline.hpp"
+#include "realtime.hpp"
+#include "tkrapi.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::cout;
+using std::cerr;
+
+namespace {
+
+typedef vector< vector<double> > Rows;
+
+enum {
+    CORPUS_GENERATED,
+    CORPUS_SINGULAR_Y,
+    CORPUS_ZERO_FLOW,
+    CORPUS_PHI_CLAMP,
+    CORPUS_E_CLAMP,
+    CORPUS_FT_SOLVER,
+    CORPUS_SINGLE_STAGE,
+    CORPUSNUM
+};
+
+const char *corpusNames[CORPUSNUM] = {
+    "generated",
+    "near-singular Y",
+    "zero flow",
+    "phi <= 0.04 clamp",
+    "E > 1 clamp",
+    "Ft solver",
+    "single stage"
+};
+
+struct ErrStats {
+    double maxAbs = 0;
+    double maxRel = 0;
+    uint64_t maxUlp = 0;
+    size_t mismatches = 0; // non-finite values that differ
+    size_t failures = 0;   // values out of the ULP or the relative limit
+    size_t masked = 0;     // values masked by validation
+};
+
+struct Mode {
+    const char *name;
+    uint64_t maxUlp; // default limits
+    double maxRel;
+    bool validated;  // results of invalid source data are masked
+    void (*calculate)(const shared_ptr<Configuration> &, const Rows &, vector<double> &);
+};
+
+// doubles ordered as integers, difference of them is the distance in ULP
+uint64_t orderedBits(double x) {
+
+    uint64_t u = 0;
+    std::memcpy(&u, &x, sizeof(double));
+
+    const uint64_t sign = uint64_t(1) << 63;
+
+    return (u & sign) ? (sign - (u & ~sign)) : (sign + u);
+}
+
+uint64_t ulpDistance(double a, double b) {
+
+    const uint64_t ua = orderedBits(a);
+    const uint64_t ub = orderedBits(b);
+
+    return (ua > ub) ? (ua - ub) : (ub - ua);
+}
+
+void compare(double val, double ref, uint64_t limitUlp, double limitRel, ErrStats &st) {
+
+    if ( !std::isfinite(val) || !std::isfinite(ref) ) {
+        if ( !(std::isnan(val) && std::isnan(ref)) && (val != ref) ) {
+            st.mismatches++;
+        }
+        return;
+    }
+
+    const double absErr = std::fabs(val - ref);
+    const double relErr = (ref != 0) ? absErr / std::fabs(ref) : ((absErr != 0) ? std::numeric_limits<double>::infinity() : 0);
+
+    st.maxAbs = std::max(st.maxAbs, absErr);
+    st.maxRel = std::max(st.maxRel, relErr);
+    const uint64_t ulp = ulpDistance(val, ref);
+
+    st.maxUlp = std::max(st.maxUlp, ulp);
+
+    if ( (ulp > limitUlp) || (relErr > limitRel) ) {
+        st.failures++;
+    }
+}
+
+//
+// Calculation paths
+//
+
+void calcSequential(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    TkrParameters tkr(conf);
+    tkr.calculate(rows);
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+
+        const vector<double> &col = tkr.resultColumn(k);
+
+        for ( size_t i=0; i<rows.size(); i++ ) {
+            res[i * RESNUM + k] = col[i];
+        }
+    }
+}
+
+void calcShared(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    shared_ptr<TkrSourceData> src(new TkrSourceData());
+    src->calculate(rows);
+
+    // two profiles share the source data as in a multi-profile run
+    vector< shared_ptr<TkrParameters> > tkrs;
+    tkrs.push_back(shared_ptr<TkrParameters>(new TkrParameters(conf)));
+    tkrs.push_back(shared_ptr<TkrParameters>(new TkrParameters(conf)));
+
+    TkrParameters::calculate(tkrs, src);
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+
+        const vector<double> &col = tkrs[1]->resultColumn(k);
+
+        for ( size_t i=0; i<rows.size(); i++ ) {
+            res[i * RESNUM + k] = col[i];
+        }
+    }
+}
+
+// source data file of the pipeline path, removed after the run
+const char *PIPESRCNAME = "TKR_refcheck_source.csv";
+
+// Corpus is written with round-trip precision and read back by the
+// pipeline in small blocks, so block splitting and per-block validation
+// are checked on many block boundaries.
+void calcPipeline(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    std::fill(res.begin(), res.end(), std::numeric_limits<double>::quiet_NaN());
+
+    std::FILE *f = std::fopen(PIPESRCNAME, "w");
+
+    if ( !f ) {
+        cerr << "Can not write file \"" << PIPESRCNAME << "\"!\n";
+        return;
+    }
+
+    for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+        std::fprintf(f, "%s%s", colCaptions[j].c_str(), (j + 1 < SRCCOLNUM) ? CSVDELIMETER : "\n");
+    }
+
+    for ( size_t i=0; i<rows.size(); i++ ) {
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            std::fprintf(f, "%.17g%s", rows[i][j], (j + 1 < SRCCOLNUM) ? CSVDELIMETER : "\n");
+        }
+    }
+
+    const bool written = (std::fclose(f) == 0);
+
+    shared_ptr<Configuration> pconf(new Configuration(*conf));
+    pconf->overrideParameter("srcFile", PIPESRCNAME);
+    pconf->overrideParameter("pipeline", "3");
+    pconf->overrideParameter("pipeBlockRows", "37");
+
+    Pipeline pipeline(vector< shared_ptr<Configuration> >(1, pconf));
+    pipeline.setReports(false);
+
+    size_t first = 0;
+
+    pipeline.setResultHandler([&](size_t, const TkrParameters &tkr) {
+
+        const size_t num = tkr.resultColumn(0).size();
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+
+            const vector<double> &col = tkr.resultColumn(k);
+
+            for ( size_t i=0; (i < num) && (first + i < rows.size()); i++ ) {
+                res[(first + i) * RESNUM + k] = col[i];
+            }
+        }
+
+        first += num;
+    });
+
+    // messages of the calculation are not a part of the check: without
+    // stream buffer cout discards output until the buffer is restored
+    std::streambuf *coutBuf = cout.rdbuf(nullptr);
+
+    if ( written ) {
+        pipeline.run();
+    }
+
+    cout.rdbuf(coutBuf);
+
+    std::remove(PIPESRCNAME);
+}
+
+// C interface on column buffers, configuration is set as by a caller
+void calcCApi(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    std::fill(res.begin(), res.end(), std::numeric_limits<double>::quiet_NaN());
+
+    tkr_config c;
+
+    if ( tkr_config_init(&c) != TKRAPI_OK ) {
+        return;
+    }
+
+    c.acType_lp    = static_cast<unsigned>(conf->val_acType_lp());
+    c.acType_hp    = static_cast<unsigned>(conf->val_acType_hp());
+    c.B0_std       = conf->val_B0_std();
+    c.T0_std       = conf->val_T0_std();
+    c.Vh           = conf->val_Vh();
+    c.sysNum       = conf->val_sysNum();
+    c.pipeNumHpOut = conf->val_pipeNumHpOut();
+    c.pipeNumHpIn  = conf->val_pipeNumHpIn();
+
+    for ( size_t st=0; st<STATIONNUM; st++ ) {
+        c.F[st] = conf->val_F(st);
+    }
+
+    vector< vector<double> > srcCols(SRCCOLNUM, vector<double>(rows.size()));
+    vector< vector<double> > resCols(RESNUM, vector<double>(rows.size()));
+
+    const double *src[SRCCOLNUM];
+    double *dst[RESNUM];
+
+    for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+
+        for ( size_t i=0; i<rows.size(); i++ ) {
+            srcCols[j][i] = rows[i][j];
+        }
+
+        src[j] = srcCols[j].data();
+    }
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        dst[k] = resCols[k].data();
+    }
+
+    if ( tkr_calculate(&c, src, rows.size(), dst, nullptr) != TKRAPI_OK ) {
+        return;
+    }
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        for ( size_t i=0; i<rows.size(); i++ ) {
+            res[i * RESNUM + k] = resCols[k][i];
+        }
+    }
+}
+
+// real-time path on records as written by the DAQ, tag is the row number
+void calcRealTime(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    const TkrCalcParams params = conf->val_calcParams();
+
+    TkrRow<double> r;
+    double src[RTSRCRECORD];
+    double out[RTRESRECORD];
+
+    for ( size_t i=0; i<rows.size(); i++ ) {
+
+        src[0] = i;
+        std::copy(rows[i].begin(), rows[i].begin() + SRCCOLNUM, src + 1);
+
+        RealTime::calculatePoint(params, r, src, out);
+
+        // results of another point are a mismatch of all values
+        const bool tagged = (out[0] == src[0]);
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            res[i * RESNUM + k] = tagged ? out[k + 2] : std::numeric_limits<double>::infinity();
+        }
+    }
+}
+
+void calcKernel(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    const TkrCalcParams params = conf->val_calcParams();
+
+    for ( size_t i=0; i<rows.size(); i++ ) {
+
+        TkrRow<double> r;
+
+        tkrSetSource(r, rows[i].data());
+        tkrPreCalculate(r);
+        tkrCalculate(r, params);
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            res[i * RESNUM + k] = tkrResult(r, k);
+        }
+    }
+}
+
+void calcDual(const shared_ptr<Configuration> &conf, const Rows &rows, vector<double> &res) {
+
+    typedef Dual<1> D;
+
+    const TkrCalcParams params = conf->val_calcParams();
+
+    for ( size_t i=0; i<rows.size(); i++ ) {
+
+        D src[SRCCOLNUM];
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            src[j] = (j == GAIRCOL) ? D(rows[i][j], 0) : D(rows[i][j]);
+        }
+
+        TkrRow<D> r;
+
+        tkrSetSource(r, src);
+        tkrPreCalculate(r);
+        tkrCalculate(r, params);
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            res[i * RESNUM + k] = tkrResult(r, k).val();
+        }
+    }
+}
+
+const Mode modes[] = {
+    {"sequential",    0,   0,    true,  calcSequential},
+    {"shared source", 0,   0,    true,  calcShared},
+    {"pipeline",      0,   0,    true,  calcPipeline},
+    {"C interface",   0,   0,    true,  calcCApi},
+    {"real-time",     0,   0,    true,  calcRealTime},
+    {"row kernel",    0,   0,    false, calcKernel},
+    {"dual numbers",  0,   0,    false, calcDual}
+};
+
+const size_t MODENUM = sizeof(modes) / sizeof(modes[0]);
+
+//
+// Corpus
+//
+
+class CorpusGenerator {
+
+public:
+
+    CorpusGenerator(uint64_t seed) :
+        m_gen(seed) {
+    }
+
+    vector<double> typical() {
+
+        const double k = uniform(0.4, 1.0);
+        const double nn = 1000 + 100 * static_cast<int>(uniform(0, 10.999));
+        const double Me = 1600 * k;
+
+        vector<double> row = {
+            nn, Me, nn * Me / 9549, 60 * k, 1500 * k, uniform(0.98, 1.01), -2 * k,
+            1.1 * k, 1.05 * k, 2.6 * k, 2.5 * k, 2.2 * k, 0.9 * k, 3 * k,
+            uniform(18, 28), 40 + 90 * k, 30 + 25 * k, 60 + 110 * k, 30 + 25 * k,
+            400 + 250 * k, 300 + 230 * k, 250 + 200 * k, 80
+        };
+
+        // independent scatter of every column
+        for ( size_t j=0; j<row.size(); j++ ) {
+            row[j] *= uniform(0.97, 1.03);
+        }
+
+        return row;
+    }
+
+    double uniform(double a, double b) {
+        return std::uniform_real_distribution<double>(a, b)(m_gen);
+    }
+
+private:
+
+    std::mt19937_64 m_gen;
+
+};
+
+// pressure column value giving absolute pressure P_r, kPa
+double pressureFor(const vector<double> &row, size_t st, double P_r) {
+    return (P_r - row[5] * 100.0) / stationPUnit[st];
+}
+
+void makeCorpus(size_t num, uint64_t seed, const TkrCalcParams &params, Rows &rows, vector<size_t> &kinds) {
+
+    CorpusGenerator gen(seed);
+
+    double ref[RESNUM];
+
+    const size_t edgeNum = num / 10;
+
+    for ( size_t i=0; i<num; i++ ) {
+        rows.push_back(gen.typical());
+        kinds.push_back(CORPUS_GENERATED);
+    }
+
+    for ( size_t i=0; i<edgeNum; i++ ) {
+
+        // absolute pressure of a station close to zero, Lambda tends to its
+        // maximum and Pi to zero
+        vector<double> row = gen.typical();
+        const size_t st = static_cast<size_t>(gen.uniform(0, STATIONNUM - 0.001));
+        row[STPCOL + st] = pressureFor(row, st, std::pow(10.0, gen.uniform(-6, 0.5)));
+        row[GAIRCOL] *= gen.uniform(1, 20);
+
+        rows.push_back(row);
+        kinds.push_back(CORPUS_SINGULAR_Y);
+    }
+
+    for ( size_t i=0; i<edgeNum/10; i++ ) {
+
+        vector<double> row = gen.typical();
+        row[GAIRCOL] = 0;
+        row[3] = (i % 2) ? 0 : row[3];
+        row[NCOL] = (i % 3) ? row[NCOL] : 0;
+
+        rows.push_back(row);
+        kinds.push_back(CORPUS_ZERO_FLOW);
+    }
+
+    for ( size_t i=0; i<edgeNum; i++ ) {
+
+        // Tr (lp) or Tt_lp (hp) giving phi = 0.04 exactly, then shifted by a few ULP
+        vector<double> row = gen.typical();
+        const bool hp = (i % 2) != 0;
+        const size_t col = hp ? 20 : 21;
+        const size_t pitRes = hp ? RES_PIT_HP : RES_PIT_LP;
+        const double Tt_r = row[hp ? 19 : 20] + 273.0;
+
+        for ( size_t it=0; it<4; it++ ) {
+            tkrReference(row.data(), params, ref);
+            const double Trc = Tt_r / std::pow(ref[pitRes], 0.2593);
+            row[col] = Trc + 0.04 * (Tt_r - Trc) - 273.0;
+        }
+
+        const int shift = static_cast<int>(gen.uniform(-8, 8.999));
+
+        for ( int s=0; s<std::abs(shift); s++ ) {
+            row[col] = std::nextafter(row[col], (shift > 0) ? 1e300 : -1e300);
+        }
+
+        rows.push_back(row);
+        kinds.push_back(CORPUS_PHI_CLAMP);
+    }
+
+    for ( size_t i=0; i<edgeNum; i++ ) {
+
+        // Tks below 25 degC gives E > 1 for air-air aftercooler, Tks above Tk
+        // gives negative E, Tk equal to 25 degC or Tcool gives zero denominator
+        vector<double> row = gen.typical();
+        const bool hp = (i % 2) != 0;
+        const size_t tk = hp ? 17 : 15;
+        const size_t tks = hp ? 18 : 16;
+
+        switch ( (i / 2) % 5 ) {
+        case 0:
+            row[tks] = gen.uniform(-10, 25);
+            break;
+        case 1:
+            row[tks] = 25.0;
+            break;
+        case 2:
+            row[tks] = row[tk] + gen.uniform(0, 20);
+            break;
+        case 3:
+            row[tk] = (gen.uniform(0, 1) < 0.5) ? 25.0 : row[22];
+            break;
+        default:
+            row[14] = gen.uniform(30, 40);
+            row[tks] = gen.uniform(row[14] - 20, row[14] + 5);
+            break;
+        }
+
+        rows.push_back(row);
+        kinds.push_back(CORPUS_E_CLAMP);
+    }
+
+    for ( size_t i=0; i<edgeNum; i++ ) {
+
+        // Pit_lp near exp(-0.707889 / 0.421189) makes the Ft equation singular,
+        // non-positive Pit makes it NaN, the solver does not converge then
+        vector<double> row = gen.typical();
+        const double Pt_lp_r = row[12] * 100.0 + row[5] * 100.0;
+
+        switch ( i % 3 ) {
+        case 0:
+            row[13] = pressureFor(row, ST_PR, Pt_lp_r / (std::exp(-0.707889 / 0.421189) * gen.uniform(0.9, 1.1)));
+            break;
+        case 1:
+            row[13] = pressureFor(row, ST_PR, -gen.uniform(0, 50));
+            break;
+        default:
+            row[13] = pressureFor(row, ST_PR, Pt_lp_r / gen.uniform(0.1, 6));
+            row[GAIRCOL] *= gen.uniform(0.05, 5);
+            break;
+        }
+
+        rows.push_back(row);
+        kinds.push_back(CORPUS_FT_SOLVER);
+    }
+
+    for ( size_t i=0; i<edgeNum; i++ ) {
+
+        // single stage engine, low pressure stage is not measured
+        vector<double> row = gen.typical();
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            if ( STBIT(s) & STLPSTAGE ) {
+                row[STPCOL + s] = 0;
+                row[STTCOL + s] = 0;
+            }
+        }
+
+        rows.push_back(row);
+        kinds.push_back(CORPUS_SINGLE_STAGE);
+    }
+}
+
+void printUsage() {
+    cerr << "Usage: tkr_refcheck [-n rows] [--seed S] [--max-ulp U] [--max-rel R]\n\n"
+         << "  -n rows       number of generated rows, edge cases are added (default 100000)\n"
+         << "  --seed S      seed of corpus generator (default 1)\n"
+         << "  --max-ulp U   ULP limit of all paths instead of their defaults\n"
+         << "  --max-rel R   relative limit of all paths instead of their defaults\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+    size_t num = 100000;
+    uint64_t seed = 1;
+    long long maxUlp = -1;
+    double maxRel = -1;
+
+    for ( int i=1; i<argc; i++ ) {
+
+        const string arg(argv[i]);
+
+        if ( (i + 1) == argc ) {
+            printUsage();
+            return EXITUSAGE;
+        }
+
+        const char *value = argv[++i];
+
+        if ( arg == "-n" ) {
+            num = std::strtoull(value, nullptr, 10);
+        }
+        else if ( arg == "--seed" ) {
+            seed = std::strtoull(value, nullptr, 10);
+        }
+        else if ( arg == "--max-ulp" ) {
+            maxUlp = std::strtoll(value, nullptr, 10);
+        }
+        else if ( arg == "--max-rel" ) {
+            maxRel = std::strtod(value, nullptr);
+        }
+        else {
+            printUsage();
+            return EXITUSAGE;
+        }
+    }
+
+    // configurations with different branches of formulas
+    vector< shared_ptr<Configuration> > confs;
+    vector<string> confNames;
+
+    confs.push_back(shared_ptr<Configuration>(new Configuration()));
+    confNames.push_back("default");
+
+    confs.push_back(shared_ptr<Configuration>(new Configuration()));
+    confs.back()->overrideParameter("acTypelp", "1");
+    confs.back()->overrideParameter("acTypehp", "1");
+    confNames.push_back("coolant-air aftercoolers");
+
+    confs.push_back(shared_ptr<Configuration>(new Configuration()));
+    confs.back()->overrideParameter("sysNum", "2");
+    confs.back()->overrideParameter("pipeNumHpOut", "2");
+    confs.back()->overrideParameter("pipeNumHpIn", "2");
+    confNames.push_back("two charging systems");
+
+    Rows rows;
+    vector<size_t> kinds;
+
+    makeCorpus(num, seed, confs[0]->val_calcParams(), rows, kinds);
+
+    size_t kindNum[CORPUSNUM] = {0};
+
+    for ( size_t i=0; i<kinds.size(); i++ ) {
+        kindNum[kinds[i]]++;
+    }
+
+    cout << "Corpus" << CSVDELIMETER << rows.size() << " rows, seed " << seed << "\n";
+
+    for ( size_t c=0; c<CORPUSNUM; c++ ) {
+        cout << corpusNames[c] << CSVDELIMETER << kindNum[c] << "\n";
+    }
+
+    // coverage of clamps and solver failures by reference results
+    size_t phiClamped = 0;
+    size_t eClamped = 0;
+    size_t ftFailed = 0;
+    size_t nonFinite = 0;
+
+    vector< vector<double> > refs(confs.size(), vector<double>(rows.size() * RESNUM));
+
+    for ( size_t c=0; c<confs.size(); c++ ) {
+
+        const TkrCalcParams params = confs[c]->val_calcParams();
+
+        for ( size_t i=0; i<rows.size(); i++ ) {
+
+            double *ref = &refs[c][i * RESNUM];
+
+            if ( kinds[i] == CORPUS_SINGLE_STAGE ) {
+                tkrReferenceSingleStage(rows[i].data(), params, ref);
+            }
+            else {
+                tkrReference(rows[i].data(), params, ref);
+            }
+
+            phiClamped += (ref[RES_PHI_LP] == 0) + (ref[RES_PHI_HP] == 0);
+            eClamped += (ref[RES_E1] == 1.0) + (ref[RES_E2] == 1.0);
+            ftFailed += ((ref[RES_FT_LP] == 0) && (ref[RES_MUFT_LP] != 0)) +
+                        ((ref[RES_FT_HP] == 0) && (ref[RES_MUFT_HP] != 0));
+
+            for ( size_t k=0; k<RESNUM; k++ ) {
+                if ( !std::isfinite(ref[k]) && ((kinds[i] != CORPUS_SINGLE_STAGE) || !std::isnan(ref[k])) ) {
+                    nonFinite++;
+                    break;
+                }
+            }
+        }
+    }
+
+    // results masked by validation of source data
+    vector<char> masked(rows.size() * RESNUM);
+
+    {
+        TkrSourceData src;
+        src.calculate(rows);
+
+        for ( size_t i=0; i<rows.size(); i++ ) {
+            for ( size_t k=0; k<RESNUM; k++ ) {
+                masked[i * RESNUM + k] = src.isMasked(i) || (resStations[k] & src.val_absentStations(i));
+            }
+        }
+
+        cout << "masked rows" << CSVDELIMETER << src.val_validation().maskedNum << "\n";
+    }
+
+    cout << "phi clamped" << CSVDELIMETER << phiClamped << "\n"
+         << "E clamped" << CSVDELIMETER << eClamped << "\n"
+         << "Ft not converged" << CSVDELIMETER << ftFailed << "\n"
+         << "rows with non-finite results" << CSVDELIMETER << nonFinite << "\n\n";
+
+    bool ok = true;
+    vector<double> res(rows.size() * RESNUM);
+
+    for ( size_t m=0; m<MODENUM; m++ ) {
+
+        vector<ErrStats> stats(RESNUM);
+
+        const uint64_t limitUlp = (maxUlp >= 0) ? static_cast<uint64_t>(maxUlp) : modes[m].maxUlp;
+        const double limitRel = (maxRel >= 0) ? maxRel : modes[m].maxRel;
+
+        for ( size_t c=0; c<confs.size(); c++ ) {
+
+            modes[m].calculate(confs[c], rows, res);
+
+            for ( size_t i=0; i<res.size(); i++ ) {
+
+                ErrStats &st = stats[i % RESNUM];
+
+                if ( modes[m].validated && masked[i] ) {
+                    st.masked++;
+                    st.mismatches += !std::isnan(res[i]);
+                    continue;
+                }
+
+                // low pressure stage results of single stage rows are not defined
+                if ( (kinds[i / RESNUM] == CORPUS_SINGLE_STAGE) && std::isnan(refs[c][i]) ) {
+                    st.masked++;
+                    continue;
+                }
+
+                compare(res[i], refs[c][i], limitUlp, limitRel, st);
+            }
+        }
+
+        bool modeOk = true;
+        string failed;
+
+        cout << "Path" << CSVDELIMETER << modes[m].name << CSVDELIMETER << "ULP limit " << limitUlp
+             << CSVDELIMETER << "relative limit " << limitRel << "\n"
+             << "Parameter" << CSVDELIMETER << "Max absolute" << CSVDELIMETER << "Max relative"
+             << CSVDELIMETER << "Max ULP" << CSVDELIMETER << "Out of limits"
+             << CSVDELIMETER << "Non-finite mismatches" << CSVDELIMETER << "Masked" << "\n";
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+
+            cout << resCaptions[k] << CSVDELIMETER
+                 << stats[k].maxAbs << CSVDELIMETER
+                 << stats[k].maxRel << CSVDELIMETER
+                 << stats[k].maxUlp << CSVDELIMETER
+                 << stats[k].failures << CSVDELIMETER
+                 << stats[k].mismatches << CSVDELIMETER
+                 << stats[k].masked << "\n";
+
+            if ( (stats[k].failures > 0) || (stats[k].mismatches > 0) ) {
+                modeOk = false;
+                failed += CSVDELIMETER + resCaptions[k];
+            }
+        }
+
+        cout << "Result" << CSVDELIMETER << (modeOk ? "PASSED" : "FAILED") << failed << "\n\n";
+
+        ok = ok && modeOk;
+    }
+
+    for ( size_t c=0; c<confNames.size(); c++ ) {
+        cout << "Configuration " << (c + 1) << CSVDELIMETER << confNames[c] << "\n";
+    }
+
+    return ok ? EXITOK : EXITFAILED;
+}
@@ -0,0 +1,690 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: resultsstore.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "resultsstore.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <limits>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::unordered_map;
+using std::ifstream;
+using std::ofstream;
+using std::cout;
+
+namespace {
+
+const size_t RUNFIELDSNUM = 8;
+const size_t READCHUNK = 4096;
+
+} // namespace
+
+ResultsStore::ResultsStore(const shared_ptr<Configuration> &conf) :
+    m_conf(conf),
+    m_dir(conf->val_storeDir()) {
+}
+
+ResultsStore::~ResultsStore() {
+
+    // points of a failed commit are left orphaned
+    for ( auto it=m_partitions.begin(); it!=m_partitions.end(); ++it ) {
+        std::fclose(it->second);
+    }
+
+    unlock();
+}
+
+bool ResultsStore::open() {
+
+    if ( m_dir.empty() ) {
+        cout << ERRORMSGBLANK << "Directory of results store is not set!\n";
+        return false;
+    }
+
+    m_runs.clear();
+    m_engineIndex.clear();
+
+    const string fileName = filePath(STORERUNSNAME);
+    ifstream fin(fileName.c_str());
+
+    if ( !fin ) {
+        return true;
+    }
+
+    string str;
+    size_t rowNum = 0;
+
+    while ( std::getline(fin, str) ) {
+
+        if ( (rowNum++ < TABLECAPSTRNUM) || str.empty() ) {
+            continue;
+        }
+
+        vector<string> elem;
+        size_t pos = 0;
+
+        while ( true ) {
+
+            const size_t next = str.find(CSVDELIMETER[0], pos);
+            elem.push_back(str.substr(pos, (next == string::npos) ? string::npos : (next - pos)));
+
+            if ( next == string::npos ) {
+                break;
+            }
+
+            pos = next + 1;
+        }
+
+        Run run;
+
+        try {
+
+            if ( elem.size() != RUNFIELDSNUM ) {
+                throw boost::bad_lexical_cast();
+            }
+
+            run.id       = boost::lexical_cast<uint64_t>(elem[0]);
+            run.date     = elem[1];
+            run.engine   = elem[2];
+            run.profile  = elem[3];
+            run.rows     = boost::lexical_cast<size_t>(elem[4]);
+            run.binFirst = boost::lexical_cast<int64_t>(elem[5]);
+            run.binLast  = boost::lexical_cast<int64_t>(elem[6]);
+            run.config   = elem[7];
+        }
+        catch ( const boost::bad_lexical_cast & ) {
+            cout << WARNMSGBLANK << "Wrong row " << (rowNum - 1) << " in file \"" << fileName << "\"! Skipped.\n";
+            continue;
+        }
+
+        m_runs.push_back(run);
+    }
+
+    std::stable_sort(m_runs.begin(), m_runs.end(), [](const Run &a, const Run &b) {
+        return a.id < b.id;
+    });
+
+    for ( size_t i=0; i<m_runs.size(); i++ ) {
+        m_engineIndex.insert(std::make_pair(m_runs[i].engine, i));
+    }
+
+    return true;
+}
+
+bool ResultsStore::beginRuns(const vector< shared_ptr<Configuration> > &profiles) {
+
+    if ( !makeDirs(m_dir) ) {
+        cout << ERRORMSGBLANK << "Can not create directory \"" << m_dir << "\"!\n";
+        return false;
+    }
+
+    // configuration is copied as it is at the start of calculation
+    ifstream cfgin(m_conf->val_configFile().c_str(), std::ios::binary);
+    std::ostringstream cfg;
+
+    m_hasConfig = cfgin && (cfg << cfgin.rdbuf());
+    m_configText = m_hasConfig ? cfg.str() : string();
+
+    const string date = currDateTime();
+
+    m_newRuns.assign(profiles.size(), Run());
+
+    for ( size_t p=0; p<profiles.size(); p++ ) {
+
+        Run &run = m_newRuns[p];
+
+        run.date = date;
+        run.engine = cleanField(profiles[p]->val_testObjDescr());
+        run.profile = cleanField(profiles[p]->val_profileName());
+    }
+
+    m_pending.clear();
+    m_writeFailed = false;
+
+    return true;
+}
+
+void ResultsStore::addRows(size_t p, const TkrParameters &tkr) {
+
+    Run &run = m_newRuns[p];
+
+    const vector<double> &n = tkr.val_n();
+    const vector<double> &Me = tkr.val_Me();
+
+    const vector<double> *cols[RESNUM];
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        cols[k] = &tkr.resultColumn(k);
+    }
+
+    // run id is allocated by commitRuns(), profile index until then
+    Record rec;
+    rec.run = p;
+
+    for ( size_t i=0; i<tkr.val_rowsNum(); i++ ) {
+
+        if ( tkr.isMasked(i) || !std::isfinite(n[i]) ) {
+            continue;
+        }
+
+        const int64_t bin = static_cast<int64_t>(std::floor(n[i] / STOREBINN));
+
+        rec.n = n[i];
+        rec.Me = Me[i];
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            rec.res[k] = (*cols[k])[i];
+        }
+
+        m_pending[bin].push_back(rec);
+
+        if ( run.binFirst > run.binLast ) {
+            run.binFirst = run.binLast = bin;
+        }
+        else {
+            run.binFirst = std::min(run.binFirst, bin);
+            run.binLast = std::max(run.binLast, bin);
+        }
+
+        run.rows++;
+    }
+}
+
+bool ResultsStore::commitRuns() {
+
+    // runs of other processes committed before the lock are read again,
+    // so ids are allocated after them
+    if ( !lock() || !open() ) {
+        unlock();
+        return false;
+    }
+
+    uint64_t id = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+    // ids must increase even if the clock was set back
+    if ( !m_runs.empty() && (id <= m_runs.back().id) ) {
+        id = m_runs.back().id + 1;
+    }
+
+    const string config = "run_" + boost::lexical_cast<string>(id) + ".conf";
+
+    if ( m_hasConfig ) {
+
+        ofstream cfgout(filePath(config).c_str(), std::ios::binary);
+
+        if ( !(cfgout << m_configText) ) {
+            cout << ERRORMSGBLANK << "Can not write file \"" << filePath(config) << "\"!\n";
+            unlock();
+            return false;
+        }
+    }
+
+    for ( size_t p=0; p<m_newRuns.size(); p++ ) {
+        m_newRuns[p].id = id + p;
+        m_newRuns[p].config = m_hasConfig ? config : string("-");
+    }
+
+    for ( auto it=m_pending.begin(); it!=m_pending.end(); ++it ) {
+
+        vector<Record> &recs = it->second;
+
+        for ( size_t i=0; i<recs.size(); i++ ) {
+            recs[i].run += id;
+        }
+
+        FILE *f = partition(it->first);
+
+        if ( (f == nullptr) || (std::fwrite(recs.data(), sizeof(Record), recs.size(), f) != recs.size()) ) {
+            m_writeFailed = true;
+        }
+    }
+
+    m_pending.clear();
+
+    const bool ok = writeRuns();
+
+    unlock();
+
+    return ok;
+}
+
+bool ResultsStore::writeRuns() {
+
+    if ( !closePartitions() || m_writeFailed ) {
+        cout << ERRORMSGBLANK << "Can not write results to store \"" << m_dir << "\"!\n";
+        return false;
+    }
+
+    const string fileName = filePath(STORERUNSNAME);
+    const bool exists = static_cast<bool>(ifstream(fileName.c_str()));
+
+    ofstream fout(fileName.c_str(), std::ios::app);
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    if ( !exists ) {
+        fout << "run" << CSVDELIMETER << "date" << CSVDELIMETER << "engine" << CSVDELIMETER
+             << "profile" << CSVDELIMETER << "rows" << CSVDELIMETER << "binFirst" << CSVDELIMETER
+             << "binLast" << CSVDELIMETER << "config" << "\n";
+    }
+
+    for ( size_t p=0; p<m_newRuns.size(); p++ ) {
+
+        const Run &run = m_newRuns[p];
+
+        fout << run.id << CSVDELIMETER
+             << run.date << CSVDELIMETER
+             << run.engine << CSVDELIMETER
+             << run.profile << CSVDELIMETER
+             << run.rows << CSVDELIMETER
+             << run.binFirst << CSVDELIMETER
+             << run.binLast << CSVDELIMETER
+             << run.config << "\n";
+    }
+
+    fout.close();
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    for ( size_t p=0; p<m_newRuns.size(); p++ ) {
+
+        m_runs.push_back(m_newRuns[p]);
+        m_engineIndex.insert(std::make_pair(m_newRuns[p].engine, m_runs.size()-1));
+    }
+
+    cout << MSGBLANK << "Results of " << m_newRuns.size() << " run(s) added to store \"" << m_dir << "\".\n";
+
+    m_newRuns.clear();
+
+    return true;
+}
+
+bool ResultsStore::query() {
+
+    const string caption = m_conf->val_queryResult();
+
+    m_queryCol = std::find(resCaptions.begin(), resCaptions.end(), caption) - resCaptions.begin();
+
+    if ( m_queryCol == resCaptions.size() ) {
+        cout << ERRORMSGBLANK << "Unknown result \"" << caption << "\" in query!\n";
+        return false;
+    }
+
+    uint64_t from = 0;
+    uint64_t to = std::numeric_limits<uint64_t>::max();
+
+    if ( !parseDate(m_conf->val_queryFrom(), false, from) || !parseDate(m_conf->val_queryTo(), true, to) ) {
+        cout << ERRORMSGBLANK << "Wrong date in query, YYYY-MM-DD expected!\n";
+        return false;
+    }
+
+    // candidate runs by test object index or by time index
+    unordered_map<uint64_t, size_t> runs;
+
+    if ( !m_conf->val_queryEngine().empty() ) {
+
+        const auto range = m_engineIndex.equal_range(cleanField(m_conf->val_queryEngine()));
+
+        for ( auto it=range.first; it!=range.second; ++it ) {
+
+            const Run &run = m_runs[it->second];
+
+            if ( (run.id >= from) && (run.id < to) ) {
+                runs[run.id] = it->second;
+            }
+        }
+    }
+    else {
+
+        vector<uint64_t> ids(m_runs.size());
+
+        for ( size_t i=0; i<m_runs.size(); i++ ) {
+            ids[i] = m_runs[i].id;
+        }
+
+        const size_t first = std::lower_bound(ids.begin(), ids.end(), from) - ids.begin();
+        const size_t last = std::lower_bound(ids.begin(), ids.end(), to) - ids.begin();
+
+        for ( size_t i=first; i<last; i++ ) {
+            runs[ids[i]] = i;
+        }
+    }
+
+    m_queryRows.clear();
+
+    if ( runs.empty() ) {
+        cout << WARNMSGBLANK << "No runs found in store \"" << m_dir << "\".\n";
+        return true;
+    }
+
+    // partitions of n index
+    int64_t binFirst = std::numeric_limits<int64_t>::max();
+    int64_t binLast = std::numeric_limits<int64_t>::min();
+
+    for ( auto it=runs.begin(); it!=runs.end(); ++it ) {
+
+        const Run &run = m_runs[it->second];
+
+        if ( run.binFirst <= run.binLast ) {
+            binFirst = std::min(binFirst, run.binFirst);
+            binLast = std::max(binLast, run.binLast);
+        }
+    }
+
+    const double N = m_conf->val_queryN();
+    const double Me = m_conf->val_queryMe();
+    const double tolN = std::fabs(m_conf->val_queryTolN());
+    const double tolMe = std::fabs(m_conf->val_queryTolMe());
+
+    if ( N >= 0 ) {
+        binFirst = std::max(binFirst, static_cast<int64_t>(std::floor((N - tolN) / STOREBINN)));
+        binLast = std::min(binLast, static_cast<int64_t>(std::floor((N + tolN) / STOREBINN)));
+    }
+
+    vector<Record> recs(READCHUNK);
+
+    for ( int64_t bin=binFirst; bin<=binLast; bin++ ) {
+
+        FILE *f = std::fopen(partitionPath(bin).c_str(), "rb");
+
+        if ( f == nullptr ) {
+            continue;
+        }
+
+        size_t num = 0;
+
+        while ( (num = std::fread(recs.data(), sizeof(Record), recs.size(), f)) > 0 ) {
+
+            for ( size_t i=0; i<num; i++ ) {
+
+                const Record &rec = recs[i];
+                const auto run = runs.find(rec.run);
+
+                if ( (run == runs.end()) ||
+                     ((N >= 0) && !(std::fabs(rec.n - N) <= tolN)) ||
+                     ((Me >= 0) && !(std::fabs(rec.Me - Me) <= tolMe)) ) {
+                    continue;
+                }
+
+                QueryRow row = {run->second, rec.n, rec.Me, rec.res[m_queryCol]};
+                m_queryRows.push_back(row);
+            }
+        }
+
+        std::fclose(f);
+    }
+
+    std::stable_sort(m_queryRows.begin(), m_queryRows.end(), [](const QueryRow &a, const QueryRow &b) {
+        return a.run < b.run;
+    });
+
+    cout << MSGBLANK << "Query found " << m_queryRows.size() << " row(s) in " << runs.size() << " run(s).\n";
+
+    return true;
+}
+
+bool ResultsStore::createReport() const {
+
+    const string fileName = reportFileName(QRYREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    const string engine = m_conf->val_queryEngine();
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n"
+         << "Query of results store\n\n"
+         << "Store" << CSVDELIMETER << m_dir << "\n"
+         << "Result" << CSVDELIMETER << resCaptions[m_queryCol] << "\n"
+         << "Test object" << CSVDELIMETER << (engine.empty() ? string("any") : engine) << "\n"
+         << "Dates" << CSVDELIMETER << m_conf->val_queryFrom() << CSVDELIMETER << m_conf->val_queryTo() << "\n";
+
+    if ( m_conf->val_queryN() >= 0 ) {
+        fout << colCaptions[NCOL] << CSVDELIMETER << m_conf->val_queryN() << CSVDELIMETER << m_conf->val_queryTolN() << "\n";
+    }
+
+    if ( m_conf->val_queryMe() >= 0 ) {
+        fout << colCaptions[MECOL] << CSVDELIMETER << m_conf->val_queryMe() << CSVDELIMETER << m_conf->val_queryTolMe() << "\n";
+    }
+
+    fout << "Rows" << CSVDELIMETER << m_queryRows.size() << "\n\n";
+
+    fout << "Run" << CSVDELIMETER
+         << "Date" << CSVDELIMETER
+         << "Test object" << CSVDELIMETER
+         << "Profile" << CSVDELIMETER
+         << colCaptions[NCOL] << CSVDELIMETER
+         << colCaptions[MECOL] << CSVDELIMETER
+         << resCaptions[m_queryCol] << "\n";
+
+    string line;
+    char num[FIXEDBUFSIZE];
+
+    for ( size_t i=0; i<m_queryRows.size(); i++ ) {
+
+        const QueryRow &row = m_queryRows[i];
+        const Run &run = m_runs[row.run];
+
+        line = boost::lexical_cast<string>(run.id);
+        line += CSVDELIMETER;
+        line += run.date;
+        line += CSVDELIMETER;
+        line += run.engine;
+        line += CSVDELIMETER;
+        line += run.profile;
+        line += CSVDELIMETER;
+        line.append(num, formatFixed(row.n, 0, num));
+        line += CSVDELIMETER;
+        line.append(num, formatFixed(row.Me, 0, num));
+        line += CSVDELIMETER;
+
+        if ( std::isfinite(row.value) ) {
+            line.append(num, formatFixed(row.value, 4, num));
+        }
+
+        line += "\n";
+        fout.write(line.data(), line.size());
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\"created.\n";
+
+    return true;
+}
+
+string ResultsStore::filePath(const string &name) const {
+    return joinPath(m_dir, name);
+}
+
+string ResultsStore::partitionPath(int64_t bin) const {
+    return filePath(STOREPARTNAME + boost::lexical_cast<string>(bin) + ".bin");
+}
+
+FILE *ResultsStore::partition(int64_t bin) {
+
+    const auto it = m_partitions.find(bin);
+
+    if ( it != m_partitions.end() ) {
+        return it->second;
+    }
+
+    const string fileName = partitionPath(bin);
+
+    // records are always appended at the end of file, whatever was written before
+    FILE *f = std::fopen(fileName.c_str(), "ab");
+
+    if ( f == nullptr ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return nullptr;
+    }
+
+    // tail of record interrupted by a failed run is cut off, the store is locked
+    std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+
+    if ( (size % static_cast<long>(sizeof(Record))) != 0 ) {
+#ifdef _WIN32
+        _chsize(_fileno(f), size - size % static_cast<long>(sizeof(Record)));
+#else
+        if ( ftruncate(fileno(f), size - size % static_cast<long>(sizeof(Record))) != 0 ) {
+            cout << ERRORMSGBLANK << "Can not truncate file \"" << fileName << "\"!\n";
+        }
+#endif
+    }
+
+    m_partitions[bin] = f;
+
+    return f;
+}
+
+bool ResultsStore::lock() {
+
+#ifndef _WIN32
+    const string fileName = filePath(STORELOCKNAME);
+
+    m_lockFd = ::open(fileName.c_str(), O_RDWR | O_CREAT, 0666);
+
+    if ( m_lockFd < 0 ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    // runs of other processes are waited for
+    if ( flock(m_lockFd, LOCK_EX) != 0 ) {
+        cout << ERRORMSGBLANK << "Can not lock results store \"" << m_dir << "\"!\n";
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void ResultsStore::unlock() {
+
+#ifndef _WIN32
+    if ( m_lockFd >= 0 ) {
+        ::close(m_lockFd); // releases the lock
+        m_lockFd = -1;
+    }
+#endif
+}
+
+bool ResultsStore::closePartitions() {
+
+    bool ok = true;
+
+    for ( auto it=m_partitions.begin(); it!=m_partitions.end(); ++it ) {
+        if ( std::fclose(it->second) != 0 ) {
+            ok = false;
+        }
+    }
+
+    m_partitions.clear();
+
+    return ok;
+}
+
+string ResultsStore::cleanField(const string &str) {
+
+    string field = str;
+
+    for ( size_t i=0; i<field.size(); i++ ) {
+        if ( (field[i] == CSVDELIMETER[0]) || (field[i] == '\n') || (field[i] == '\r') ) {
+            field[i] = ' ';
+        }
+    }
+
+    return field;
+}
+
+bool ResultsStore::parseDate(const string &str, bool end, uint64_t &us) {
+
+    if ( str.empty() ) {
+        return true;
+    }
+
+    int year = 0;
+    int mon = 0;
+    int day = 0;
+
+    if ( (std::sscanf(str.c_str(), "%d-%d-%d", &year, &mon, &day) != 3) ||
+         (mon < 1) || (mon > 12) || (day < 1) || (day > 31) ) {
+        return false;
+    }
+
+    struct tm t = tm();
+    t.tm_year = year - 1900;
+    t.tm_mon = mon - 1;
+    t.tm_mday = end ? (day + 1) : day;
+    t.tm_isdst = -1;
+
+    const time_t sec = mktime(&t);
+
+    if ( sec == static_cast<time_t>(-1) ) {
+        return false;
+    }
+
+    us = static_cast<uint64_t>(sec) * 1000000;
+
+    return true;
+}
@@ -0,0 +1,125 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: resultsstore.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RESULTSSTORE_HPP
+#define RESULTSSTORE_HPP
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+
+#include "configuration.hpp"
+#include "constants.hpp"
+#include "tkrparameters.hpp"
+
+//
+// Append-only store of results of all runs in directory storeDir.
+// Table of runs (STORERUNSNAME) keeps test object description, profile,
+// date and copy of configuration of every run and is indexed in memory
+// by test object and by time. Results of operating points are appended
+// to binary partition files by bins of n (STOREPARTNAME<bin>.bin), so
+// a query of an operating point reads only neighbouring partitions.
+// Points are kept in memory during calculation and written by
+// commitRuns(), the run is written to the table after its points, points
+// of runs not found in the table are ignored. Writing processes are
+// serialized by lock file STORELOCKNAME held only by commitRuns(), the
+// lock is not taken on Windows.
+//
+
+class ResultsStore {
+
+public:
+
+    ResultsStore(const std::shared_ptr<Configuration> &conf);
+    ~ResultsStore();
+
+    bool open();
+
+    bool beginRuns(const std::vector< std::shared_ptr<Configuration> > &profiles);
+    void addRows(size_t profile, const TkrParameters &);
+    bool commitRuns();
+
+    bool query();
+    bool createReport() const;
+
+private:
+
+    struct Run {
+        uint64_t id = 0;     // microseconds since epoch
+        std::string date;
+        std::string engine;
+        std::string profile;
+        size_t rows = 0;
+        int64_t binFirst = 0;
+        int64_t binLast = -1;
+        std::string config;
+    };
+
+    // binary record of partition file in native byte order
+    struct Record {
+        uint64_t run;
+        double n;
+        double Me;
+        double res[RESNUM];
+    };
+
+    struct QueryRow {
+        size_t run; // index in m_runs
+        double n;
+        double Me;
+        double value;
+    };
+
+    std::string filePath(const std::string &) const;
+    std::string partitionPath(int64_t) const;
+    FILE *partition(int64_t);
+    bool closePartitions();
+    bool writeRuns();
+
+    bool lock();
+    void unlock();
+
+    static std::string cleanField(const std::string &);
+    static bool parseDate(const std::string &, bool, uint64_t &);
+
+    std::shared_ptr<Configuration> m_conf;
+    std::string m_dir;
+
+    std::vector<Run> m_runs; // ordered by id, i.e. by time
+    std::unordered_multimap<std::string, size_t> m_engineIndex;
+
+    std::vector<Run> m_newRuns; // per profile
+    std::map<int64_t, std::vector<Record> > m_pending; // points of new runs by bins
+    std::string m_configText;
+    bool m_hasConfig = false;
+    std::map<int64_t, FILE *> m_partitions;
+    bool m_writeFailed = false;
+    int m_lockFd = -1; // lock file held by commitRuns()
+
+    size_t m_queryCol = 0;
+    std::vector<QueryRow> m_queryRows;
+
+};
+
+#endif // RESULTSSTORE_HPP
@@ -0,0 +1,188 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/rtcheck.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+//
+// Check of the real-time loop: input ring buffer is filled with RTCHECKPOINTS
+// points before RealTime::process() starts, the loop pops, calculates,
+// pushes and records latency of all of them while heap allocations are
+// counted. Fails if the loop allocates or results of a point are missing.
+// Run by ctest.
+//
+
+#include "realtime.hpp"
+#include "shmring.hpp"
+#include "configuration.hpp"
+#include "constants.hpp"
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+#include <boost/lexical_cast.hpp>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::shared_ptr;
+using std::cout;
+
+namespace {
+
+const size_t RTCHECKPOINTS = 4000;
+
+// heap allocations are counted while the loop runs
+std::atomic<bool> countAllocations(false);
+std::atomic<size_t> allocations(0);
+
+// operating point of a two stage engine in order of colCaptions
+const double typicalPoint[SRCCOLNUM] = {
+    2000, 769, 161.06, 28.84, 720.9, 1.004, -0.96, 0.529, 0.505, 1.25, 1.202, 1.057,
+    0.433, 1.44, 18.6, 83.3, 42.0, 112.9, 42.0, 520.2, 410.5, 346.1, 80
+};
+
+} // namespace
+
+void *operator new(size_t size) {
+
+    if ( countAllocations.load(std::memory_order_relaxed) ) {
+        allocations++;
+    }
+
+    void *p = std::malloc(size ? size : 1);
+
+    if ( !p ) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+// GCC takes the replaced pair for mismatched new/free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+int main() {
+
+#ifdef _WIN32
+    cout << WARNMSGBLANK << "Real-time calculation is not supported on this system, check skipped.\n";
+    return EXITOK;
+#else
+    const string suffix = boost::lexical_cast<string>(getpid());
+    const string inName = "tkr_rtcheck_in_" + suffix;
+    const string outName = "tkr_rtcheck_out_" + suffix;
+
+    shared_ptr<Configuration> conf(new Configuration());
+
+    try {
+        conf->overrideParameter("rtInput", inName);
+        conf->overrideParameter("rtOutput", outName);
+        conf->overrideParameter("rtCapacity", boost::lexical_cast<string>(RTCHECKPOINTS));
+        conf->overrideParameter("rtPoints", boost::lexical_cast<string>(RTCHECKPOINTS));
+        conf->overrideParameter("rtLockMemory", "0");
+    }
+    catch ( const ConfigError &e ) {
+        cout << ERRORMSGBLANK << e.what() << "\n";
+        return EXITCONFIG;
+    }
+
+    // both rings are created here, so they are removed at exit
+    ShmRing input;
+    ShmRing output;
+
+    if ( !input.open(inName, RTSRCRECORD, RTCHECKPOINTS) ||
+         !output.open(outName, RTRESRECORD, RTCHECKPOINTS) ) {
+        return EXITFAILED;
+    }
+
+    // every tenth point has invalid source data, tag is the point number
+    double src[RTSRCRECORD];
+
+    for ( size_t i=0; i<RTCHECKPOINTS; i++ ) {
+
+        src[0] = i;
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            src[j + 1] = typicalPoint[j] * (1 + 1e-5 * (i % 97));
+        }
+
+        if ( i % 10 == 0 ) {
+            src[1 + GAIRCOL] = -1;
+        }
+
+        if ( !input.push(src) ) {
+            cout << ERRORMSGBLANK << "Input ring buffer is full!\n";
+            return EXITFAILED;
+        }
+    }
+
+    RealTime rt(conf);
+
+    if ( !rt.start() ) {
+        return EXITFAILED;
+    }
+
+    countAllocations = true;
+    rt.process();
+    countAllocations = false;
+
+    rt.finish();
+
+    double res[RTRESRECORD];
+    size_t results = 0;
+    bool tagged = true;
+
+    while ( output.pop(res) ) {
+        tagged = tagged && (res[0] == results);
+        results++;
+    }
+
+    cout << "Points" << CSVDELIMETER << RTCHECKPOINTS << "\n"
+         << "Results" << CSVDELIMETER << results << "\n"
+         << "Allocations" << CSVDELIMETER << allocations.load() << "\n";
+
+    if ( allocations.load() > 0 ) {
+        cout << ERRORMSGBLANK << "Real-time loop allocated memory!\n";
+        return EXITFAILED;
+    }
+
+    if ( (results != RTCHECKPOINTS) || !tagged ) {
+        cout << ERRORMSGBLANK << "Results of points are missing or out of order!\n";
+        return EXITFAILED;
+    }
+
+    return EXITOK;
+#endif
+}
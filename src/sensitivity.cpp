@@ -0,0 +1,221 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: sensitivity.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sensitivity.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+#include "tkrkernel.hpp"
+#include "dual.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+
+using std::cout;
+using std::string;
+using std::vector;
+using std::shared_ptr;
+
+typedef Dual<SRCCOLNUM> SrcDual;
+
+Sensitivity::Sensitivity(const shared_ptr<Configuration> &cfg) {
+    m_conf = cfg;
+}
+
+bool Sensitivity::calculate(const vector< vector<double> > &v) {
+
+    if ( v.empty() ) {
+        return false;
+    }
+
+    const vector<string> names = m_conf->val_saResults();
+    m_resInd.clear();
+
+    for ( size_t k=0; k<names.size(); k++ ) {
+
+        size_t ind = 0;
+
+        while ( (ind < resCaptions.size()) && (resCaptions[ind] != names[k]) ) {
+            ind++;
+        }
+
+        if ( ind == resCaptions.size() ) {
+            cout << WARNMSGBLANK << "Unknown result \"" << names[k] << "\" for sensitivity analysis! Skipped.\n";
+            continue;
+        }
+
+        m_resInd.push_back(ind);
+    }
+
+    if ( m_resInd.empty() ) {
+        return false;
+    }
+
+    m_n = v.size();
+
+    ma_n.resize(m_n);
+    ma_Me.resize(m_n);
+    ma_val.resize(m_n * m_resInd.size());
+    ma_der.resize(m_n * m_resInd.size() * SRCCOLNUM);
+
+    const TkrCalcParams params = m_conf->val_calcParams();
+    const double masked = std::numeric_limits<double>::quiet_NaN();
+
+    for ( size_t i=0; i<m_n; i++ ) {
+
+        ma_n [i] = v[i][0];
+        ma_Me[i] = v[i][1];
+
+        // the same validation and masking as for the results report
+        TkrRow<double> check;
+
+        tkrSetSource(check, v[i].data());
+        tkrPreCalculate(check);
+
+        const bool invalid = (tkrInvalidColumns(v[i].data(), check) != 0);
+        const unsigned absent = tkrAbsentStations(check);
+
+        // every source data column is an independent variable
+        SrcDual src[SRCCOLNUM];
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            src[j] = SrcDual(v[i][j], j);
+        }
+
+        TkrRow<SrcDual> r;
+
+        tkrSetSource(r, src);
+        tkrPreCalculate(r);
+
+        if ( !invalid ) {
+            tkrCalculate(r, params);
+        }
+
+        for ( size_t k=0; k<m_resInd.size(); k++ ) {
+
+            const SrcDual &res = tkrResult(r, m_resInd[k]);
+            const size_t ind = i * m_resInd.size() + k;
+            const bool skip = invalid || (resStations[m_resInd[k]] & absent);
+
+            ma_val[ind] = skip ? masked : res.val();
+
+            for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+                ma_der[ind * SRCCOLNUM + j] = skip ? masked : res.der(j);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Sensitivity::createReport() const {
+
+    const string fileName = reportFileName(SAREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n";
+
+    if ( !m_conf->val_profileName().empty() ) {
+        fout << "Configuration profile: " << m_conf->val_profileName() << "\n\n";
+    }
+
+    fout << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
+         << "Sensitivity coefficients (partial derivatives of result with respect to source data columns)\n";
+
+    const vector<double> tols = m_conf->val_mcTolerances();
+    bool withTols = false;
+
+    for ( size_t j=0; j<tols.size(); j++ ) {
+        if ( tols[j] != 0 ) {
+            withTols = true;
+        }
+    }
+
+    for ( size_t k=0; k<m_resInd.size(); k++ ) {
+
+        fout << "\n" << resCaptions[m_resInd[k]] << "\n\n"
+             << "n[min-1]" << CSVDELIMETER
+             << "Me[Nm]"   << CSVDELIMETER
+             << resCaptions[m_resInd[k]] << CSVDELIMETER << CSVDELIMETER;
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            fout << "d/d " << colCaptions[j] << CSVDELIMETER;
+        }
+
+        if ( withTols ) {
+            fout << CSVDELIMETER << "Dominant error source";
+        }
+
+        fout << "\n";
+
+        for ( size_t i=0; i<m_n; i++ ) {
+
+            const size_t ind = i * m_resInd.size() + k;
+
+            fout << cell(ma_n[i], 0)     << CSVDELIMETER
+                 << cell(ma_Me[i], 0)    << CSVDELIMETER
+                 << cell(ma_val[ind], 4) << CSVDELIMETER << CSVDELIMETER;
+
+            size_t dominant = 0;
+            double maxContrib = -1;
+
+            for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+
+                const double der = ma_der[ind * SRCCOLNUM + j];
+                fout << sciCell(der, 4) << CSVDELIMETER;
+
+                // contribution of column uncertainty to result uncertainty
+                const double contrib = fabs(der * tols[j]);
+
+                if ( contrib > maxContrib ) {
+                    maxContrib = contrib;
+                    dominant = j;
+                }
+            }
+
+            if ( withTols && (maxContrib >= 0) ) {
+                fout << CSVDELIMETER << colCaptions[dominant];
+            }
+
+            fout << "\n";
+        }
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\" created.\n";
+
+    return true;
+}
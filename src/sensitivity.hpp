@@ -0,0 +1,56 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: sensitivity.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SENSITIVITY_HPP
+#define SENSITIVITY_HPP
+
+#include <vector>
+#include <memory>
+
+#include "configuration.hpp"
+
+class Sensitivity {
+
+public:
+
+    Sensitivity(const std::shared_ptr<Configuration> &conf);
+
+    bool calculate(const std::vector< std::vector<double> > &);
+    bool createReport() const;
+
+private:
+
+    std::shared_ptr<Configuration> m_conf;
+
+    size_t m_n = 0;
+
+    std::vector<size_t> m_resInd; // numbers of selected results in resCaptions
+
+    std::vector<double> ma_n;
+    std::vector<double> ma_Me;
+
+    // values of selected results, array of m_n * m_resInd.size() elements
+    std::vector<double> ma_val;
+    // partial derivatives, array of m_n * m_resInd.size() * SRCCOLNUM elements
+    std::vector<double> ma_der;
+
+};
+
+#endif // SENSITIVITY_HPP
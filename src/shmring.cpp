@@ -0,0 +1,208 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: shmring.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "shmring.hpp"
+#include "constants.hpp"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using std::cout;
+using std::string;
+
+ShmRing::~ShmRing() {
+    close();
+}
+
+#ifndef _WIN32
+
+bool ShmRing::open(const string &name, size_t recordSize, size_t capacity) {
+
+    close();
+
+    size_t cap = 1;
+
+    while ( cap < capacity ) {
+        cap <<= 1;
+    }
+
+    m_name = (name.empty() || (name[0] != '/')) ? ("/" + name) : name;
+
+    int fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    m_created = (fd >= 0);
+
+    if ( !m_created && (errno == EEXIST) ) {
+        fd = shm_open(m_name.c_str(), O_RDWR, 0600);
+    }
+
+    if ( fd < 0 ) {
+        cout << ERRORMSGBLANK << "Can not open shared memory \"" << m_name << "\": " << std::strerror(errno) << "!\n";
+        return false;
+    }
+
+    if ( m_created ) {
+
+        m_mapSize = SHMRINGHEADERSIZE + cap * recordSize * sizeof(double);
+
+        if ( ftruncate(fd, static_cast<off_t>(m_mapSize)) != 0 ) {
+            cout << ERRORMSGBLANK << "Can not resize shared memory \"" << m_name << "\": " << std::strerror(errno) << "!\n";
+            ::close(fd);
+            shm_unlink(m_name.c_str());
+            m_created = false;
+            return false;
+        }
+    }
+    else {
+
+        struct stat st;
+
+        if ( (fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) < SHMRINGHEADERSIZE) ) {
+            cout << ERRORMSGBLANK << "Shared memory \"" << m_name << "\" is not a ring buffer!\n";
+            ::close(fd);
+            return false;
+        }
+
+        m_mapSize = static_cast<size_t>(st.st_size);
+    }
+
+    m_map = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if ( m_map == MAP_FAILED ) {
+        cout << ERRORMSGBLANK << "Can not map shared memory \"" << m_name << "\": " << std::strerror(errno) << "!\n";
+        m_map = nullptr;
+        close();
+        return false;
+    }
+
+    m_header = static_cast<ShmRingHeader *>(m_map);
+    m_records = reinterpret_cast<double *>(static_cast<char *>(m_map) + SHMRINGHEADERSIZE);
+
+    if ( m_created ) {
+
+        std::memset(m_map, 0, SHMRINGHEADERSIZE);
+
+        new (&m_header->tail) std::atomic<uint64_t>(0);
+        new (&m_header->head) std::atomic<uint64_t>(0);
+
+        m_header->version = SHMRINGVERSION;
+        m_header->recordSize = static_cast<uint32_t>(recordSize);
+        m_header->capacity = static_cast<uint32_t>(cap);
+
+        // magic is written last, the other side checks it before the layout
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = SHMRINGMAGIC;
+    }
+    else {
+
+        const uint64_t size = m_header->capacity;
+
+        if ( (m_header->magic != SHMRINGMAGIC) || (m_header->version != SHMRINGVERSION) ||
+             (m_header->recordSize != recordSize) || (size == 0) || ((size & (size - 1)) != 0) ||
+             (m_mapSize < (SHMRINGHEADERSIZE + size * recordSize * sizeof(double))) ) {
+            cout << ERRORMSGBLANK << "Shared memory \"" << m_name << "\" has wrong layout of ring buffer!\n";
+            close();
+            return false;
+        }
+
+        cap = static_cast<size_t>(size);
+    }
+
+    m_recordSize = recordSize;
+    m_mask = cap - 1;
+
+    return true;
+}
+
+void ShmRing::close() {
+
+    if ( m_map ) {
+        munmap(m_map, m_mapSize);
+    }
+
+    if ( m_created ) {
+        shm_unlink(m_name.c_str());
+    }
+
+    m_map = nullptr;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_created = false;
+}
+
+#else
+
+bool ShmRing::open(const string &name, size_t, size_t) {
+    cout << ERRORMSGBLANK << "Shared memory \"" << name << "\" is not supported on this system!\n";
+    return false;
+}
+
+void ShmRing::close() {
+}
+
+#endif
+
+bool ShmRing::push(const double *rec) noexcept {
+
+    const uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+
+    if ( (tail - m_header->head.load(std::memory_order_acquire)) > m_mask ) {
+        return false;
+    }
+
+    std::memcpy(m_records + (tail & m_mask) * m_recordSize, rec, m_recordSize * sizeof(double));
+    m_header->tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool ShmRing::pop(double *rec) noexcept {
+
+    const uint64_t head = m_header->head.load(std::memory_order_relaxed);
+
+    if ( m_header->tail.load(std::memory_order_acquire) == head ) {
+        return false;
+    }
+
+    std::memcpy(rec, m_records + (head & m_mask) * m_recordSize, m_recordSize * sizeof(double));
+    m_header->head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+void ShmRing::touch() const noexcept {
+
+    const volatile char *p = static_cast<const volatile char *>(m_map);
+
+    for ( size_t i=0; p && (i < m_mapSize); i += SHMRINGPAGE ) {
+        static_cast<void>(p[i]);
+    }
+}
@@ -0,0 +1,108 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: shmring.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHMRING_HPP
+#define SHMRING_HPP
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//
+// Layout of ring buffer in POSIX shared memory object, all values are in
+// native byte order. Header of SHMRINGHEADERSIZE bytes is followed by
+// capacity records of recordSize doubles, record k is stored in slot
+// (k & (capacity - 1)). The producer writes the record into slot tail and
+// then stores tail + 1 with release semantics, the consumer reads slot
+// head after loading tail with acquire semantics and then stores head + 1.
+// The ring is full when tail - head == capacity.
+//
+
+struct ShmRingHeader {
+    uint32_t magic;              // SHMRINGMAGIC
+    uint32_t version;            // SHMRINGVERSION
+    uint32_t recordSize;         // doubles per record
+    uint32_t capacity;           // records, power of two
+    char pad0[48];
+    std::atomic<uint64_t> tail;  // offset 64, number of records written by producer
+    char pad1[56];
+    std::atomic<uint64_t> head;  // offset 128, number of records read by consumer
+    char pad2[56];
+};
+
+#define SHMRINGMAGIC      0x524b5254 // "TKRR"
+#define SHMRINGVERSION    1
+#define SHMRINGHEADERSIZE 192
+#define SHMRINGPAGE       4096
+
+static_assert(sizeof(ShmRingHeader) == SHMRINGHEADERSIZE, "Wrong layout of ring buffer header");
+static_assert((ATOMIC_LLONG_LOCK_FREE == 2) && (sizeof(std::atomic<uint64_t>) == 8),
+              "Counters of ring buffer must be lock-free to be shared between processes");
+
+//
+// One side of single-producer/single-consumer ring buffer shared with
+// another process. open() attaches to existing shared memory object with
+// the same record size or creates new one, the object is removed by the
+// side which created it.
+//
+
+class ShmRing {
+
+public:
+
+    ShmRing() {
+    }
+    ~ShmRing();
+
+    ShmRing(const ShmRing &) = delete;
+    ShmRing &operator=(const ShmRing &) = delete;
+
+    bool open(const std::string &name, size_t recordSize, size_t capacity);
+    void close();
+
+    // false if ring is full, record is not written
+    bool push(const double *) noexcept;
+    // false if ring is empty
+    bool pop(double *) noexcept;
+
+    // reads every page of the mapping, so the loop has no page faults
+    void touch() const noexcept;
+
+    size_t val_capacity() const {
+        return m_mask + 1;
+    }
+
+private:
+
+    std::string m_name;
+    bool m_created = false;
+
+    void *m_map = nullptr;
+    size_t m_mapSize = 0;
+
+    ShmRingHeader *m_header = nullptr;
+    double *m_records = nullptr;
+    size_t m_recordSize = 0;
+    uint64_t m_mask = 0;
+
+};
+
+#endif // SHMRING_HPP
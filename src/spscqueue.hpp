@@ -0,0 +1,92 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: spscqueue.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+//
+// Bounded lock-free queue for one producer thread and one consumer thread.
+// Capacity is rounded up to power of two. push() waits while queue is full,
+// pop() waits while queue is empty.
+//
+
+template<typename T>
+class SpscQueue {
+
+public:
+
+    explicit SpscQueue(size_t capacity) {
+
+        size_t cap = 1;
+
+        while ( cap < capacity ) {
+            cap <<= 1;
+        }
+
+        m_mask = cap - 1;
+        ma_buf.resize(cap);
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    void push(T &&val) {
+
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        while ( (tail - m_head.load(std::memory_order_acquire)) > m_mask ) {
+            std::this_thread::yield();
+        }
+
+        ma_buf[tail & m_mask] = std::move(val);
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    void pop(T &val) {
+
+        const size_t head = m_head.load(std::memory_order_relaxed);
+
+        while ( m_tail.load(std::memory_order_acquire) == head ) {
+            std::this_thread::yield();
+        }
+
+        val = std::move(ma_buf[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+private:
+
+    size_t m_mask = 0;
+    std::vector<T> ma_buf;
+
+    // head and tail are kept on separate cache lines to avoid false sharing
+    char m_pad0[64];
+    std::atomic<size_t> m_head{0};
+    char m_pad1[64];
+    std::atomic<size_t> m_tail{0};
+
+};
+
+#endif // SPSCQUEUE_HPP
@@ -0,0 +1,49 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: srcdatafilter.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "srcdatafilter.hpp"
+#include "constants.hpp"
+#include "steadystate.hpp"
+#include "transientwindow.hpp"
+
+#include <iostream>
+#include <memory>
+
+using std::unique_ptr;
+using std::shared_ptr;
+using std::cout;
+
+unique_ptr<SrcDataFilter> srcDataFilter(const shared_ptr<Configuration> &conf) {
+
+    if ( conf->val_ssWindow() > 0 ) {
+
+        if ( conf->val_trWindow() > 0 ) {
+            cout << WARNMSGBLANK << "Both steady-state detection and transient mode are enabled. Transient mode ignored.\n";
+        }
+
+        return unique_ptr<SrcDataFilter>(new SteadyState(conf));
+    }
+
+    if ( conf->val_trWindow() > 0 ) {
+        return unique_ptr<SrcDataFilter>(new TransientWindow(conf));
+    }
+
+    return unique_ptr<SrcDataFilter>();
+}
@@ -0,0 +1,49 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: srcdatafilter.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SRCDATAFILTER_HPP
+#define SRCDATAFILTER_HPP
+
+#include <vector>
+#include <memory>
+
+#include "configuration.hpp"
+#include "srcdatareader.hpp"
+
+//
+// Preprocessing of raw time series of source data into rows for calculation.
+//
+
+class SrcDataFilter {
+
+public:
+
+    virtual ~SrcDataFilter() {}
+
+    // reads raw samples until the next row is ready
+    virtual bool readRow(SrcDataReader &, std::vector<double> &) = 0;
+    virtual void printSummary() const = 0;
+
+};
+
+// Returns filter selected by configuration or empty pointer if source data rows are used as is.
+std::unique_ptr<SrcDataFilter> srcDataFilter(const std::shared_ptr<Configuration> &);
+
+#endif // SRCDATAFILTER_HPP
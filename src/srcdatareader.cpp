@@ -0,0 +1,261 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: srcdatareader.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "srcdatareader.hpp"
+#include "constants.hpp"
+#include "compression.hpp"
+#include "numparser.hpp"
+#include "auxfunctions.hpp"
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <boost/algorithm/string.hpp>
+
+using std::string;
+using std::vector;
+using std::cout;
+
+const size_t SrcDataReader::NOCOL;
+
+SrcDataReader::SrcDataReader() {
+}
+
+bool SrcDataReader::open(const string &srcFileName) {
+
+    string fileName(srcFileName);
+
+    // compressed source data file is used if there is no plain one
+    if ( !fileExists(fileName) ) {
+        fileName += GZEXT;
+    }
+
+    if ( !fileExists(fileName) ) {
+        cout << ERRORMSGBLANK << "Source data file \"" << srcFileName << "\" not found!\n";
+        return false;
+    }
+
+    if ( !m_fin.open(fileName) ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to read!\n";
+        return false;
+    }
+
+    m_rawRowsNum = 0;
+    m_colMap.clear();
+    m_errorsNum = 0;
+    m_errors.clear();
+
+    return true;
+}
+
+bool SrcDataReader::readRow(vector<double> &row) {
+
+    const char delim = CSVDELIMETER[0];
+
+    while ( m_fin.getline(m_str) ) {
+
+        if ( m_str.empty() ) {
+            continue;
+        }
+
+        if ( m_rawRowsNum < TABLECAPSTRNUM ) {
+
+            // the last caption row defines columns
+            if ( (++m_rawRowsNum == TABLECAPSTRNUM) && !mapColumns() ) {
+                return false;
+            }
+
+            continue;
+        }
+
+        row.resize(colCaptions.size());
+
+        const char *first = m_str.data();
+        const char *end   = first + m_str.size();
+
+        size_t fieldsNum = 0;
+        bool emptyCell = false;
+        m_rowErrors.clear();
+
+        // only the fields mapped onto source data columns are converted
+        while ( true ) {
+
+            const char *last = first;
+
+            while ( (last != end) && (*last != delim) ) {
+                last++;
+            }
+
+            const size_t k = fieldsNum++;
+
+            if ( (k < m_colMap.size()) && (m_colMap[k] != NOCOL) ) {
+
+                if ( first == last ) {
+                    emptyCell = true;
+                }
+                else if ( !parseNumber(first, last, row[m_colMap[k]]) ) {
+                    m_rowErrors.push_back(SrcDataError{m_rawRowsNum, k, m_colMap[k], string(first, last)});
+                }
+            }
+
+            if ( last == end ) {
+                break;
+            }
+
+            first = last + 1;
+        }
+
+        // rows with empty cells are ignored
+        if ( emptyCell ) {
+            continue;
+        }
+
+        const size_t i = m_rawRowsNum++;
+
+        if ( fieldsNum != m_colMap.size() ) {
+            cout << WARNMSGBLANK << "Row " << i << " of source data array has wrong elements number! Skipped.\n";
+            continue;
+        }
+
+        if ( !m_rowErrors.empty() ) {
+
+            for ( size_t e=0; (e<m_rowErrors.size()) && (m_errors.size()<SRCERRMAXNUM); e++ ) {
+                m_errors.push_back(m_rowErrors[e]);
+            }
+
+            m_errorsNum += m_rowErrors.size();
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool SrcDataReader::mapColumns() {
+
+    const char delim = CSVDELIMETER[0];
+
+    vector<string> names;
+    size_t pos = 0;
+
+    while ( true ) {
+
+        const size_t next = m_str.find(delim, pos);
+        string name = m_str.substr(pos, (next == string::npos) ? string::npos : (next - pos));
+
+        boost::trim_if(name, boost::is_any_of(" \t\""));
+        names.push_back(name);
+
+        if ( next == string::npos ) {
+            break;
+        }
+
+        pos = next + 1;
+    }
+
+    m_colMap.assign(names.size(), NOCOL);
+
+    vector<bool> found(colCaptions.size(), false);
+    size_t foundNum = 0;
+    bool wrongUnit = false;
+
+    for ( size_t c=0; c<colCaptions.size(); c++ ) {
+
+        for ( size_t k=0; k<names.size(); k++ ) {
+
+            if ( (m_colMap[k] != NOCOL) || (captionName(names[k]) != captionName(colCaptions[c])) ) {
+                continue;
+            }
+
+            // caption without unit is taken in the standard unit
+            const string unit = captionUnit(names[k]);
+
+            if ( !unit.empty() && (unit != captionUnit(colCaptions[c])) ) {
+                cout << ERRORMSGBLANK << "Unit of column \"" << names[k] << "\" of source data file differs from \""
+                     << colCaptions[c] << "\"!\n";
+                wrongUnit = true;
+                break;
+            }
+
+            m_colMap[k] = c;
+            found[c] = true;
+            foundNum++;
+            break;
+        }
+    }
+
+    if ( wrongUnit ) {
+        return false;
+    }
+
+    if ( foundNum == colCaptions.size() ) {
+        return true;
+    }
+
+    // table with own captions but standard columns order, captions
+    // matched partly may be reordered columns and are not trusted
+    if ( (foundNum == 0) && (names.size() == colCaptions.size()) ) {
+
+        for ( size_t k=0; k<names.size(); k++ ) {
+            m_colMap[k] = k;
+        }
+
+        return true;
+    }
+
+    for ( size_t c=0; c<colCaptions.size(); c++ ) {
+        if ( !found[c] ) {
+            cout << ERRORMSGBLANK << "Column \"" << colCaptions[c] << "\" not found in source data file!\n";
+        }
+    }
+
+    return false;
+}
+
+string SrcDataReader::captionName(const string &caption) {
+    return caption.substr(0, caption.find('['));
+}
+
+string SrcDataReader::captionUnit(const string &caption) {
+
+    const size_t pos = caption.find('[');
+
+    return (pos == string::npos) ? string() : caption.substr(pos);
+}
+
+void SrcDataReader::printErrors() const {
+
+    if ( m_errorsNum == 0 ) {
+        return;
+    }
+
+    for ( size_t k=0; k<m_errors.size(); k++ ) {
+        cout << WARNMSGBLANK << "Row " << m_errors[k].row << ", column " << (m_errors[k].col + 1)
+             << " (" << colCaptions[m_errors[k].param] << ") of source data array is not a number: \""
+             << m_errors[k].text << "\"! Row skipped.\n";
+    }
+
+    if ( m_errorsNum > m_errors.size() ) {
+        cout << WARNMSGBLANK << (m_errorsNum - m_errors.size()) << " more wrong cells of source data array.\n";
+    }
+}
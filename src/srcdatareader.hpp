@@ -0,0 +1,92 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: srcdatareader.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SRCDATAREADER_HPP
+#define SRCDATAREADER_HPP
+
+#include <string>
+#include <vector>
+
+#include "compression.hpp"
+
+//
+// Cell of source data file which is not a number.
+//
+
+struct SrcDataError {
+    size_t row;
+    size_t col;   // column of source data file
+    size_t param; // index in colCaptions
+    std::string text;
+};
+
+//
+// Row by row reading of source data file. Columns are found by captions
+// of the table, so the file may have any number of additional columns in
+// any order; they are not converted. A caption may omit the unit, a
+// different unit is an error. A table of SRCCOLNUM columns without any
+// known caption is read in the standard column order. Rows with wrong
+// cells are skipped, the cells are collected and can be printed after
+// reading.
+//
+
+class SrcDataReader {
+
+public:
+
+    SrcDataReader();
+
+    bool open(const std::string &);
+    bool readRow(std::vector<double> &);
+
+    size_t val_rawRowsNum() const {
+        return m_rawRowsNum;
+    }
+    size_t val_errorsNum() const {
+        return m_errorsNum;
+    }
+    const std::vector<SrcDataError> &val_errors() const {
+        return m_errors;
+    }
+
+    void printErrors() const;
+
+private:
+
+    static const size_t NOCOL = size_t(-1);
+
+    bool mapColumns();
+    static std::string captionName(const std::string &);
+    static std::string captionUnit(const std::string &);
+
+    GzLineReader m_fin;
+
+    std::string m_str;
+    std::vector<size_t> m_colMap; // file column -> colCaptions index or NOCOL
+
+    size_t m_rawRowsNum = 0; // number of non-empty rows including table caption
+
+    size_t m_errorsNum = 0;
+    std::vector<SrcDataError> m_errors; // first SRCERRMAXNUM errors
+    std::vector<SrcDataError> m_rowErrors;
+
+};
+
+#endif // SRCDATAREADER_HPP
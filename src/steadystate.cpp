@@ -0,0 +1,223 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: steadystate.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "steadystate.hpp"
+#include "constants.hpp"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+using std::vector;
+using std::shared_ptr;
+using std::cout;
+
+namespace {
+
+const size_t detCols[3] = {NCOL, MECOL, GAIRCOL};
+
+} // namespace
+
+SteadyState::SteadyState(const shared_ptr<Configuration> &conf) :
+    m_window(conf->val_ssWindow()),
+    m_minSamples(conf->val_ssMinSamples()) {
+
+    if ( m_window < 2 ) {
+        m_window = 2;
+    }
+
+    if ( m_minSamples < m_window ) {
+        m_minSamples = m_window;
+    }
+
+    m_tol[0] = conf->val_ssTolN();
+    m_tol[1] = conf->val_ssTolMe();
+    m_tol[2] = conf->val_ssTolGair();
+
+    ma_ring.resize(m_window * SRCCOLNUM);
+    ma_winSum.resize(SRCCOLNUM, 0);
+    ma_segSum.resize(SRCCOLNUM, 0);
+}
+
+bool SteadyState::readRow(SrcDataReader &reader, vector<double> &row) {
+
+    while ( reader.readRow(m_sample) ) {
+
+        m_samplesNum++;
+        addSample(m_sample);
+
+        if ( isSteady() ) {
+
+            if ( m_segNum == 0 ) {
+                // segment starts with the whole window
+                ma_segSum = ma_winSum;
+                m_segNum = m_ringNum;
+            }
+            else {
+                for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+                    ma_segSum[j] += m_sample[j];
+                }
+
+                m_segNum++;
+            }
+        }
+        else if ( m_segNum > 0 ) {
+
+            // next segment must not share samples with this one
+            clearWindow();
+            addSample(m_sample);
+
+            if ( closeSegment(row) ) {
+                return true;
+            }
+        }
+    }
+
+    // the last segment is closed by the end of data
+    return closeSegment(row);
+}
+
+void SteadyState::printSummary() const {
+    cout << MSGBLANK << m_pointsNum << " steady-state points found in "
+         << m_samplesNum << " samples.\n";
+}
+
+void SteadyState::addSample(const vector<double> &sample) {
+
+    if ( m_ringNum == 0 ) {
+        // shift of squares sums for numerical stability
+        for ( size_t c=0; c<3; c++ ) {
+            m_shift[c] = sample[detCols[c]];
+        }
+    }
+
+    double *slot = &ma_ring[m_ringPos * SRCCOLNUM];
+
+    if ( m_ringNum == m_window ) {
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            ma_winSum[j] -= slot[j];
+        }
+
+        for ( size_t c=0; c<3; c++ ) {
+            const double d = slot[detCols[c]] - m_shift[c];
+            m_winShSum[c] -= d;
+            m_winSqSum[c] -= d * d;
+        }
+    }
+    else {
+        m_ringNum++;
+    }
+
+    for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+        slot[j] = sample[j];
+        ma_winSum[j] += sample[j];
+    }
+
+    for ( size_t c=0; c<3; c++ ) {
+        const double d = sample[detCols[c]] - m_shift[c];
+        m_winShSum[c] += d;
+        m_winSqSum[c] += d * d;
+    }
+
+    m_ringPos = (m_ringPos + 1) % m_window;
+
+    // rounding errors of running sums are dropped once per window
+    if ( m_ringPos == 0 ) {
+        recalcSums();
+    }
+}
+
+void SteadyState::recalcSums() {
+
+    for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+        ma_winSum[j] = 0;
+    }
+
+    for ( size_t c=0; c<3; c++ ) {
+        m_winShSum[c] = 0;
+        m_winSqSum[c] = 0;
+    }
+
+    for ( size_t k=0; k<m_ringNum; k++ ) {
+
+        const double *slot = &ma_ring[k * SRCCOLNUM];
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            ma_winSum[j] += slot[j];
+        }
+
+        for ( size_t c=0; c<3; c++ ) {
+            const double d = slot[detCols[c]] - m_shift[c];
+            m_winShSum[c] += d;
+            m_winSqSum[c] += d * d;
+        }
+    }
+}
+
+void SteadyState::clearWindow() {
+
+    m_ringPos = 0;
+    m_ringNum = 0;
+
+    recalcSums();
+}
+
+bool SteadyState::isSteady() const {
+
+    if ( m_ringNum < m_window ) {
+        return false;
+    }
+
+    const double num = static_cast<double>(m_ringNum);
+
+    for ( size_t c=0; c<3; c++ ) {
+
+        const double mean = m_winShSum[c] / num;
+        const double var = (m_winSqSum[c] - num * mean * mean) / (num - 1);
+
+        if ( std::sqrt(std::fabs(var)) > m_tol[c] ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SteadyState::closeSegment(vector<double> &row) {
+
+    const size_t segNum = m_segNum;
+    m_segNum = 0;
+
+    if ( segNum < m_minSamples ) {
+        return false;
+    }
+
+    row.resize(SRCCOLNUM);
+
+    for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+        row[j] = ma_segSum[j] / segNum;
+    }
+
+    m_pointsNum++;
+
+    return true;
+}
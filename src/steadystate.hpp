@@ -0,0 +1,80 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: steadystate.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STEADYSTATE_HPP
+#define STEADYSTATE_HPP
+
+#include <vector>
+#include <memory>
+
+#include "configuration.hpp"
+#include "srcdatafilter.hpp"
+
+//
+// Detection of steady-state operating points in raw time series of source
+// data. Rolling standard deviations of n, Me and Gair over ssWindow samples
+// are updated in O(1) per sample. While all of them are within tolerances
+// the samples are averaged, every steady segment gives one source data row.
+//
+
+class SteadyState : public SrcDataFilter {
+
+public:
+
+    SteadyState(const std::shared_ptr<Configuration> &conf);
+
+    bool readRow(SrcDataReader &, std::vector<double> &);
+    void printSummary() const;
+
+private:
+
+    void addSample(const std::vector<double> &);
+    void recalcSums();
+    void clearWindow();
+    bool isSteady() const;
+    bool closeSegment(std::vector<double> &);
+
+    size_t m_window = 0;
+    size_t m_minSamples = 0;
+    double m_tol[3] = {0, 0, 0};
+
+    // ring buffer of last m_window samples, m_window * SRCCOLNUM elements
+    std::vector<double> ma_ring;
+    size_t m_ringPos = 0;
+    size_t m_ringNum = 0;
+
+    // window sums of all columns and shifted sums of squares of n, Me, Gair
+    std::vector<double> ma_winSum;
+    double m_shift[3] = {0, 0, 0};
+    double m_winSqSum[3] = {0, 0, 0};
+    double m_winShSum[3] = {0, 0, 0};
+
+    // sums of current steady segment
+    std::vector<double> ma_segSum;
+    size_t m_segNum = 0;
+
+    std::vector<double> m_sample;
+
+    size_t m_samplesNum = 0;
+    size_t m_pointsNum = 0;
+
+};
+
+#endif // STEADYSTATE_HPP
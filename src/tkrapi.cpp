@@ -0,0 +1,140 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrapi.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tkrapi.h"
+#include "tkrkernel.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+
+static_assert(TKRAPI_SRCCOLNUM == SRCCOLNUM, "Source columns of C interface and calculation differ");
+static_assert(TKRAPI_RESNUM == RESNUM, "Result columns of C interface and calculation differ");
+static_assert(TKRAPI_STATIONNUM == STATIONNUM, "Stations of C interface and calculation differ");
+
+namespace {
+
+// tkr_config of version 1 of the interface ends with pipeNumHpIn
+const size_t CONFIGSIZEV1 = offsetof(tkr_config, pipeNumHpIn) + sizeof(double);
+
+} // namespace
+
+int tkr_version(void) {
+    return TKRAPI_VERSION;
+}
+
+int tkr_config_init(tkr_config *conf) {
+
+    if ( !conf ) {
+        return TKRAPI_EARGUMENT;
+    }
+
+    // defaults are taken from the configuration, so they can not diverge
+    try {
+
+        const Configuration defaults;
+
+        conf->structSize   = sizeof(tkr_config);
+        conf->acType_lp    = static_cast<unsigned>(defaults.val_acType_lp());
+        conf->acType_hp    = static_cast<unsigned>(defaults.val_acType_hp());
+        conf->B0_std       = defaults.val_B0_std();
+        conf->T0_std       = defaults.val_T0_std();
+        conf->Vh           = defaults.val_Vh();
+        conf->sysNum       = defaults.val_sysNum();
+        conf->pipeNumHpOut = defaults.val_pipeNumHpOut();
+        conf->pipeNumHpIn  = defaults.val_pipeNumHpIn();
+
+        for ( size_t st=0; st<STATIONNUM; st++ ) {
+            conf->F[st] = defaults.val_F(st);
+        }
+    }
+    catch ( ... ) {
+        return TKRAPI_EFAILED;
+    }
+
+    return TKRAPI_OK;
+}
+
+const char *tkr_source_caption(size_t col) {
+    return (col < SRCCOLNUM) ? colCaptions[col].c_str() : nullptr;
+}
+
+const char *tkr_result_caption(size_t col) {
+    return (col < RESNUM) ? resCaptions[col].c_str() : nullptr;
+}
+
+int tkr_calculate(const tkr_config *conf, const double *const *src, size_t rows,
+                  double *const *res, uint32_t *invalid) {
+
+    if ( !conf || !src || !res ) {
+        return TKRAPI_EARGUMENT;
+    }
+
+    if ( conf->structSize < CONFIGSIZEV1 ) {
+        return TKRAPI_ESTRUCTSIZE;
+    }
+
+    // members missing in the caller's version have default values
+    tkr_config cfg;
+
+    if ( tkr_config_init(&cfg) != TKRAPI_OK ) {
+        return TKRAPI_EFAILED;
+    }
+
+    std::memcpy(&cfg, conf, std::min(conf->structSize, sizeof(tkr_config)));
+
+    for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+        if ( !src[c] ) {
+            return TKRAPI_EARGUMENT;
+        }
+    }
+
+    const TkrCalcParams params = tkrCalcParams(cfg.acType_lp, cfg.acType_hp, cfg.B0_std, cfg.T0_std,
+                                               cfg.Vh, cfg.F, cfg.sysNum,
+                                               cfg.pipeNumHpOut, cfg.pipeNumHpIn);
+
+    TkrRow<double> r;
+    double v[SRCCOLNUM];
+
+    for ( size_t i=0; i<rows; i++ ) {
+
+        // the whole row is read before results are written, so columns may alias
+        for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+            v[c] = src[c][i];
+        }
+
+        const uint32_t bad = tkrCalculateChecked(r, v, params);
+
+        if ( invalid ) {
+            invalid[i] = bad;
+        }
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            if ( res[k] ) {
+                res[k][i] = tkrResult(r, k);
+            }
+        }
+    }
+
+    return TKRAPI_OK;
+}
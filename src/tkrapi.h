@@ -0,0 +1,113 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrapi.h
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * C interface of the calculation for programs which can not use C++.
+ *
+ * Source data and results are columns in buffers owned by the caller:
+ * src[c][i] is the value of source column c (order of colCaptions) in row
+ * i, res[k][i] is the value of result k (order of resCaptions). The
+ * calculation writes results directly into the result columns, it does
+ * not copy source data and does not allocate memory. Functions keep no
+ * state between calls, so concurrent calls on separate buffers are safe.
+ *
+ * Rows with invalid source data and results which depend on stations
+ * without measurements (zero gauge pressure and temperature) are NaN,
+ * as in the calculation report.
+ */
+
+#ifndef TKRAPI_H
+#define TKRAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#   if defined(TKRAPI_BUILD)
+#       define TKRAPI __declspec(dllexport)
+#   else
+#       define TKRAPI __declspec(dllimport)
+#   endif
+#else
+#   define TKRAPI __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* version of the interface, changes only with incompatible changes */
+#define TKRAPI_VERSION 1
+
+#define TKRAPI_SRCCOLNUM  23 /* source data columns */
+#define TKRAPI_RESNUM     28 /* result columns */
+#define TKRAPI_STATIONNUM 8  /* measurement points */
+
+/* return codes */
+#define TKRAPI_OK          0
+#define TKRAPI_EARGUMENT   1 /* null pointer of a required argument */
+#define TKRAPI_ESTRUCTSIZE 2 /* tkr_config smaller than in version 1 of the interface */
+#define TKRAPI_EFAILED     3 /* internal error */
+
+/*
+ * Calculation parameters of the configuration file, names and units are
+ * the same. New members are added only to the end, structSize tells the
+ * library which version of the structure the caller has: members the
+ * caller does not have get default values, members the library does not
+ * know are ignored.
+ */
+typedef struct tkr_config {
+    size_t structSize;              /* sizeof(tkr_config), set by tkr_config_init */
+    unsigned acType_lp;             /* aftercooler type: 0 - air-air, 1 - coolant-air */
+    unsigned acType_hp;
+    double B0_std;                  /* kPa */
+    double T0_std;                  /* degC */
+    double Vh;                      /* engine displacement, m3 */
+    double F[TKRAPI_STATIONNUM];    /* sectional areas in measurement points, m2 */
+    double sysNum;                  /* number of charging systems on the engine */
+    double pipeNumHpOut;            /* number of hp out pipes */
+    double pipeNumHpIn;             /* number of hp in pipes */
+} tkr_config;
+
+/* TKRAPI_VERSION of the library */
+TKRAPI int tkr_version(void);
+
+/* fills configuration with default values of the configuration file */
+TKRAPI int tkr_config_init(tkr_config *conf);
+
+/* captions of columns as in reports, NULL for wrong column */
+TKRAPI const char *tkr_source_caption(size_t col);
+TKRAPI const char *tkr_result_caption(size_t col);
+
+/*
+ * Calculates rows of source data columns src[TKRAPI_SRCCOLNUM] into result
+ * columns res[TKRAPI_RESNUM]. Null result columns are not written. A
+ * result column may be the same buffer as a source column. If invalid is
+ * not null, invalid[i] receives bits (1 << c) of invalid source columns c
+ * of row i, 0 for valid rows.
+ */
+TKRAPI int tkr_calculate(const tkr_config *conf, const double *const *src, size_t rows,
+                         double *const *res, uint32_t *invalid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TKRAPI_H */
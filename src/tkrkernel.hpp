@@ -0,0 +1,481 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrkernel.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TKRKERNEL_HPP
+#define TKRKERNEL_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cfloat>
+#include <limits>
+
+#include "constants.hpp"
+
+//
+// Calculation of one source data row. All functions are templates on the
+// scalar type, so the same formulas work with double and with dual numbers.
+//
+
+struct TkrCalcParams {
+    size_t acType_lp;
+    size_t acType_hp;
+    double B0_std;
+    double T0_std;
+    double Vh;
+    double F[STATIONNUM];     // sectional areas in measurement points
+    double pipes[STATIONNUM]; // numbers of pipes in measurement points
+    double sysNum;
+};
+
+// Parameters from values of the configuration file, used by Configuration
+// and by the C interface. Pipes of the high pressure stage are counted in
+// its measurement points, other points have one pipe.
+inline TkrCalcParams tkrCalcParams(size_t acType_lp, size_t acType_hp, double B0_std, double T0_std,
+                                   double Vh, const double *F, double sysNum,
+                                   double pipeNumHpOut, double pipeNumHpIn) {
+
+    TkrCalcParams p;
+
+    p.acType_lp = acType_lp;
+    p.acType_hp = acType_hp;
+    p.B0_std    = B0_std;
+    p.T0_std    = T0_std;
+    p.Vh        = Vh;
+    p.sysNum    = sysNum;
+
+    for ( size_t st=0; st<STATIONNUM; st++ ) {
+        p.F[st] = F[st];
+        p.pipes[st] = 1.0;
+    }
+
+    p.pipes[ST_PK_HP]  = pipeNumHpOut;
+    p.pipes[ST_PKS_HP] = pipeNumHpOut;
+    p.pipes[ST_PT_HP]  = pipeNumHpIn;
+
+    return p;
+}
+
+template<typename T>
+struct TkrRow {
+
+    T n;
+    T Me;
+    T Ne;
+    T Gfuel;
+    T Gair;
+    T B0;
+    T Tcool;
+
+    // station-indexed blocks
+    T st_P[STATIONNUM];
+    T st_T[STATIONNUM];
+
+    T B0_r;
+    T Tcool_r;
+
+    T st_P_r[STATIONNUM];
+    T st_T_r[STATIONNUM];
+
+    T G_real[2]; // mass flow of air and exhaust gas
+
+    T st_Y[STATIONNUM];
+    T st_Lambda[STATIONNUM];
+    T st_Pi[STATIONNUM];
+    T st_P_dyn[STATIONNUM];
+
+    T nuv;
+    T E1;
+    T E2;
+
+    T Gair_lp_r;
+    T Gair_hp_r;
+    T Pik_lp;
+    T Pik_hp;
+    T nuad_lp;
+    T nuad_hp;
+    T Ncomp_lp;
+    T Ncomp_hp;
+
+    T Gexh_lp_r;
+    T Gexh_hp_r;
+    T Pit_lp;
+    T Pit_hp;
+    T Tr_calc_lp;
+    T phi_lp;
+    T Tr_calc_hp;
+    T phi_hp;
+    T Nt_dis_lp;
+    T Nt_dis_hp;
+    T nute_lp;
+    T nute_hp;
+    T Cad_lp;
+    T rhog_lp;
+    T muft_lp;
+    T Cad_hp;
+    T rhog_hp;
+    T muft_hp;
+    T Ft_lp = 0;
+    T Ft_hp = 0;
+
+    T nutkr_lp;
+    T nutkr_hp;
+    T nusys;
+};
+
+// order of source values corresponds to colCaptions
+template<typename T, typename S>
+void tkrSetSource(TkrRow<T> &r, const S *v) {
+
+    r.n     = v[0];
+    r.Me    = v[1];
+    r.Ne    = v[2];
+    r.Gfuel = v[3];
+    r.Gair  = v[4];
+    r.B0    = v[5];
+    r.Tcool = v[22];
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        r.st_P[s] = v[STPCOL + s];
+        r.st_T[s] = v[STTCOL + s];
+    }
+}
+
+// order of results corresponds to resCaptions
+template<typename T>
+const T &tkrResult(const TkrRow<T> &r, size_t col) {
+
+    static T TkrRow<T>::* const cols[] = {
+        &TkrRow<T>::nuv,
+        &TkrRow<T>::E1,
+        &TkrRow<T>::E2,
+        &TkrRow<T>::Gair_lp_r,
+        &TkrRow<T>::Pik_lp,
+        &TkrRow<T>::nuad_lp,
+        &TkrRow<T>::Ncomp_lp,
+        &TkrRow<T>::Gexh_lp_r,
+        &TkrRow<T>::Pit_lp,
+        &TkrRow<T>::nute_lp,
+        &TkrRow<T>::muft_lp,
+        &TkrRow<T>::Nt_dis_lp,
+        &TkrRow<T>::phi_lp,
+        &TkrRow<T>::Ft_lp,
+        &TkrRow<T>::Gair_hp_r,
+        &TkrRow<T>::Pik_hp,
+        &TkrRow<T>::nuad_hp,
+        &TkrRow<T>::Ncomp_hp,
+        &TkrRow<T>::Gexh_hp_r,
+        &TkrRow<T>::Pit_hp,
+        &TkrRow<T>::nute_hp,
+        &TkrRow<T>::muft_hp,
+        &TkrRow<T>::Nt_dis_hp,
+        &TkrRow<T>::phi_hp,
+        &TkrRow<T>::Ft_hp,
+        &TkrRow<T>::nutkr_lp,
+        &TkrRow<T>::nutkr_hp,
+        &TkrRow<T>::nusys
+    };
+
+    return r.*cols[col];
+}
+
+template<typename T>
+T &tkrResult(TkrRow<T> &r, size_t col) {
+    return const_cast<T &>(tkrResult(static_cast<const TkrRow<T> &>(r), col));
+}
+
+template<typename T>
+void tkrPreCalculate(TkrRow<T> &r) {
+
+    r.B0_r = r.B0 * 100.0;
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        r.st_P_r[s] = r.st_P[s] * stationPUnit[s] + r.B0_r;
+        r.st_T_r[s] = r.st_T[s] + 273.0;
+    }
+
+    // not measured stations of the low pressure stage (single stage engines):
+    // the high pressure compressor takes in ambient air (B0, T0) and the high
+    // pressure turbine discharges into the Pr station
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        if ( (STBIT(s) & STLPSTAGE) && (r.st_P[s] == 0) && (r.st_T[s] == 0) ) {
+            if ( s == ST_PT_LP ) {
+                r.st_P_r[s] = r.st_P_r[ST_PR];
+                r.st_T_r[s] = r.st_T_r[ST_PR];
+            }
+            else {
+                r.st_T_r[s] = r.st_T_r[ST_S];
+            }
+        }
+    }
+
+    r.Tcool_r = r.Tcool + 273.0;
+}
+
+// Bits (1 << c) of invalid source columns c of one row, the same checks as
+// TkrSourceData::validate does for columns. Source values v and absolute
+// pressures and temperatures of the row must be set.
+inline uint32_t tkrInvalidColumns(const double *v, const TkrRow<double> &r) {
+
+    uint32_t invalid = 0;
+
+    for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+
+        const double x = v[c];
+        const uint32_t ok = (x >= srcColMin[c]) & (x <= srcColMax[c]) & ((x == 0) | (std::fabs(x) >= DBL_MIN));
+
+        invalid |= (uint32_t(1) << c) & (ok - 1);
+    }
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+
+        const uint32_t pok = r.st_P_r[s] > 0;
+        const uint32_t tok = r.st_T_r[s] > 0;
+
+        invalid |= ((uint32_t(1) << (STPCOL + s)) & (pok - 1)) | ((uint32_t(1) << (STTCOL + s)) & (tok - 1));
+    }
+
+    return invalid;
+}
+
+// bits (1 << s) of stations without measurements: zero gauge pressure and temperature
+inline unsigned tkrAbsentStations(const TkrRow<double> &r) {
+
+    unsigned absent = 0;
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        absent |= static_cast<unsigned>((r.st_P[s] == 0) & (r.st_T[s] == 0)) << s;
+    }
+
+    return absent;
+}
+
+template<typename T>
+T tkrMuPit2(const T &Ft) {
+
+    using std::pow;
+
+    if ( Ft < 5.0 ) {
+        return T(0.895);
+    }
+    else if ( (Ft >= 5.0) && (Ft <= 55.0) ) {
+        return 0.87503 + 0.0250807 * Ft
+            - 0.00546323        * pow(Ft, 2)
+            + 0.000278903       * pow(Ft, 3)
+            - 0.00000655348     * pow(Ft, 4)
+            + 0.0000000737792   * pow(Ft, 5)
+            - 0.000000000320939 * pow(Ft, 6);
+    }
+    else {
+        return T(0.410);
+    }
+}
+
+template<typename T>
+T tkrFt(const T &muft, const T &Pit) {
+
+    using std::log;
+    using std::fabs;
+
+    T Ft = 0;
+    T tmp_Ft = 5.0;
+    size_t iter = 0;
+
+    while ( 1 ) {
+
+        if ( iter > MAXITER ) {
+            break;
+        }
+
+        T tmp_Ft_1 = muft / (0.421189 * log(Pit) + 0.707889) / tkrMuPit2(tmp_Ft);
+        tmp_Ft = tmp_Ft_1;
+        T tmp_Ft_2 = muft / (0.421189 * log(Pit) + 0.707889) / tkrMuPit2(tmp_Ft);
+        tmp_Ft = tmp_Ft_2;
+
+        if ( fabs(tmp_Ft_1 - tmp_Ft_2) <= FTDEFACCUR ) {
+            Ft = tmp_Ft_2;
+            break;
+        }
+
+        iter++;
+    }
+
+    return Ft;
+}
+
+template<typename T>
+void tkrCalculate(TkrRow<T> &r, const TkrCalcParams &p) {
+
+    using std::sqrt;
+    using std::pow;
+
+    r.G_real[GAS_AIR] = r.Gair / 3600.0;
+    r.G_real[GAS_EXH] = (r.Gair + r.Gfuel / p.sysNum) / 3600;
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+
+        const GasConstants &g = gasConstants[stationGas[s]];
+
+        r.st_Y[s] = r.G_real[stationGas[s]] * sqrt(r.st_T_r[s]) / (r.st_P_r[s] * p.F[s] * p.pipes[s] * g.m);
+        r.st_Lambda[s] = (sqrt(4.0 * g.beta * pow(r.st_Y[s], 2.0) + pow(g.lambda, 2.0)) - g.lambda) / (2.0 * g.beta * r.st_Y[s]);
+        r.st_Pi[s] = pow(1 - g.beta * pow(r.st_Lambda[s], 2), g.kexp);
+        r.st_P_dyn[s] = r.st_P_r[s] / r.st_Pi[s];
+    }
+
+    // high pressure turbine outlet of a single stage engine is the Pr station
+    if ( (r.st_P[ST_PT_LP] == 0) && (r.st_T[ST_PT_LP] == 0) ) {
+        r.st_Y[ST_PT_LP]      = r.st_Y[ST_PR];
+        r.st_Lambda[ST_PT_LP] = r.st_Lambda[ST_PR];
+        r.st_Pi[ST_PT_LP]     = r.st_Pi[ST_PR];
+        r.st_P_dyn[ST_PT_LP]  = r.st_P_dyn[ST_PR];
+    }
+
+    const T &Gair_real = r.G_real[GAS_AIR];
+    const T &Gexh_real = r.G_real[GAS_EXH];
+
+    const T &T0_r     = r.st_T_r[ST_S];
+    const T &Tk_lp_r  = r.st_T_r[ST_PK_LP];
+    const T &Tks_lp_r = r.st_T_r[ST_PKS_LP];
+    const T &Tk_hp_r  = r.st_T_r[ST_PK_HP];
+    const T &Tks_hp_r = r.st_T_r[ST_PKS_HP];
+    const T &Tt_hp_r  = r.st_T_r[ST_PT_HP];
+    const T &Tt_lp_r  = r.st_T_r[ST_PT_LP];
+    const T &Tr_r     = r.st_T_r[ST_PR];
+
+    r.nuv = 0.12 * Gair_real * 288.294 * Tks_hp_r / (p.Vh / p.sysNum * r.n * r.st_P_dyn[ST_PKS_HP]);
+
+    if ( p.acType_lp == ACTYPE_AIRAIR ) {
+        if ( T0_r < 303.0 ) {
+            r.E1 = (Tk_lp_r - Tks_lp_r) / (Tk_lp_r - 298.0);
+        }
+        else {
+            r.E1 = (Tk_lp_r - Tks_lp_r) / (Tk_lp_r - T0_r);
+        }
+    }
+    else {
+        r.E1 = (Tk_lp_r - Tks_lp_r) / (Tk_lp_r - r.Tcool_r);
+    }
+
+    if ( r.E1 > 1.0 ) {
+        r.E1 = 1.0;
+    }
+
+    if ( (Tk_lp_r < Tks_lp_r) && (r.E1 > 0) ) {
+        r.E1 *= -1.0;
+    }
+
+    if ( p.acType_hp == ACTYPE_AIRAIR ) {
+        if ( T0_r < 303.0 ) {
+            r.E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - 298.0);
+        }
+        else {
+            r.E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - T0_r);
+        }
+    }
+    else {
+        r.E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - r.Tcool_r);
+    }
+
+    if ( r.E2 > 1.0 ) {
+        r.E2 = 1.0;
+    }
+
+    if ( (Tk_hp_r < Tks_hp_r) && (r.E2 > 0) ) {
+        r.E2 *= -1.0;
+    }
+
+    r.Gair_lp_r = Gair_real * p.B0_std / r.st_P_dyn[ST_S] * pow(T0_r / (p.T0_std + 273), 0.5);
+    r.Gair_hp_r = Gair_real * p.B0_std / r.st_P_dyn[ST_PKS_LP] * pow(Tks_lp_r / (p.T0_std + 273), 0.5);
+    r.Pik_lp = r.st_P_dyn[ST_PK_LP] / r.st_P_dyn[ST_S];
+    r.Pik_hp = r.st_P_dyn[ST_PK_HP] / r.st_P_dyn[ST_PKS_LP];
+    r.nuad_lp = T0_r * (pow(r.Pik_lp, 0.2857) - 1) / (Tk_lp_r - T0_r);
+    r.nuad_hp = Tks_lp_r * (pow(r.Pik_hp, 0.2857) - 1) / (Tk_hp_r - Tks_lp_r);
+    r.Ncomp_lp = Gair_real * 1.009 * T0_r * (pow(r.Pik_lp, 0.2857) - 1);
+    r.Ncomp_hp = Gair_real * 1.009 * Tks_lp_r * (pow(r.Pik_hp, 0.2857) - 1);
+
+    r.Pit_lp = r.st_P_dyn[ST_PT_LP] / r.st_P_dyn[ST_PR];
+    r.Pit_hp = r.st_P_dyn[ST_PT_HP] / r.st_P_dyn[ST_PT_LP];
+    r.Tr_calc_lp = (Tt_lp_r) / pow(r.Pit_lp, 0.2593);
+    r.phi_lp = (Tr_r - r.Tr_calc_lp) / (Tt_lp_r - r.Tr_calc_lp);
+    if ( r.phi_lp <= 0.04 ) {
+        r.phi_lp = 0;
+    }
+    r.Tr_calc_hp = (Tt_hp_r) / pow(r.Pit_hp, 0.2593);
+    r.phi_hp = (Tt_lp_r - r.Tr_calc_hp) / (Tt_hp_r - r.Tr_calc_hp);
+    if ( r.phi_hp <= 0.04 ) {
+        r.phi_hp = 0;
+    }
+    r.Gexh_lp_r = Gexh_real * pow(Tt_lp_r, 0.5) / r.st_P_dyn[ST_PT_LP] * (1 - r.phi_lp);
+    r.Gexh_hp_r = Gexh_real * pow(Tt_hp_r, 0.5) / r.st_P_dyn[ST_PT_HP] * (1 - r.phi_hp);
+    r.Nt_dis_lp = Gexh_real * (1 - r.phi_lp) * 1.10892 * Tt_lp_r * (1 - 1 / pow(r.Pit_lp, 0.2593));
+    r.Nt_dis_hp = Gexh_real * (1 - r.phi_hp) * 1.10892 * Tt_hp_r * (1 - 1 / pow(r.Pit_hp, 0.2593));
+    r.nute_lp = (r.Ncomp_lp * 0.95) / (r.Nt_dis_lp * r.nuad_lp);
+    r.nute_hp = (r.Ncomp_hp * 0.95) / (r.Nt_dis_hp * r.nuad_hp);
+    r.Cad_lp = pow(2000 * r.Nt_dis_lp / Gexh_real / (1 - r.phi_lp), 0.5);
+    r.rhog_lp = r.st_P_r[ST_PR] * 1000.0 / 287.497 / Tr_r;
+    r.muft_lp = Gexh_real * (1 - r.phi_lp) / r.rhog_lp / r.Cad_lp * 10000.0;
+    r.Cad_hp = pow(2000 * r.Nt_dis_hp / Gexh_real / (1 - r.phi_hp), 0.5);
+    r.rhog_hp = r.st_P_r[ST_PT_LP] * 1000.0 / 287.497 / Tt_lp_r;
+    r.muft_hp = Gexh_real * (1 - r.phi_hp) / r.rhog_hp / r.Cad_hp * 10000.0;
+
+    r.Ft_lp = tkrFt(r.muft_lp, r.Pit_lp);
+    r.Ft_hp = tkrFt(r.muft_hp, r.Pit_hp);
+
+    r.nutkr_lp = r.nuad_lp * r.nute_lp;
+    r.nutkr_hp = r.nuad_hp * r.nute_hp;
+
+    r.nusys = r.nutkr_lp * r.nutkr_hp;
+}
+
+// Calculation of one row of source values v with validation: results of
+// invalid row and results which depend on absent stations are NaN.
+// Returns bits of invalid source columns.
+inline uint32_t tkrCalculateChecked(TkrRow<double> &r, const double *v, const TkrCalcParams &p) noexcept {
+
+    const double masked = std::numeric_limits<double>::quiet_NaN();
+
+    tkrSetSource(r, v);
+    tkrPreCalculate(r);
+
+    const uint32_t invalid = tkrInvalidColumns(v, r);
+
+    if ( invalid != 0 ) {
+
+        for ( size_t k=0; k<RESNUM; k++ ) {
+            tkrResult(r, k) = masked;
+        }
+
+        return invalid;
+    }
+
+    const unsigned absent = tkrAbsentStations(r);
+
+    tkrCalculate(r, p);
+
+    for ( size_t k=0; (absent != 0) && (k < RESNUM); k++ ) {
+        if ( resStations[k] & absent ) {
+            tkrResult(r, k) = masked;
+        }
+    }
+
+    return 0;
+}
+
+#endif // TKRKERNEL_HPP
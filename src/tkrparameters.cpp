@@ -23,27 +23,71 @@
 #include "configuration.hpp"
 #include "auxfunctions.hpp"
 #include "identification.hpp"
+#include "compression.hpp"
+#include "tkrkernel.hpp"
+#include "trace.hpp"
 
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
 #include <cmath>
-#include <fstream>
-#include <ctime>
-#include <iomanip>
-
-#define BOOST_NO_CXX11_SCOPED_ENUMS
-
-#include <boost/lexical_cast.hpp>
+#include <ostream>
+#include <limits>
 
 using std::cout;
 using std::string;
 using std::vector;
 using std::shared_ptr;
-using std::ofstream;
-using std::setprecision;
-using std::fixed;
+using std::ostream;
+
+namespace {
+
+// values of masked rows and results are NaN, they are written as empty cells
+const double MASKED = std::numeric_limits<double>::quiet_NaN();
+
+TkrRow<double> maskedRow() {
+
+    TkrRow<double> r;
+
+    r.G_real[GAS_AIR] = MASKED;
+    r.G_real[GAS_EXH] = MASKED;
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        r.st_Y[s]      = MASKED;
+        r.st_Lambda[s] = MASKED;
+        r.st_Pi[s]     = MASKED;
+        r.st_P_dyn[s]  = MASKED;
+    }
+
+    r.Tr_calc_lp = MASKED;
+    r.Tr_calc_hp = MASKED;
+    r.Cad_lp     = MASKED;
+    r.rhog_lp    = MASKED;
+    r.Cad_hp     = MASKED;
+    r.rhog_hp    = MASKED;
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        tkrResult(r, k) = MASKED;
+    }
+
+    return r;
+}
+
+void maskAbsentStations(TkrRow<double> &r, unsigned absent) {
+
+    if ( absent == 0 ) {
+        return;
+    }
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        if ( resStations[k] & absent ) {
+            tkrResult(r, k) = MASKED;
+        }
+    }
+}
+
+} // namespace
 
 TkrParameters::TkrParameters(const shared_ptr<Configuration> &cfg) {
     m_conf = cfg;
@@ -55,125 +99,80 @@ bool TkrParameters::calculate(const vector< vector<double> > &v) {
         return false;
     }
 
-    prepareArrays(v);
-    preCalculate();
+    // own source data object is reused by next calls
+    if ( !m_ownSrc ) {
+        m_ownSrc.reset(new TkrSourceData());
+    }
+
+    m_ownSrc->calculate(v);
+    m_src = m_ownSrc;
+
+    prepareArrays();
     doCalculate();
 
     return true;
 }
 
-void TkrParameters::prepareArrays(const vector< vector<double> > &v) {
-
-    m_n = v.size();
-
-    ma_n.resize(m_n);
-    ma_Me.resize(m_n);
-    ma_Ne.resize(m_n);
-    ma_Gfuel.resize(m_n);
-    ma_Gair.resize(m_n);
-    ma_B0.resize(m_n);
-    ma_S.resize(m_n);
-    ma_Pk_lp.resize(m_n);
-    ma_Pks_lp.resize(m_n);
-    ma_Pk_hp.resize(m_n);
-    ma_Pks_hp.resize(m_n);
-    ma_Pt_hp.resize(m_n);
-    ma_Pt_lp.resize(m_n);
-    ma_Pr.resize(m_n);
-    ma_T0.resize(m_n);
-    ma_Tk_lp.resize(m_n);
-    ma_Tks_lp.resize(m_n);
-    ma_Tk_hp.resize(m_n);
-    ma_Tks_hp.resize(m_n);
-    ma_Tt_hp.resize(m_n);
-    ma_Tt_lp.resize(m_n);
-    ma_Tr.resize(m_n);
-    ma_Tcool.resize(m_n);
-
-    for ( size_t i=0; i<v.size(); i++ ) {
-
-        ma_n     [i] = v[i][0];
-        ma_Me    [i] = v[i][1];
-        ma_Ne    [i] = v[i][2];
-        ma_Gfuel [i] = v[i][3];
-        ma_Gair  [i] = v[i][4];
-        ma_B0    [i] = v[i][5];
-        ma_S     [i] = v[i][6];
-        ma_Pk_lp [i] = v[i][7];
-        ma_Pks_lp[i] = v[i][8];
-        ma_Pk_hp [i] = v[i][9];
-        ma_Pks_hp[i] = v[i][10];
-        ma_Pt_hp [i] = v[i][11];
-        ma_Pt_lp [i] = v[i][12];
-        ma_Pr    [i] = v[i][13];
-        ma_T0    [i] = v[i][14];
-        ma_Tk_lp [i] = v[i][15];
-        ma_Tks_lp[i] = v[i][16];
-        ma_Tk_hp [i] = v[i][17];
-        ma_Tks_hp[i] = v[i][18];
-        ma_Tt_hp [i] = v[i][19];
-        ma_Tt_lp [i] = v[i][20];
-        ma_Tr    [i] = v[i][21];
-        ma_Tcool [i] = v[i][22];
+bool TkrParameters::calculate(const vector< shared_ptr<TkrParameters> > &profiles,
+                              const shared_ptr<const TkrSourceData> &src) {
+
+    if ( profiles.empty() || (src->val_rowsNum() == 0) ) {
+        return false;
     }
 
-    ma_B0_r.resize(m_n);
-    ma_S_r.resize(m_n);
-    ma_Pk_lp_r.resize(m_n);
-    ma_Pks_lp_r.resize(m_n);
-    ma_Pk_hp_r.resize(m_n);
-    ma_Pks_hp_r.resize(m_n);
-    ma_Pt_hp_r.resize(m_n);
-    ma_Pt_lp_r.resize(m_n);
-    ma_Pr_r.resize(m_n);
-    ma_T0_r.resize(m_n);
-    ma_Tk_lp_r.resize(m_n);
-    ma_Tks_lp_r.resize(m_n);
-    ma_Tk_hp_r.resize(m_n);
-    ma_Tks_hp_r.resize(m_n);
-    ma_Tt_hp_r.resize(m_n);
-    ma_Tt_lp_r.resize(m_n);
-    ma_Tr_r.resize(m_n);
-    ma_Tcool_r.resize(m_n);
+    TRACESCOPE("calculate profiles");
+
+    vector<TkrCalcParams> params;
+
+    for ( size_t p=0; p<profiles.size(); p++ ) {
+
+        profiles[p]->m_src = src;
+        profiles[p]->prepareArrays();
+
+        params.push_back(profiles[p]->m_conf->val_calcParams());
+    }
+
+    // one pass over source data, every row is calculated for all profiles
+    TkrRow<double> srcrow;
+    const TkrRow<double> masked = maskedRow();
+
+    for ( size_t i=0; i<src->val_rowsNum(); i++ ) {
+
+        if ( src->isMasked(i) ) {
+
+            for ( size_t p=0; p<profiles.size(); p++ ) {
+                profiles[p]->storeRow(i, masked);
+            }
+
+            continue;
+        }
+
+        src->loadRow(i, srcrow);
+
+        for ( size_t p=0; p<profiles.size(); p++ ) {
+
+            TkrRow<double> r = srcrow;
+
+            tkrCalculate(r, params[p]);
+            maskAbsentStations(r, src->val_absentStations(i));
+            profiles[p]->storeRow(i, r);
+        }
+    }
+
+    return true;
+}
+
+void TkrParameters::prepareArrays() {
+
+    m_n = m_src->val_rowsNum();
 
     ma_Gair_real.resize(m_n);
     ma_Gexh_real.resize(m_n);
 
-    ma_Y_S_r.resize(m_n);
-    ma_Y_Pk_lp_r.resize(m_n);
-    ma_Y_Pks_lp_r.resize(m_n);
-    ma_Y_Pk_hp_r.resize(m_n);
-    ma_Y_Pks_hp_r.resize(m_n);
-    ma_Y_Pt_hp_r.resize(m_n);
-    ma_Y_Pt_lp_r.resize(m_n);
-    ma_Y_Pr_r.resize(m_n);
-
-    ma_Lambda_S_r.resize(m_n);
-    ma_Lambda_Pk_lp_r.resize(m_n);
-    ma_Lambda_Pks_lp_r.resize(m_n);
-    ma_Lambda_Pk_hp_r.resize(m_n);
-    ma_Lambda_Pks_hp_r.resize(m_n);
-    ma_Lambda_Pt_hp_r.resize(m_n);
-    ma_Lambda_Pt_lp_r.resize(m_n);
-    ma_Lambda_Pr_r.resize(m_n);
-
-    ma_Pi_S_r.resize(m_n);
-    ma_Pi_Pk_lp_r.resize(m_n);
-    ma_Pi_Pks_lp_r.resize(m_n);
-    ma_Pi_Pk_hp_r.resize(m_n);
-    ma_Pi_Pks_hp_r.resize(m_n);
-    ma_Pi_Pt_hp_r.resize(m_n);
-    ma_Pi_Pt_lp_r.resize(m_n);
-    ma_Pi_Pr_r.resize(m_n);
-
-    ma_S_r_dyn.resize(m_n);
-    ma_Pk_lp_r_dyn.resize(m_n);
-    ma_Pks_lp_r_dyn.resize(m_n);
-    ma_Pk_hp_r_dyn.resize(m_n);
-    ma_Pks_hp_r_dyn.resize(m_n);
-    ma_Pt_hp_r_dyn.resize(m_n);
-    ma_Pt_lp_r_dyn.resize(m_n);
-    ma_Pr_r_dyn.resize(m_n);
+    ma_st_Y.resize(m_n * STATIONNUM);
+    ma_st_Lambda.resize(m_n * STATIONNUM);
+    ma_st_Pi.resize(m_n * STATIONNUM);
+    ma_st_P_dyn.resize(m_n * STATIONNUM);
 
     ma_nuv.resize(m_n);
     ma_E1.resize(m_n);
@@ -214,265 +213,170 @@ void TkrParameters::prepareArrays(const vector< vector<double> > &v) {
     ma_nusys.resize(m_n);
 }
 
-void TkrParameters::preCalculate() {
-
-    for ( size_t i=0; i<m_n; i++ ) {
-
-        ma_B0_r    [i] = ma_B0    [i] * 100.0;
-        ma_S_r     [i] = ma_S     [i] + ma_B0_r[i];
-        ma_Pk_lp_r [i] = ma_Pk_lp [i] * 100.0 + ma_B0_r[i];
-        ma_Pks_lp_r[i] = ma_Pks_lp[i] * 100.0 + ma_B0_r[i];
-        ma_Pk_hp_r [i] = ma_Pk_hp [i] * 100.0 + ma_B0_r[i];
-        ma_Pks_hp_r[i] = ma_Pks_hp[i] * 100.0 + ma_B0_r[i];
-        ma_Pt_hp_r [i] = ma_Pt_hp [i] * 100.0 + ma_B0_r[i];
-        ma_Pt_lp_r [i] = ma_Pt_lp [i] * 100.0 + ma_B0_r[i];
-        ma_Pr_r    [i] = ma_Pr    [i] + ma_B0_r[i];
-        ma_T0_r    [i] = ma_T0    [i] + 273.0;
-        ma_Tk_lp_r [i] = ma_Tk_lp [i] + 273.0;
-        ma_Tks_lp_r[i] = ma_Tks_lp[i] + 273.0;
-        ma_Tk_hp_r [i] = ma_Tk_hp [i] + 273.0;
-        ma_Tks_hp_r[i] = ma_Tks_hp[i] + 273.0;
-        ma_Tt_hp_r [i] = ma_Tt_hp [i] + 273.0;
-        ma_Tt_lp_r [i] = ma_Tt_lp [i] + 273.0;
-        ma_Tr_r    [i] = ma_Tr    [i] + 273.0;
-        ma_Tcool_r [i] = ma_Tcool [i] + 273.0;
-    }
-}
-
 void TkrParameters::doCalculate() {
 
-    for ( size_t i=0; i<m_n; i++ ) {
-
-        ma_Gair_real[i] = ma_Gair[i] / 3600.0;
-
-        ma_Y_S_r[i] = ma_Gair_real[i] * sqrt(ma_T0_r[i]) / (ma_S_r[i] * m_conf->val_F1_S() * 20.317);
-        ma_Y_Pk_lp_r[i] = ma_Gair_real[i] * sqrt(ma_Tk_lp_r[i]) / (ma_Pk_lp_r[i] * m_conf->val_F2_Pklp() * 20.317);
-        ma_Y_Pks_lp_r[i] = ma_Gair_real[i] * sqrt(ma_Tks_lp_r[i]) / (ma_Pks_lp_r[i] * m_conf->val_F3_Pkslp() * 20.317);
-        ma_Y_Pk_hp_r[i] = ma_Gair_real[i] * sqrt(ma_Tk_hp_r[i]) / (ma_Pk_hp_r[i] * m_conf->val_F4_Pkhp() * m_conf->val_pipeNumHpOut() * 20.317);
-        ma_Y_Pks_hp_r[i] = ma_Gair_real[i] * sqrt(ma_Tks_hp_r[i]) / (ma_Pks_hp_r[i] * m_conf->val_F5_Pkshp() * m_conf->val_pipeNumHpOut() * 20.317);
-
-        ma_Gexh_real[i] = (ma_Gair[i] + ma_Gfuel[i] / m_conf->val_sysNum()) / 3600;
-
-        ma_Y_Pt_hp_r[i] = ma_Gexh_real[i] * sqrt(ma_Tt_hp_r[i]) / (ma_Pt_hp_r[i] * m_conf->val_F6_Pthp() * m_conf->val_pipeNumHpIn() * 25.639);
-        ma_Y_Pt_lp_r[i] = ma_Gexh_real[i] * sqrt(ma_Tt_lp_r[i]) / (ma_Pt_lp_r[i] * m_conf->val_F7_Ptlp() * 25.639);
-        ma_Y_Pr_r[i] = ma_Gexh_real[i] * sqrt(ma_Tr_r[i]) / (ma_Pr_r[i] * m_conf->val_F8_Pr() * 25.639);
-
-        ma_Lambda_S_r[i] = (sqrt(4.0 * 0.16667 * pow(ma_Y_S_r[i], 2.0) + pow(1.57744, 2.0)) - 1.57744) / (2.0 * 0.16667 * ma_Y_S_r[i]);
-        ma_Lambda_Pk_lp_r[i] = (sqrt(4.0 * 0.16667 * pow(ma_Y_Pk_lp_r[i], 2.0) + pow(1.57744, 2.0)) - 1.57744) / (2.0 * 0.16667 * ma_Y_Pk_lp_r[i]);
-        ma_Lambda_Pks_lp_r[i] = (sqrt(4.0 * 0.16667 * pow(ma_Y_Pks_lp_r[i], 2.0) + pow(1.57744, 2.0)) - 1.57744) / (2.0 * 0.16667 * ma_Y_Pks_lp_r[i]);
-        ma_Lambda_Pk_hp_r[i] = (sqrt(4.0 * 0.16667 * pow(ma_Y_Pk_hp_r[i], 2.0) + pow(1.57744, 2.0)) - 1.57744) / (2.0 * 0.16667 * ma_Y_Pk_hp_r[i]);
-        ma_Lambda_Pks_hp_r[i] = (sqrt(4.0 * 0.16667 * pow(ma_Y_Pks_hp_r[i], 2.0) + pow(1.57744, 2.0)) - 1.57744) / (2.0 * 0.16667 * ma_Y_Pks_hp_r[i]);
-
-        ma_Lambda_Pt_hp_r[i] = (sqrt(4.0 * 0.14894 * pow(ma_Y_Pt_hp_r[i], 2.0) + pow(1.58529, 2.0)) - 1.58529) / (2.0 * 0.14894 * ma_Y_Pt_hp_r[i]);
-        ma_Lambda_Pt_lp_r[i] = (sqrt(4.0 * 0.14894 * pow(ma_Y_Pt_lp_r[i], 2.0) + pow(1.58529, 2.0)) - 1.58529) / (2.0 * 0.14894 * ma_Y_Pt_lp_r[i]);
-        ma_Lambda_Pr_r[i] = (sqrt(4.0 * 0.14894 * pow(ma_Y_Pr_r[i], 2.0) + pow(1.58529, 2.0)) - 1.58529) / (2.0 * 0.14894 * ma_Y_Pr_r[i]);
-
-        ma_Pi_S_r[i] = pow(1 - 0.16667 * pow(ma_Lambda_S_r[i], 2), 3.5);
-        ma_Pi_Pk_lp_r[i] = pow(1 - 0.16667 * pow(ma_Lambda_Pk_lp_r[i], 2), 3.5);
-        ma_Pi_Pks_lp_r[i] = pow(1 - 0.16667 * pow(ma_Lambda_Pks_lp_r[i], 2), 3.5);
-        ma_Pi_Pk_hp_r[i] = pow(1 - 0.16667 * pow(ma_Lambda_Pk_hp_r[i], 2), 3.5);
-        ma_Pi_Pks_hp_r[i] = pow(1 - 0.16667 * pow(ma_Lambda_Pks_hp_r[i], 2), 3.5);
-
-        ma_Pi_Pt_hp_r[i] = pow(1 - 0.14894 * pow(ma_Lambda_Pt_hp_r[i], 2), 3.85714);
-        ma_Pi_Pt_lp_r[i] = pow(1 - 0.14894 * pow(ma_Lambda_Pt_lp_r[i], 2), 3.85714);
-        ma_Pi_Pr_r[i] = pow(1 - 0.14894 * pow(ma_Lambda_Pr_r[i], 2), 3.85714);
-
-        ma_S_r_dyn[i] = ma_S_r[i] / ma_Pi_S_r[i];
-        ma_Pk_lp_r_dyn[i] = ma_Pk_lp_r[i] / ma_Pi_Pk_lp_r[i];
-        ma_Pks_lp_r_dyn[i] = ma_Pks_lp_r[i] / ma_Pi_Pks_lp_r[i];
-        ma_Pk_hp_r_dyn[i] = ma_Pk_hp_r[i] / ma_Pi_Pk_hp_r[i];
-        ma_Pks_hp_r_dyn[i] = ma_Pks_hp_r[i] / ma_Pi_Pks_hp_r[i];
-
-        ma_Pt_hp_r_dyn[i] = ma_Pt_hp_r[i] / ma_Pi_Pt_hp_r[i];
-        ma_Pt_lp_r_dyn[i] = ma_Pt_lp_r[i] / ma_Pi_Pt_lp_r[i];
-        ma_Pr_r_dyn[i] = ma_Pr_r[i] / ma_Pi_Pr_r[i];
-
-        ma_nuv[i] = 0.12 * ma_Gair_real[i] * 288.294 * ma_Tks_hp_r[i] / (m_conf->val_Vh() / m_conf->val_sysNum() * ma_n[i] * ma_Pks_hp_r_dyn[i]);
-
-        if ( m_conf->val_acType_lp() == ACTYPE_AIRAIR ) {
-            if ( ma_T0_r[i] < 303.0 ) {
-                ma_E1[i] = (ma_Tk_lp_r[i] - ma_Tks_lp_r[i]) / (ma_Tk_lp_r[i] - 298.0);
-            }
-            else {
-                ma_E1[i] = (ma_Tk_lp_r[i] - ma_Tks_lp_r[i]) / (ma_Tk_lp_r[i] - ma_T0_r[i]);
-            }
-        }
-        else {
-            ma_E1[i] = (ma_Tk_lp_r[i] - ma_Tks_lp_r[i]) / (ma_Tk_lp_r[i] - ma_Tcool_r[i]);
-        }
-
-        if ( ma_E1[i] > 1.0 ) {
-            ma_E1[i] = 1.0;
-        }
+    TRACESCOPE("doCalculate");
 
-        if ( (ma_Tk_lp_r[i] < ma_Tks_lp_r[i]) && (ma_E1[i] > 0) ) {
-            ma_E1[i] *= -1.0;
-        }
+    const TkrCalcParams params = m_conf->val_calcParams();
+    const TkrRow<double> masked = maskedRow();
 
-        if ( m_conf->val_acType_hp() == ACTYPE_AIRAIR ) {
-            if ( ma_T0_r[i] < 303.0 ) {
-                ma_E2[i] = (ma_Tk_hp_r[i] - ma_Tks_hp_r[i]) / (ma_Tk_hp_r[i] - 298.0);
-            }
-            else {
-                ma_E2[i] = (ma_Tk_hp_r[i] - ma_Tks_hp_r[i]) / (ma_Tk_hp_r[i] - ma_T0_r[i]);
-            }
-        }
-        else {
-            ma_E2[i] = (ma_Tk_hp_r[i] - ma_Tks_hp_r[i]) / (ma_Tk_hp_r[i] - ma_Tcool_r[i]);
-        }
+    for ( size_t i=0; i<m_n; i++ ) {
 
-        if ( ma_E2[i] > 1.0 ) {
-            ma_E2[i] = 1.0;
+        if ( m_src->isMasked(i) ) {
+            storeRow(i, masked);
+            continue;
         }
 
-        if ( (ma_Tk_hp_r[i] < ma_Tks_hp_r[i]) && (ma_E2[i] > 0) ) {
-            ma_E2[i] *= -1.0;
-        }
+        TkrRow<double> r;
 
-        ma_Gair_lp_r[i] = ma_Gair_real[i] * m_conf->val_B0_std() / ma_S_r_dyn[i] * pow(ma_T0_r[i] / (m_conf->val_T0_std() + 273), 0.5);
-        ma_Gair_hp_r[i] = ma_Gair_real[i] * m_conf->val_B0_std() / ma_Pks_lp_r_dyn[i] * pow(ma_Tks_lp_r[i] / (m_conf->val_T0_std() + 273), 0.5);
-        ma_Pik_lp[i] = ma_Pk_lp_r_dyn[i] / ma_S_r_dyn[i];
-        ma_Pik_hp[i] = ma_Pk_hp_r_dyn[i] / ma_Pks_lp_r_dyn[i];
-        ma_nuad_lp[i] = ma_T0_r[i] * (pow(ma_Pik_lp[i], 0.2857) - 1) / (ma_Tk_lp_r[i] - ma_T0_r[i]);
-        ma_nuad_hp[i] = ma_Tks_lp_r[i] * (pow(ma_Pik_hp[i], 0.2857) - 1) / (ma_Tk_hp_r[i] - ma_Tks_lp_r[i]);
-        ma_Ncomp_lp[i] = ma_Gair_real[i] * 1.009 * ma_T0_r[i] * (pow(ma_Pik_lp[i], 0.2857) - 1);
-        ma_Ncomp_hp[i] = ma_Gair_real[i] * 1.009 * ma_Tks_lp_r[i] * (pow(ma_Pik_hp[i], 0.2857) - 1);
-
-        ma_Pit_lp[i] = ma_Pt_lp_r_dyn[i] / ma_Pr_r_dyn[i];
-        ma_Pit_hp[i] = ma_Pt_hp_r_dyn[i] / ma_Pt_lp_r_dyn[i];
-        ma_Tr_calc_lp[i] = (ma_Tt_lp_r[i]) / pow(ma_Pit_lp[i], 0.2593);
-        ma_phi_lp[i] = (ma_Tr_r[i] - ma_Tr_calc_lp[i]) / (ma_Tt_lp_r[i] - ma_Tr_calc_lp[i]);
-        if ( ma_phi_lp[i] <= 0.04 ) {
-            ma_phi_lp[i] = 0;
-        }
-        ma_Tr_calc_hp[i] = (ma_Tt_hp_r[i]) / pow(ma_Pit_hp[i], 0.2593);
-        ma_phi_hp[i] = (ma_Tt_lp_r[i] - ma_Tr_calc_hp[i]) / (ma_Tt_hp_r[i] - ma_Tr_calc_hp[i]);
-        if ( ma_phi_hp[i] <= 0.04 ) {
-            ma_phi_hp[i] = 0;
-        }
-        ma_Gexh_lp_r[i] = ma_Gexh_real[i] * pow(ma_Tt_lp_r[i], 0.5) / ma_Pt_lp_r_dyn[i] * (1 - ma_phi_lp[i]);
-        ma_Gexh_hp_r[i] = ma_Gexh_real[i] * pow(ma_Tt_hp_r[i], 0.5) / ma_Pt_hp_r_dyn[i] * (1 - ma_phi_hp[i]);
-        ma_Nt_dis_lp[i] = ma_Gexh_real[i] * (1 - ma_phi_lp[i]) * 1.10892 * ma_Tt_lp_r[i] * (1 - 1 / pow(ma_Pit_lp[i], 0.2593));
-        ma_Nt_dis_hp[i] = ma_Gexh_real[i] * (1 - ma_phi_hp[i]) * 1.10892 * ma_Tt_hp_r[i] * (1 - 1 / pow(ma_Pit_hp[i], 0.2593));
-        ma_nute_lp[i] = (ma_Ncomp_lp[i] * 0.95) / (ma_Nt_dis_lp[i] * ma_nuad_lp[i]);
-        ma_nute_hp[i] = (ma_Ncomp_hp[i] * 0.95) / (ma_Nt_dis_hp[i] * ma_nuad_hp[i]);
-        ma_Cad_lp[i] = pow(2000 * ma_Nt_dis_lp[i] / ma_Gexh_real[i] / (1 - ma_phi_lp[i]), 0.5);
-        ma_rhog_lp[i] = ma_Pr_r[i] * 1000.0 / 287.497 / ma_Tr_r[i];
-        ma_muft_lp[i] = ma_Gexh_real[i] * (1 - ma_phi_lp[i]) / ma_rhog_lp[i] / ma_Cad_lp[i] * 10000.0;
-        ma_Cad_hp[i] = pow(2000 * ma_Nt_dis_hp[i] / ma_Gexh_real[i] / (1 - ma_phi_hp[i]), 0.5);
-        ma_rhog_hp[i] = ma_Pt_lp_r[i] * 1000.0 / 287.497 / ma_Tt_lp_r[i];
-        ma_muft_hp[i] = ma_Gexh_real[i] * (1 - ma_phi_hp[i]) / ma_rhog_hp[i] / ma_Cad_hp[i] * 10000.0;
-
-        double tmp_Ft = 5.0;
-        size_t iter = 0;
-
-        while ( 1 ) {
-
-            if ( iter > MAXITER ) {
-                break;
-            }
+        m_src->loadRow(i, r);
+        tkrCalculate(r, params);
+        maskAbsentStations(r, m_src->val_absentStations(i));
+        storeRow(i, r);
+    }
+}
 
-            double tmp_Ft_1 = ma_muft_lp[i] / (0.421189 * log(ma_Pit_lp[i]) + 0.707889) / muPit2(tmp_Ft);
-            tmp_Ft = tmp_Ft_1;
-            double tmp_Ft_2 = ma_muft_lp[i] / (0.421189 * log(ma_Pit_lp[i]) + 0.707889) / muPit2(tmp_Ft);
-            tmp_Ft = tmp_Ft_2;
+void TkrParameters::storeRow(size_t i, const TkrRow<double> &r) {
 
-            if ( fabs(tmp_Ft_1 - tmp_Ft_2) <= FTDEFACCUR ) {
-                ma_Ft_lp[i] = tmp_Ft_2;
-                break;
-            }
+    ma_Gair_real[i] = r.G_real[GAS_AIR];
+    ma_Gexh_real[i] = r.G_real[GAS_EXH];
 
-            iter++;
-        }
+    double *Y      = &ma_st_Y     [i * STATIONNUM];
+    double *Lambda = &ma_st_Lambda[i * STATIONNUM];
+    double *Pi     = &ma_st_Pi    [i * STATIONNUM];
+    double *P_dyn  = &ma_st_P_dyn [i * STATIONNUM];
 
-        tmp_Ft = 5.0;
-        iter = 0;
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        Y     [s] = r.st_Y[s];
+        Lambda[s] = r.st_Lambda[s];
+        Pi    [s] = r.st_Pi[s];
+        P_dyn [s] = r.st_P_dyn[s];
+    }
 
-        while ( 1 ) {
+    ma_nuv[i] = r.nuv;
+    ma_E1 [i] = r.E1;
+    ma_E2 [i] = r.E2;
+
+    ma_Gair_lp_r[i] = r.Gair_lp_r;
+    ma_Gair_hp_r[i] = r.Gair_hp_r;
+    ma_Pik_lp   [i] = r.Pik_lp;
+    ma_Pik_hp   [i] = r.Pik_hp;
+    ma_nuad_lp  [i] = r.nuad_lp;
+    ma_nuad_hp  [i] = r.nuad_hp;
+    ma_Ncomp_lp [i] = r.Ncomp_lp;
+    ma_Ncomp_hp [i] = r.Ncomp_hp;
+
+    ma_Gexh_lp_r [i] = r.Gexh_lp_r;
+    ma_Gexh_hp_r [i] = r.Gexh_hp_r;
+    ma_Pit_lp    [i] = r.Pit_lp;
+    ma_Pit_hp    [i] = r.Pit_hp;
+    ma_Tr_calc_lp[i] = r.Tr_calc_lp;
+    ma_phi_lp    [i] = r.phi_lp;
+    ma_Tr_calc_hp[i] = r.Tr_calc_hp;
+    ma_phi_hp    [i] = r.phi_hp;
+    ma_Nt_dis_lp [i] = r.Nt_dis_lp;
+    ma_Nt_dis_hp [i] = r.Nt_dis_hp;
+    ma_nute_lp   [i] = r.nute_lp;
+    ma_nute_hp   [i] = r.nute_hp;
+    ma_Cad_lp    [i] = r.Cad_lp;
+    ma_rhog_lp   [i] = r.rhog_lp;
+    ma_muft_lp   [i] = r.muft_lp;
+    ma_Cad_hp    [i] = r.Cad_hp;
+    ma_rhog_hp   [i] = r.rhog_hp;
+    ma_muft_hp   [i] = r.muft_hp;
+    ma_Ft_lp     [i] = r.Ft_lp;
+    ma_Ft_hp     [i] = r.Ft_hp;
+
+    ma_nutkr_lp[i] = r.nutkr_lp;
+    ma_nutkr_hp[i] = r.nutkr_hp;
+    ma_nusys   [i] = r.nusys;
+}
 
-            if ( iter > MAXITER ) {
-                break;
-            }
+const vector<double> &TkrParameters::resultColumn(size_t col) const {
+
+    // order of columns corresponds to resCaptions
+    static vector<double> TkrParameters::* const cols[] = {
+        &TkrParameters::ma_nuv,
+        &TkrParameters::ma_E1,
+        &TkrParameters::ma_E2,
+        &TkrParameters::ma_Gair_lp_r,
+        &TkrParameters::ma_Pik_lp,
+        &TkrParameters::ma_nuad_lp,
+        &TkrParameters::ma_Ncomp_lp,
+        &TkrParameters::ma_Gexh_lp_r,
+        &TkrParameters::ma_Pit_lp,
+        &TkrParameters::ma_nute_lp,
+        &TkrParameters::ma_muft_lp,
+        &TkrParameters::ma_Nt_dis_lp,
+        &TkrParameters::ma_phi_lp,
+        &TkrParameters::ma_Ft_lp,
+        &TkrParameters::ma_Gair_hp_r,
+        &TkrParameters::ma_Pik_hp,
+        &TkrParameters::ma_nuad_hp,
+        &TkrParameters::ma_Ncomp_hp,
+        &TkrParameters::ma_Gexh_hp_r,
+        &TkrParameters::ma_Pit_hp,
+        &TkrParameters::ma_nute_hp,
+        &TkrParameters::ma_muft_hp,
+        &TkrParameters::ma_Nt_dis_hp,
+        &TkrParameters::ma_phi_hp,
+        &TkrParameters::ma_Ft_hp,
+        &TkrParameters::ma_nutkr_lp,
+        &TkrParameters::ma_nutkr_hp,
+        &TkrParameters::ma_nusys
+    };
+
+    return this->*cols[col];
+}
 
-            double tmp_Ft_1 = ma_muft_hp[i] / (0.421189 * log(ma_Pit_hp[i]) + 0.707889) / muPit2(tmp_Ft);
-            tmp_Ft = tmp_Ft_1;
-            double tmp_Ft_2 = ma_muft_hp[i] / (0.421189 * log(ma_Pit_hp[i]) + 0.707889) / muPit2(tmp_Ft);
-            tmp_Ft = tmp_Ft_2;
+bool TkrParameters::createReport() {
 
-            if ( fabs(tmp_Ft_1 - tmp_Ft_2) <= FTDEFACCUR ) {
-                ma_Ft_hp[i] = tmp_Ft_2;
-                break;
-            }
+    TRACESCOPE("write report");
 
-            iter++;
-        }
+    const string fileName = m_conf->val_reportStdout() ? string(STDOUTNAME) : reportFileName(REPORTNAME, *m_conf);
 
-        ma_nutkr_lp[i] = ma_nuad_lp[i] * ma_nute_lp[i];
-        ma_nutkr_hp[i] = ma_nuad_hp[i] * ma_nute_hp[i];
+    ReportStream fout(fileName, m_conf->val_reportCompression());
 
-        ma_nusys[i] = ma_nutkr_lp[i] * ma_nutkr_hp[i];
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
     }
 
-    cout << MSGBLANK << "Calculation completed.\n";
-}
-
-double TkrParameters::muPit2(double Ft) const {
+    writeHeader(fout);
+    writeSourceTable(fout);
+    writeResultsCaption(fout);
+    writeResultsTable(fout);
 
-    if ( Ft < 5.0 ) {
-        return 0.895;
-    }
-    else if ( (Ft >= 5.0) && (Ft <= 55.0) ) {
-        return 0.87503 + 0.0250807 * Ft
-            - 0.00546323        * pow(Ft, 2)
-            + 0.000278903       * pow(Ft, 3)
-            - 0.00000655348     * pow(Ft, 4)
-            + 0.0000000737792   * pow(Ft, 5)
-            - 0.000000000320939 * pow(Ft, 6);
-    }
-    else {
-        return 0.410;
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
     }
-}
 
-bool TkrParameters::createReport() {
+    cout << MSGBLANK << "Report file \"" << fileName << "\"created.\n";
 
-    time_t t = time(NULL);
-    struct tm *dtnow = localtime(&t);
-
-    string year = boost::lexical_cast<string>(dtnow->tm_year + 1900);
-    string mon  = boost::lexical_cast<string>(dtnow->tm_mon + 1);
-    string day  = boost::lexical_cast<string>(dtnow->tm_mday);
-    string hour = boost::lexical_cast<string>(dtnow->tm_hour);
-    string min  = boost::lexical_cast<string>(dtnow->tm_min);
-    string sec  = boost::lexical_cast<string>(dtnow->tm_sec);
+    return true;
+}
 
-    string currDateTime(year + "-" + trimDate(mon) + "-" + trimDate(day) + "_" + trimDate(hour) + "-" + trimDate(min) + "-" + trimDate(sec));
-    string reportName(REPORTNAME);
-    string reportFileName = reportName + "__" + currDateTime + ".csv";
+void TkrParameters::writeHeader(ostream &fout) const {
 
-    ofstream fout(reportFileName);
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n";
 
-    if ( !fout ) {
-        cout << ERRORMSGBLANK << "Can not open file \"" << reportFileName << "\" to write!\n";
-        return false;
+    if ( !m_conf->val_profileName().empty() ) {
+        fout << "Configuration profile: " << m_conf->val_profileName() << "\n\n";
     }
 
-    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n"
-         << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
+    fout << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
          << "Standard conditions\n\n"
          << "B0_std" << CSVDELIMETER << m_conf->val_B0_std() << CSVDELIMETER << "kPa\n"
          << "T0_std" << CSVDELIMETER << m_conf->val_T0_std() << CSVDELIMETER << "degC\n\n"
          << "Source data\n\n"
-         << "Vh" << CSVDELIMETER << m_conf->val_Vh() << CSVDELIMETER << "m3\n"
-         << "F1_S" << CSVDELIMETER << m_conf->val_F1_S() << CSVDELIMETER << "m2\n"
-         << "F2_Pk_lp" << CSVDELIMETER << m_conf->val_F2_Pklp() << CSVDELIMETER << "m2\n"
-         << "F3_Pks_lp" << CSVDELIMETER << m_conf->val_F3_Pkslp() << CSVDELIMETER << "m2\n"
-         << "F4_Pk_hp" << CSVDELIMETER << m_conf->val_F4_Pkhp() << CSVDELIMETER << "m2\n"
-         << "F5_Pks_hp" << CSVDELIMETER << m_conf->val_F5_Pkshp() << CSVDELIMETER << "m2\n"
-         << "F6_Pt_hp" << CSVDELIMETER << m_conf->val_F6_Pthp() << CSVDELIMETER << "m2\n"
-         << "F7_Pt_lp" << CSVDELIMETER << m_conf->val_F7_Ptlp() << CSVDELIMETER << "m2\n"
-         << "F8_Pr" << CSVDELIMETER << m_conf->val_F8_Pr() << CSVDELIMETER << "m2\n"
-         << "sysNum" << CSVDELIMETER << m_conf->val_sysNum() << CSVDELIMETER << "\n"
+         << "Vh" << CSVDELIMETER << m_conf->val_Vh() << CSVDELIMETER << "m3\n";
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        fout << "F" << s + 1 << "_" << stationCaptions[s] << CSVDELIMETER << m_conf->val_F(s) << CSVDELIMETER << "m2\n";
+    }
+
+    fout << "sysNum" << CSVDELIMETER << m_conf->val_sysNum() << CSVDELIMETER << "\n"
          << "pipeNumHpOut" << CSVDELIMETER << m_conf->val_pipeNumHpOut() << CSVDELIMETER << "\n"
          << "pipeNumHpIn" << CSVDELIMETER << m_conf->val_pipeNumHpIn() << CSVDELIMETER << "\n"
          << "Aftercooler type (low pressure)" << CSVDELIMETER << m_conf->val_acType_lp() << "\n"
@@ -489,34 +393,33 @@ bool TkrParameters::createReport() {
             fout << CSVDELIMETER;
         }
     }
+}
+
+void TkrParameters::writeSourceTable(ostream &fout) const {
 
     for ( size_t i=0; i<m_n; i++ ) {
 
-        fout << ma_n[i]      << CSVDELIMETER
-             << ma_Me[i]     << CSVDELIMETER
-             << ma_Ne[i]     << CSVDELIMETER
-             << ma_Gfuel[i]  << CSVDELIMETER
-             << ma_Gair[i]   << CSVDELIMETER
-             << ma_B0[i]     << CSVDELIMETER
-             << ma_S[i]      << CSVDELIMETER
-             << ma_Pk_lp[i]  << CSVDELIMETER
-             << ma_Pks_lp[i] << CSVDELIMETER
-             << ma_Pk_hp[i]  << CSVDELIMETER
-             << ma_Pks_hp[i] << CSVDELIMETER
-             << ma_Pt_hp[i]  << CSVDELIMETER
-             << ma_Pt_lp[i]  << CSVDELIMETER
-             << ma_Pr[i]     << CSVDELIMETER
-             << ma_T0[i]     << CSVDELIMETER
-             << ma_Tk_lp[i]  << CSVDELIMETER
-             << ma_Tks_lp[i] << CSVDELIMETER
-             << ma_Tk_hp[i]  << CSVDELIMETER
-             << ma_Tks_hp[i] << CSVDELIMETER
-             << ma_Tt_hp[i]  << CSVDELIMETER
-             << ma_Tt_lp[i]  << CSVDELIMETER
-             << ma_Tr[i]     << CSVDELIMETER
-             << ma_Tcool[i]  << CSVDELIMETER
+        fout << m_src->ma_n[i]     << CSVDELIMETER
+             << m_src->ma_Me[i]    << CSVDELIMETER
+             << m_src->ma_Ne[i]    << CSVDELIMETER
+             << m_src->ma_Gfuel[i] << CSVDELIMETER
+             << m_src->ma_Gair[i]  << CSVDELIMETER
+             << m_src->ma_B0[i]    << CSVDELIMETER;
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << m_src->ma_st_P[i * STATIONNUM + s] << CSVDELIMETER;
+        }
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << m_src->ma_st_T[i * STATIONNUM + s] << CSVDELIMETER;
+        }
+
+        fout << m_src->ma_Tcool[i] << CSVDELIMETER
              << "\n";
     }
+}
+
+void TkrParameters::writeResultsCaption(ostream &fout) const {
 
     fout << "\n" << "Calculation results\n\n"
          << "n[min-1]"          << CSVDELIMETER
@@ -576,66 +479,70 @@ bool TkrParameters::createReport() {
          << "Tt_hp_r[K]"        << CSVDELIMETER
          << "Tt_lp_r[K]"        << CSVDELIMETER
          << "Tr_r[K]"           << "\n";
+}
+
+void TkrParameters::writeResultsTable(ostream &fout) const {
 
     for ( size_t i=0; i<m_n; i++ ) {
 
-        fout << fixed << setprecision(0) << ma_n[i]  << CSVDELIMETER
-             << fixed << setprecision(0) << ma_Me[i] << CSVDELIMETER
-             << fixed << setprecision(2) << ma_Ne[i] << CSVDELIMETER
-             << fixed << setprecision(2) << ma_Gair[i] / (ma_Gfuel[i] / m_conf->val_sysNum()) << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nuv[i]          << CSVDELIMETER
-             << fixed << setprecision(3) << ma_E1[i]           << CSVDELIMETER
-             << fixed << setprecision(3) << ma_E2[i]           << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Gair_lp_r[i]    << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pik_lp[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nuad_lp[i]      << CSVDELIMETER
-             << fixed << setprecision(2) << ma_Ncomp_lp[i]     << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Gexh_lp_r[i]    << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pit_lp[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nute_lp[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_muft_lp[i]      << CSVDELIMETER
-             << fixed << setprecision(2) << ma_Nt_dis_lp[i]    << CSVDELIMETER
-             << fixed << setprecision(3) << ma_phi_lp[i]       << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Ft_lp[i]        << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Gair_hp_r[i]    << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pik_hp[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nuad_hp[i]      << CSVDELIMETER
-             << fixed << setprecision(2) << ma_Ncomp_hp[i]     << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Gexh_hp_r[i]    << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pit_hp[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nute_hp[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_muft_hp[i]      << CSVDELIMETER
-             << fixed << setprecision(2) << ma_Nt_dis_hp[i]    << CSVDELIMETER
-             << fixed << setprecision(3) << ma_phi_hp[i]       << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Ft_hp[i]        << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nutkr_lp[i]     << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nutkr_hp[i]     << CSVDELIMETER
-             << fixed << setprecision(3) << ma_nusys[i]        << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(1) << ma_B0_r[i]         << CSVDELIMETER
-             << fixed << setprecision(1) << ma_S_r[i]          << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pk_lp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pks_lp_r[i]     << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pk_hp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pks_hp_r[i]     << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pt_hp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pt_lp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pr_r[i]         << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(1) << ma_S_r_dyn[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pk_lp_r_dyn[i]  << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pks_lp_r_dyn[i] << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pk_hp_r_dyn[i]  << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pks_hp_r_dyn[i] << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pt_hp_r_dyn[i]  << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pt_lp_r_dyn[i]  << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Pr_r_dyn[i]     << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(1) << ma_T0_r[i]         << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tk_lp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tks_lp_r[i]     << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tk_hp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tks_hp_r[i]     << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tt_hp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tt_lp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(1) << ma_Tr_r[i]         << "\n";
+        const double airFuel = m_src->isMasked(i) ? MASKED : m_src->ma_Gair[i] / (m_src->ma_Gfuel[i] / m_conf->val_sysNum());
+
+        fout << cell(m_src->ma_n[i], 0)    << CSVDELIMETER
+             << cell(m_src->ma_Me[i], 0)   << CSVDELIMETER
+             << cell(m_src->ma_Ne[i], 2)   << CSVDELIMETER
+             << cell(airFuel, 2)           << CSVDELIMETER
+             << cell(ma_nuv[i], 3)         << CSVDELIMETER
+             << cell(ma_E1[i], 3)          << CSVDELIMETER
+             << cell(ma_E2[i], 3)          << CSVDELIMETER << CSVDELIMETER
+             << cell(ma_Gair_lp_r[i], 3)   << CSVDELIMETER
+             << cell(ma_Pik_lp[i], 3)      << CSVDELIMETER
+             << cell(ma_nuad_lp[i], 3)     << CSVDELIMETER
+             << cell(ma_Ncomp_lp[i], 2)    << CSVDELIMETER << CSVDELIMETER
+             << cell(ma_Gexh_lp_r[i], 3)   << CSVDELIMETER
+             << cell(ma_Pit_lp[i], 3)      << CSVDELIMETER
+             << cell(ma_nute_lp[i], 3)     << CSVDELIMETER
+             << cell(ma_muft_lp[i], 1)     << CSVDELIMETER
+             << cell(ma_Nt_dis_lp[i], 2)   << CSVDELIMETER
+             << cell(ma_phi_lp[i], 3)      << CSVDELIMETER
+             << cell(ma_Ft_lp[i], 1)       << CSVDELIMETER << CSVDELIMETER
+             << cell(ma_Gair_hp_r[i], 3)   << CSVDELIMETER
+             << cell(ma_Pik_hp[i], 3)      << CSVDELIMETER
+             << cell(ma_nuad_hp[i], 3)     << CSVDELIMETER
+             << cell(ma_Ncomp_hp[i], 2)    << CSVDELIMETER << CSVDELIMETER
+             << cell(ma_Gexh_hp_r[i], 3)   << CSVDELIMETER
+             << cell(ma_Pit_hp[i], 3)      << CSVDELIMETER
+             << cell(ma_nute_hp[i], 3)     << CSVDELIMETER
+             << cell(ma_muft_hp[i], 1)     << CSVDELIMETER
+             << cell(ma_Nt_dis_hp[i], 2)   << CSVDELIMETER
+             << cell(ma_phi_hp[i], 3)      << CSVDELIMETER
+             << cell(ma_Ft_hp[i], 1)       << CSVDELIMETER << CSVDELIMETER
+             << cell(ma_nutkr_lp[i], 3)    << CSVDELIMETER
+             << cell(ma_nutkr_hp[i], 3)    << CSVDELIMETER
+             << cell(ma_nusys[i], 3)       << CSVDELIMETER << CSVDELIMETER
+             << cell(m_src->ma_B0_r[i], 1) << CSVDELIMETER;
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << cell(m_src->ma_st_P_r[i * STATIONNUM + s], 1) << CSVDELIMETER;
+        }
+
+        fout << CSVDELIMETER;
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << cell(ma_st_P_dyn[i * STATIONNUM + s], 1) << CSVDELIMETER;
+        }
+
+        fout << CSVDELIMETER;
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+
+            fout << cell(m_src->ma_st_T_r[i * STATIONNUM + s], 1);
+
+            if ( s != (STATIONNUM-1) ) {
+                fout << CSVDELIMETER;
+            }
+        }
+
+        fout << "\n";
     }
 /*
     fout << "\n" << "Checkout data\n\n"
@@ -669,38 +576,26 @@ bool TkrParameters::createReport() {
 
     for ( size_t i=0; i<m_n; i++ ) {
 
-        fout << fixed << setprecision(3) << ma_Gair_real[i]        << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Gexh_real[i]        << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_S_r[i]            << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pk_lp_r[i]        << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pks_lp_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pk_hp_r[i]        << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pks_hp_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pt_hp_r[i]        << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pt_lp_r[i]        << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Y_Pr_r[i]           << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_S_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pk_lp_r[i]   << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pks_lp_r[i]  << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pk_hp_r[i]   << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pks_hp_r[i]  << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pt_hp_r[i]   << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pt_lp_r[i]   << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Lambda_Pr_r[i]      << CSVDELIMETER << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_S_r[i]           << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pk_lp_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pks_lp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pk_hp_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pks_hp_r[i]      << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pt_hp_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pt_lp_r[i]       << CSVDELIMETER
-             << fixed << setprecision(3) << ma_Pi_Pr_r[i]          << CSVDELIMETER
-             << "\n";
-    }
-*/
-    fout.close();
+        fout << fixed << setprecision(3) << ma_Gair_real[i] << CSVDELIMETER
+             << fixed << setprecision(3) << ma_Gexh_real[i] << CSVDELIMETER << CSVDELIMETER;
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << fixed << setprecision(3) << ma_st_Y[i * STATIONNUM + s] << CSVDELIMETER;
+        }
 
-    cout << MSGBLANK << "Report file \"" << reportFileName << "\"created.\n";
+        fout << CSVDELIMETER;
 
-    return true;
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << fixed << setprecision(3) << ma_st_Lambda[i * STATIONNUM + s] << CSVDELIMETER;
+        }
+
+        fout << CSVDELIMETER;
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            fout << fixed << setprecision(3) << ma_st_Pi[i * STATIONNUM + s] << CSVDELIMETER;
+        }
+
+        fout << "\n";
+    }
+*/
 }
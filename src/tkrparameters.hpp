@@ -23,8 +23,11 @@
 
 #include <vector>
 #include <memory>
+#include <ostream>
 
 #include "configuration.hpp"
+#include "tkrkernel.hpp"
+#include "tkrsourcedata.hpp"
 
 class TkrParameters {
 
@@ -35,98 +38,47 @@ public:
     bool calculate(const std::vector< std::vector<double> > &);
     bool createReport();
 
+    void writeHeader(std::ostream &) const;
+    void writeSourceTable(std::ostream &) const;
+    void writeResultsCaption(std::ostream &) const;
+    void writeResultsTable(std::ostream &) const;
+
+    static bool calculate(const std::vector< std::shared_ptr<TkrParameters> > &,
+                          const std::shared_ptr<const TkrSourceData> &);
+
+    size_t val_rowsNum() const {
+        return m_n;
+    }
+    const std::vector<double> &resultColumn(size_t) const;
+    const std::vector<double> &val_n() const {
+        return m_src->ma_n;
+    }
+    const std::vector<double> &val_Me() const {
+        return m_src->ma_Me;
+    }
+    bool isMasked(size_t i) const {
+        return m_src->isMasked(i);
+    }
+
 private:
 
-    void prepareArrays(const std::vector< std::vector<double> > &);
-    void preCalculate();
+    void prepareArrays();
     void doCalculate();
-    double muPit2(double) const;
+    void storeRow(size_t, const TkrRow<double> &);
 
     std::shared_ptr<Configuration> m_conf;
+    std::shared_ptr<const TkrSourceData> m_src;
+    std::shared_ptr<TkrSourceData> m_ownSrc;
 
     size_t m_n = 0;
 
-    std::vector<double> ma_n;
-    std::vector<double> ma_Me;
-    std::vector<double> ma_Ne;
-    std::vector<double> ma_Gfuel;
-    std::vector<double> ma_Gair;
-    std::vector<double> ma_B0;
-    std::vector<double> ma_S;
-    std::vector<double> ma_Pk_lp;
-    std::vector<double> ma_Pks_lp;
-    std::vector<double> ma_Pk_hp;
-    std::vector<double> ma_Pks_hp;
-    std::vector<double> ma_Pt_hp;
-    std::vector<double> ma_Pt_lp;
-    std::vector<double> ma_Pr;
-    std::vector<double> ma_T0;
-    std::vector<double> ma_Tk_lp;
-    std::vector<double> ma_Tks_lp;
-    std::vector<double> ma_Tk_hp;
-    std::vector<double> ma_Tks_hp;
-    std::vector<double> ma_Tt_hp;
-    std::vector<double> ma_Tt_lp;
-    std::vector<double> ma_Tr;
-    std::vector<double> ma_Tcool;
-
-    std::vector<double> ma_B0_r;
-    std::vector<double> ma_S_r;
-    std::vector<double> ma_Pk_lp_r;
-    std::vector<double> ma_Pks_lp_r;
-    std::vector<double> ma_Pk_hp_r;
-    std::vector<double> ma_Pks_hp_r;
-    std::vector<double> ma_Pt_hp_r;
-    std::vector<double> ma_Pt_lp_r;
-    std::vector<double> ma_Pr_r;
-    std::vector<double> ma_T0_r;
-    std::vector<double> ma_Tk_lp_r;
-    std::vector<double> ma_Tks_lp_r;
-    std::vector<double> ma_Tk_hp_r;
-    std::vector<double> ma_Tks_hp_r;
-    std::vector<double> ma_Tt_hp_r;
-    std::vector<double> ma_Tt_lp_r;
-    std::vector<double> ma_Tr_r;
-    std::vector<double> ma_Tcool_r;
-
     std::vector<double> ma_Gair_real;
     std::vector<double> ma_Gexh_real;
 
-    std::vector<double> ma_Y_S_r;
-    std::vector<double> ma_Y_Pk_lp_r;
-    std::vector<double> ma_Y_Pks_lp_r;
-    std::vector<double> ma_Y_Pk_hp_r;
-    std::vector<double> ma_Y_Pks_hp_r;
-    std::vector<double> ma_Y_Pt_hp_r;
-    std::vector<double> ma_Y_Pt_lp_r;
-    std::vector<double> ma_Y_Pr_r;
-
-    std::vector<double> ma_Lambda_S_r;
-    std::vector<double> ma_Lambda_Pk_lp_r;
-    std::vector<double> ma_Lambda_Pks_lp_r;
-    std::vector<double> ma_Lambda_Pk_hp_r;
-    std::vector<double> ma_Lambda_Pks_hp_r;
-    std::vector<double> ma_Lambda_Pt_hp_r;
-    std::vector<double> ma_Lambda_Pt_lp_r;
-    std::vector<double> ma_Lambda_Pr_r;
-
-    std::vector<double> ma_Pi_S_r;
-    std::vector<double> ma_Pi_Pk_lp_r;
-    std::vector<double> ma_Pi_Pks_lp_r;
-    std::vector<double> ma_Pi_Pk_hp_r;
-    std::vector<double> ma_Pi_Pks_hp_r;
-    std::vector<double> ma_Pi_Pt_hp_r;
-    std::vector<double> ma_Pi_Pt_lp_r;
-    std::vector<double> ma_Pi_Pr_r;
-
-    std::vector<double> ma_S_r_dyn;
-    std::vector<double> ma_Pk_lp_r_dyn;
-    std::vector<double> ma_Pks_lp_r_dyn;
-    std::vector<double> ma_Pk_hp_r_dyn;
-    std::vector<double> ma_Pks_hp_r_dyn;
-    std::vector<double> ma_Pt_hp_r_dyn;
-    std::vector<double> ma_Pt_lp_r_dyn;
-    std::vector<double> ma_Pr_r_dyn;
+    std::vector<double> ma_st_Y;
+    std::vector<double> ma_st_Lambda;
+    std::vector<double> ma_st_Pi;
+    std::vector<double> ma_st_P_dyn;
 
     std::vector<double> ma_nuv;
     std::vector<double> ma_E1;
@@ -0,0 +1,376 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrreference.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tkrreference.hpp"
+
+#include <cmath>
+#include <limits>
+
+using std::sqrt;
+using std::pow;
+using std::log;
+using std::fabs;
+
+namespace {
+
+double refMuPit2(double Ft) {
+
+    if ( Ft < 5.0 ) {
+        return 0.895;
+    }
+    else if ( (Ft >= 5.0) && (Ft <= 55.0) ) {
+        return 0.87503 + 0.0250807 * Ft
+            - 0.00546323        * pow(Ft, 2)
+            + 0.000278903       * pow(Ft, 3)
+            - 0.00000655348     * pow(Ft, 4)
+            + 0.0000000737792   * pow(Ft, 5)
+            - 0.000000000320939 * pow(Ft, 6);
+    }
+    else {
+        return 0.410;
+    }
+}
+
+double refFt(double muft, double Pit) {
+
+    double Ft = 0;
+    double tmp_Ft = 5.0;
+    size_t iter = 0;
+
+    while ( 1 ) {
+
+        if ( iter > 100.0 ) {
+            break;
+        }
+
+        double tmp_Ft_1 = muft / (0.421189 * log(Pit) + 0.707889) / refMuPit2(tmp_Ft);
+        tmp_Ft = tmp_Ft_1;
+        double tmp_Ft_2 = muft / (0.421189 * log(Pit) + 0.707889) / refMuPit2(tmp_Ft);
+        tmp_Ft = tmp_Ft_2;
+
+        if ( fabs(tmp_Ft_1 - tmp_Ft_2) <= 0.001 ) {
+            Ft = tmp_Ft_2;
+            break;
+        }
+
+        iter++;
+    }
+
+    return Ft;
+}
+
+double refLambdaAir(double Y) {
+    return (sqrt(4.0 * 0.16667 * pow(Y, 2.0) + pow(1.57744, 2.0)) - 1.57744) / (2.0 * 0.16667 * Y);
+}
+
+double refLambdaExh(double Y) {
+    return (sqrt(4.0 * 0.14894 * pow(Y, 2.0) + pow(1.58529, 2.0)) - 1.58529) / (2.0 * 0.14894 * Y);
+}
+
+double refPiAir(double Lambda) {
+    return pow(1 - 0.16667 * pow(Lambda, 2), 3.5);
+}
+
+double refPiExh(double Lambda) {
+    return pow(1 - 0.14894 * pow(Lambda, 2), 3.85714);
+}
+
+} // namespace
+
+void tkrReference(const double *src, const TkrCalcParams &p, double *res) {
+
+    const double n      = src[0];
+    const double Gfuel  = src[3];
+    const double Gair   = src[4];
+    const double B0     = src[5];
+    const double S      = src[6];
+    const double Pk_lp  = src[7];
+    const double Pks_lp = src[8];
+    const double Pk_hp  = src[9];
+    const double Pks_hp = src[10];
+    const double Pt_hp  = src[11];
+    const double Pt_lp  = src[12];
+    const double Pr     = src[13];
+    const double T0     = src[14];
+    const double Tk_lp  = src[15];
+    const double Tks_lp = src[16];
+    const double Tk_hp  = src[17];
+    const double Tks_hp = src[18];
+    const double Tt_hp  = src[19];
+    const double Tt_lp  = src[20];
+    const double Tr     = src[21];
+    const double Tcool  = src[22];
+
+    const double B0_r     = B0 * 100.0;
+    const double S_r      = S + B0_r;
+    const double Pk_lp_r  = Pk_lp * 100.0 + B0_r;
+    const double Pks_lp_r = Pks_lp * 100.0 + B0_r;
+    const double Pk_hp_r  = Pk_hp * 100.0 + B0_r;
+    const double Pks_hp_r = Pks_hp * 100.0 + B0_r;
+    const double Pt_hp_r  = Pt_hp * 100.0 + B0_r;
+    const double Pt_lp_r  = Pt_lp * 100.0 + B0_r;
+    const double Pr_r     = Pr + B0_r;
+    const double T0_r     = T0 + 273.0;
+    const double Tk_lp_r  = Tk_lp + 273.0;
+    const double Tks_lp_r = Tks_lp + 273.0;
+    const double Tk_hp_r  = Tk_hp + 273.0;
+    const double Tks_hp_r = Tks_hp + 273.0;
+    const double Tt_hp_r  = Tt_hp + 273.0;
+    const double Tt_lp_r  = Tt_lp + 273.0;
+    const double Tr_r     = Tr + 273.0;
+    const double Tcool_r  = Tcool + 273.0;
+
+    const double Gair_real = Gair / 3600.0;
+
+    const double Y_S_r      = Gair_real * sqrt(T0_r) / (S_r * p.F[ST_S] * p.pipes[ST_S] * 20.317);
+    const double Y_Pk_lp_r  = Gair_real * sqrt(Tk_lp_r) / (Pk_lp_r * p.F[ST_PK_LP] * p.pipes[ST_PK_LP] * 20.317);
+    const double Y_Pks_lp_r = Gair_real * sqrt(Tks_lp_r) / (Pks_lp_r * p.F[ST_PKS_LP] * p.pipes[ST_PKS_LP] * 20.317);
+    const double Y_Pk_hp_r  = Gair_real * sqrt(Tk_hp_r) / (Pk_hp_r * p.F[ST_PK_HP] * p.pipes[ST_PK_HP] * 20.317);
+    const double Y_Pks_hp_r = Gair_real * sqrt(Tks_hp_r) / (Pks_hp_r * p.F[ST_PKS_HP] * p.pipes[ST_PKS_HP] * 20.317);
+
+    const double Gexh_real = (Gair + Gfuel / p.sysNum) / 3600;
+
+    const double Y_Pt_hp_r = Gexh_real * sqrt(Tt_hp_r) / (Pt_hp_r * p.F[ST_PT_HP] * p.pipes[ST_PT_HP] * 25.639);
+    const double Y_Pt_lp_r = Gexh_real * sqrt(Tt_lp_r) / (Pt_lp_r * p.F[ST_PT_LP] * p.pipes[ST_PT_LP] * 25.639);
+    const double Y_Pr_r    = Gexh_real * sqrt(Tr_r) / (Pr_r * p.F[ST_PR] * p.pipes[ST_PR] * 25.639);
+
+    const double S_r_dyn      = S_r / refPiAir(refLambdaAir(Y_S_r));
+    const double Pk_lp_r_dyn  = Pk_lp_r / refPiAir(refLambdaAir(Y_Pk_lp_r));
+    const double Pks_lp_r_dyn = Pks_lp_r / refPiAir(refLambdaAir(Y_Pks_lp_r));
+    const double Pk_hp_r_dyn  = Pk_hp_r / refPiAir(refLambdaAir(Y_Pk_hp_r));
+    const double Pks_hp_r_dyn = Pks_hp_r / refPiAir(refLambdaAir(Y_Pks_hp_r));
+    const double Pt_hp_r_dyn  = Pt_hp_r / refPiExh(refLambdaExh(Y_Pt_hp_r));
+    const double Pt_lp_r_dyn  = Pt_lp_r / refPiExh(refLambdaExh(Y_Pt_lp_r));
+    const double Pr_r_dyn     = Pr_r / refPiExh(refLambdaExh(Y_Pr_r));
+
+    const double nuv = 0.12 * Gair_real * 288.294 * Tks_hp_r / (p.Vh / p.sysNum * n * Pks_hp_r_dyn);
+
+    double E1 = 0;
+
+    if ( p.acType_lp == 0 ) {
+        if ( T0_r < 303.0 ) {
+            E1 = (Tk_lp_r - Tks_lp_r) / (Tk_lp_r - 298.0);
+        }
+        else {
+            E1 = (Tk_lp_r - Tks_lp_r) / (Tk_lp_r - T0_r);
+        }
+    }
+    else {
+        E1 = (Tk_lp_r - Tks_lp_r) / (Tk_lp_r - Tcool_r);
+    }
+
+    if ( E1 > 1.0 ) {
+        E1 = 1.0;
+    }
+
+    if ( (Tk_lp_r < Tks_lp_r) && (E1 > 0) ) {
+        E1 *= -1.0;
+    }
+
+    double E2 = 0;
+
+    if ( p.acType_hp == 0 ) {
+        if ( T0_r < 303.0 ) {
+            E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - 298.0);
+        }
+        else {
+            E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - T0_r);
+        }
+    }
+    else {
+        E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - Tcool_r);
+    }
+
+    if ( E2 > 1.0 ) {
+        E2 = 1.0;
+    }
+
+    if ( (Tk_hp_r < Tks_hp_r) && (E2 > 0) ) {
+        E2 *= -1.0;
+    }
+
+    const double Gair_lp_r = Gair_real * p.B0_std / S_r_dyn * pow(T0_r / (p.T0_std + 273), 0.5);
+    const double Gair_hp_r = Gair_real * p.B0_std / Pks_lp_r_dyn * pow(Tks_lp_r / (p.T0_std + 273), 0.5);
+    const double Pik_lp = Pk_lp_r_dyn / S_r_dyn;
+    const double Pik_hp = Pk_hp_r_dyn / Pks_lp_r_dyn;
+    const double nuad_lp = T0_r * (pow(Pik_lp, 0.2857) - 1) / (Tk_lp_r - T0_r);
+    const double nuad_hp = Tks_lp_r * (pow(Pik_hp, 0.2857) - 1) / (Tk_hp_r - Tks_lp_r);
+    const double Ncomp_lp = Gair_real * 1.009 * T0_r * (pow(Pik_lp, 0.2857) - 1);
+    const double Ncomp_hp = Gair_real * 1.009 * Tks_lp_r * (pow(Pik_hp, 0.2857) - 1);
+
+    const double Pit_lp = Pt_lp_r_dyn / Pr_r_dyn;
+    const double Pit_hp = Pt_hp_r_dyn / Pt_lp_r_dyn;
+    const double Tr_calc_lp = (Tt_lp_r) / pow(Pit_lp, 0.2593);
+    double phi_lp = (Tr_r - Tr_calc_lp) / (Tt_lp_r - Tr_calc_lp);
+    if ( phi_lp <= 0.04 ) {
+        phi_lp = 0;
+    }
+    const double Tr_calc_hp = (Tt_hp_r) / pow(Pit_hp, 0.2593);
+    double phi_hp = (Tt_lp_r - Tr_calc_hp) / (Tt_hp_r - Tr_calc_hp);
+    if ( phi_hp <= 0.04 ) {
+        phi_hp = 0;
+    }
+    const double Gexh_lp_r = Gexh_real * pow(Tt_lp_r, 0.5) / Pt_lp_r_dyn * (1 - phi_lp);
+    const double Gexh_hp_r = Gexh_real * pow(Tt_hp_r, 0.5) / Pt_hp_r_dyn * (1 - phi_hp);
+    const double Nt_dis_lp = Gexh_real * (1 - phi_lp) * 1.10892 * Tt_lp_r * (1 - 1 / pow(Pit_lp, 0.2593));
+    const double Nt_dis_hp = Gexh_real * (1 - phi_hp) * 1.10892 * Tt_hp_r * (1 - 1 / pow(Pit_hp, 0.2593));
+    const double nute_lp = (Ncomp_lp * 0.95) / (Nt_dis_lp * nuad_lp);
+    const double nute_hp = (Ncomp_hp * 0.95) / (Nt_dis_hp * nuad_hp);
+    const double Cad_lp = pow(2000 * Nt_dis_lp / Gexh_real / (1 - phi_lp), 0.5);
+    const double rhog_lp = Pr_r * 1000.0 / 287.497 / Tr_r;
+    const double muft_lp = Gexh_real * (1 - phi_lp) / rhog_lp / Cad_lp * 10000.0;
+    const double Cad_hp = pow(2000 * Nt_dis_hp / Gexh_real / (1 - phi_hp), 0.5);
+    const double rhog_hp = Pt_lp_r * 1000.0 / 287.497 / Tt_lp_r;
+    const double muft_hp = Gexh_real * (1 - phi_hp) / rhog_hp / Cad_hp * 10000.0;
+
+    const double Ft_lp = refFt(muft_lp, Pit_lp);
+    const double Ft_hp = refFt(muft_hp, Pit_hp);
+
+    const double nutkr_lp = nuad_lp * nute_lp;
+    const double nutkr_hp = nuad_hp * nute_hp;
+
+    const double nusys = nutkr_lp * nutkr_hp;
+
+    const double results[RESNUM] = {
+        nuv, E1, E2,
+        Gair_lp_r, Pik_lp, nuad_lp, Ncomp_lp, Gexh_lp_r, Pit_lp, nute_lp, muft_lp, Nt_dis_lp, phi_lp, Ft_lp,
+        Gair_hp_r, Pik_hp, nuad_hp, Ncomp_hp, Gexh_hp_r, Pit_hp, nute_hp, muft_hp, Nt_dis_hp, phi_hp, Ft_hp,
+        nutkr_lp, nutkr_hp, nusys
+    };
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        res[k] = results[k];
+    }
+}
+
+void tkrReferenceSingleStage(const double *src, const TkrCalcParams &p, double *res) {
+
+    const double n      = src[0];
+    const double Gfuel  = src[3];
+    const double Gair   = src[4];
+    const double B0     = src[5];
+    const double S      = src[6];
+    const double Pk_hp  = src[9];
+    const double Pks_hp = src[10];
+    const double Pt_hp  = src[11];
+    const double Pr     = src[13];
+    const double T0     = src[14];
+    const double Tk_hp  = src[17];
+    const double Tks_hp = src[18];
+    const double Tt_hp  = src[19];
+    const double Tr     = src[21];
+    const double Tcool  = src[22];
+
+    const double B0_r     = B0 * 100.0;
+    const double S_r      = S + B0_r;
+    const double Pk_hp_r  = Pk_hp * 100.0 + B0_r;
+    const double Pks_hp_r = Pks_hp * 100.0 + B0_r;
+    const double Pt_hp_r  = Pt_hp * 100.0 + B0_r;
+    const double Pr_r     = Pr + B0_r;
+    const double T0_r     = T0 + 273.0;
+    const double Tk_hp_r  = Tk_hp + 273.0;
+    const double Tks_hp_r = Tks_hp + 273.0;
+    const double Tt_hp_r  = Tt_hp + 273.0;
+    const double Tr_r     = Tr + 273.0;
+    const double Tcool_r  = Tcool + 273.0;
+
+    // high pressure compressor inlet
+    const double Pin_r = B0_r;
+    const double Tin_r = T0_r;
+
+    const double Gair_real = Gair / 3600.0;
+
+    const double Y_S_r      = Gair_real * sqrt(T0_r) / (S_r * p.F[ST_S] * p.pipes[ST_S] * 20.317);
+    const double Y_Pin_r    = Gair_real * sqrt(Tin_r) / (Pin_r * p.F[ST_PKS_LP] * p.pipes[ST_PKS_LP] * 20.317);
+    const double Y_Pk_hp_r  = Gair_real * sqrt(Tk_hp_r) / (Pk_hp_r * p.F[ST_PK_HP] * p.pipes[ST_PK_HP] * 20.317);
+    const double Y_Pks_hp_r = Gair_real * sqrt(Tks_hp_r) / (Pks_hp_r * p.F[ST_PKS_HP] * p.pipes[ST_PKS_HP] * 20.317);
+
+    const double Gexh_real = (Gair + Gfuel / p.sysNum) / 3600;
+
+    const double Y_Pt_hp_r = Gexh_real * sqrt(Tt_hp_r) / (Pt_hp_r * p.F[ST_PT_HP] * p.pipes[ST_PT_HP] * 25.639);
+    const double Y_Pr_r    = Gexh_real * sqrt(Tr_r) / (Pr_r * p.F[ST_PR] * p.pipes[ST_PR] * 25.639);
+
+    const double S_r_dyn      = S_r / refPiAir(refLambdaAir(Y_S_r));
+    const double Pin_r_dyn    = Pin_r / refPiAir(refLambdaAir(Y_Pin_r));
+    const double Pk_hp_r_dyn  = Pk_hp_r / refPiAir(refLambdaAir(Y_Pk_hp_r));
+    const double Pks_hp_r_dyn = Pks_hp_r / refPiAir(refLambdaAir(Y_Pks_hp_r));
+    const double Pt_hp_r_dyn  = Pt_hp_r / refPiExh(refLambdaExh(Y_Pt_hp_r));
+    const double Pr_r_dyn     = Pr_r / refPiExh(refLambdaExh(Y_Pr_r));
+
+    const double nuv = 0.12 * Gair_real * 288.294 * Tks_hp_r / (p.Vh / p.sysNum * n * Pks_hp_r_dyn);
+
+    double E2 = 0;
+
+    if ( p.acType_hp == 0 ) {
+        if ( T0_r < 303.0 ) {
+            E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - 298.0);
+        }
+        else {
+            E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - T0_r);
+        }
+    }
+    else {
+        E2 = (Tk_hp_r - Tks_hp_r) / (Tk_hp_r - Tcool_r);
+    }
+
+    if ( E2 > 1.0 ) {
+        E2 = 1.0;
+    }
+
+    if ( (Tk_hp_r < Tks_hp_r) && (E2 > 0) ) {
+        E2 *= -1.0;
+    }
+
+    const double Gair_lp_r = Gair_real * p.B0_std / S_r_dyn * pow(T0_r / (p.T0_std + 273), 0.5);
+    const double Gair_hp_r = Gair_real * p.B0_std / Pin_r_dyn * pow(Tin_r / (p.T0_std + 273), 0.5);
+    const double Pik_hp = Pk_hp_r_dyn / Pin_r_dyn;
+    const double nuad_hp = Tin_r * (pow(Pik_hp, 0.2857) - 1) / (Tk_hp_r - Tin_r);
+    const double Ncomp_hp = Gair_real * 1.009 * Tin_r * (pow(Pik_hp, 0.2857) - 1);
+
+    const double Pit_hp = Pt_hp_r_dyn / Pr_r_dyn;
+    const double Tr_calc_hp = (Tt_hp_r) / pow(Pit_hp, 0.2593);
+    double phi_hp = (Tr_r - Tr_calc_hp) / (Tt_hp_r - Tr_calc_hp);
+    if ( phi_hp <= 0.04 ) {
+        phi_hp = 0;
+    }
+    const double Gexh_hp_r = Gexh_real * pow(Tt_hp_r, 0.5) / Pt_hp_r_dyn * (1 - phi_hp);
+    const double Nt_dis_hp = Gexh_real * (1 - phi_hp) * 1.10892 * Tt_hp_r * (1 - 1 / pow(Pit_hp, 0.2593));
+    const double nute_hp = (Ncomp_hp * 0.95) / (Nt_dis_hp * nuad_hp);
+    const double Cad_hp = pow(2000 * Nt_dis_hp / Gexh_real / (1 - phi_hp), 0.5);
+    const double rhog_hp = Pr_r * 1000.0 / 287.497 / Tr_r;
+    const double muft_hp = Gexh_real * (1 - phi_hp) / rhog_hp / Cad_hp * 10000.0;
+
+    const double Ft_hp = refFt(muft_hp, Pit_hp);
+
+    const double nutkr_hp = nuad_hp * nute_hp;
+
+    const double none = std::numeric_limits<double>::quiet_NaN();
+
+    const double results[RESNUM] = {
+        nuv, none, E2,
+        Gair_lp_r, none, none, none, none, none, none, none, none, none, none,
+        Gair_hp_r, Pik_hp, nuad_hp, Ncomp_hp, Gexh_hp_r, Pit_hp, nute_hp, muft_hp, Nt_dis_hp, phi_hp, Ft_hp,
+        none, nutkr_hp, none
+    };
+
+    for ( size_t k=0; k<RESNUM; k++ ) {
+        res[k] = results[k];
+    }
+}
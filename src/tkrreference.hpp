@@ -0,0 +1,43 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrreference.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TKRREFERENCE_HPP
+#define TKRREFERENCE_HPP
+
+#include "tkrkernel.hpp"
+
+//
+// Frozen scalar reference of the calculation of one source data row.
+// Formulas and constants are written out as in the original per-row
+// implementation and must not be changed or optimized: this is the
+// golden reference for every calculation path (see refcheck.cpp).
+// Source values are in order of colCaptions, results in order of
+// resCaptions.
+//
+
+void tkrReference(const double *src, const TkrCalcParams &p, double *res);
+
+// Frozen reference of a single stage engine row: low pressure stage is not
+// measured, the high pressure compressor takes in ambient air (B0, T0) and
+// the high pressure turbine discharges into the Pr station. Results of the
+// low pressure stage are not defined (NaN).
+void tkrReferenceSingleStage(const double *src, const TkrCalcParams &p, double *res);
+
+#endif // TKRREFERENCE_HPP
@@ -0,0 +1,289 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrsourcedata.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tkrsourcedata.hpp"
+#include "constants.hpp"
+#include "tkrkernel.hpp"
+#include "trace.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cfloat>
+
+using std::vector;
+using std::cout;
+
+namespace {
+
+// Branch-free check of one column: bit of the column is set in masks of
+// rows with value out of range, NaN (fails both comparisons) or denormal.
+void checkColumn(const double *v, size_t stride, size_t n, size_t col, uint32_t *invalid) {
+
+    const double lo = srcColMin[col];
+    const double hi = srcColMax[col];
+    const uint32_t bit = uint32_t(1) << col;
+
+    for ( size_t i=0; i<n; i++ ) {
+
+        const double x = v[i * stride];
+        const uint32_t ok = (x >= lo) & (x <= hi) & ((x == 0) | (std::fabs(x) >= DBL_MIN));
+
+        invalid[i] |= bit & (ok - 1);
+    }
+}
+
+} // namespace
+
+void SrcValidation::merge(const SrcValidation &v) {
+
+    for ( size_t i=0; (i < v.masked.size()) && (masked.size() < SRCERRMAXNUM); i++ ) {
+        masked.push_back(rowsNum + v.masked[i]);
+        maskedCols.push_back(v.maskedCols[i]);
+    }
+
+    rowsNum += v.rowsNum;
+    maskedNum += v.maskedNum;
+
+    for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+        invalidNum[c] += v.invalidNum[c];
+    }
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        absentNum[s] += v.absentNum[s];
+    }
+}
+
+void SrcValidation::print() const {
+
+    if ( maskedNum > 0 ) {
+
+        cout << WARNMSGBLANK << maskedNum << " of " << rowsNum
+             << " source data rows have invalid values and are not calculated:\n";
+
+        for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+            if ( invalidNum[c] > 0 ) {
+                cout << "\t" << colCaptions[c] << ": " << invalidNum[c] << " rows\n";
+            }
+        }
+
+        for ( size_t i=0; i<masked.size(); i++ ) {
+
+            cout << "\tcalculated row " << (masked[i] + 1) << ":";
+
+            for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+                if ( maskedCols[i] & (uint32_t(1) << c) ) {
+                    cout << " " << colCaptions[c];
+                }
+            }
+
+            cout << "\n";
+        }
+
+        if ( maskedNum > masked.size() ) {
+            cout << "\t...\n";
+        }
+    }
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        if ( absentNum[s] > 0 ) {
+            cout << WARNMSGBLANK << "Station " << stationCaptions[s] << " is not measured in "
+                 << absentNum[s] << " rows, results depending on it are not calculated.\n";
+        }
+    }
+}
+
+TkrSourceData::TkrSourceData() {
+}
+
+bool TkrSourceData::calculate(const vector< vector<double> > &v) {
+
+    if ( v.empty() ) {
+        return false;
+    }
+
+    TRACESCOPE("preCalculate");
+
+    prepareArrays(v);
+    preCalculate();
+    validate();
+
+    return true;
+}
+
+void TkrSourceData::loadRow(size_t i, TkrRow<double> &r) const {
+
+    loadSource(i, r);
+
+    r.B0_r    = ma_B0_r   [i];
+    r.Tcool_r = ma_Tcool_r[i];
+
+    const double *P_r = &ma_st_P_r[i * STATIONNUM];
+    const double *T_r = &ma_st_T_r[i * STATIONNUM];
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        r.st_P_r[s] = P_r[s];
+        r.st_T_r[s] = T_r[s];
+    }
+}
+
+void TkrSourceData::prepareArrays(const vector< vector<double> > &v) {
+
+    m_n = v.size();
+
+    ma_n.resize(m_n);
+    ma_Me.resize(m_n);
+    ma_Ne.resize(m_n);
+    ma_Gfuel.resize(m_n);
+    ma_Gair.resize(m_n);
+    ma_B0.resize(m_n);
+    ma_Tcool.resize(m_n);
+
+    ma_st_P.resize(m_n * STATIONNUM);
+    ma_st_T.resize(m_n * STATIONNUM);
+
+    for ( size_t i=0; i<v.size(); i++ ) {
+
+        ma_n    [i] = v[i][0];
+        ma_Me   [i] = v[i][1];
+        ma_Ne   [i] = v[i][2];
+        ma_Gfuel[i] = v[i][3];
+        ma_Gair [i] = v[i][4];
+        ma_B0   [i] = v[i][5];
+        ma_Tcool[i] = v[i][22];
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            ma_st_P[i * STATIONNUM + s] = v[i][STPCOL + s];
+            ma_st_T[i * STATIONNUM + s] = v[i][STTCOL + s];
+        }
+    }
+
+    ma_B0_r.resize(m_n);
+    ma_Tcool_r.resize(m_n);
+
+    ma_st_P_r.resize(m_n * STATIONNUM);
+    ma_st_T_r.resize(m_n * STATIONNUM);
+}
+
+void TkrSourceData::preCalculate() {
+
+    TkrRow<double> r;
+
+    for ( size_t i=0; i<m_n; i++ ) {
+
+        loadSource(i, r);
+        tkrPreCalculate(r);
+
+        ma_B0_r   [i] = r.B0_r;
+        ma_Tcool_r[i] = r.Tcool_r;
+
+        double *P_r = &ma_st_P_r[i * STATIONNUM];
+        double *T_r = &ma_st_T_r[i * STATIONNUM];
+
+        for ( size_t s=0; s<STATIONNUM; s++ ) {
+            P_r[s] = r.st_P_r[s];
+            T_r[s] = r.st_T_r[s];
+        }
+    }
+}
+
+void TkrSourceData::loadSource(size_t i, TkrRow<double> &r) const {
+
+    r.n     = ma_n    [i];
+    r.Me    = ma_Me   [i];
+    r.Ne    = ma_Ne   [i];
+    r.Gfuel = ma_Gfuel[i];
+    r.Gair  = ma_Gair [i];
+    r.B0    = ma_B0   [i];
+    r.Tcool = ma_Tcool[i];
+
+    const double *P = &ma_st_P[i * STATIONNUM];
+    const double *T = &ma_st_T[i * STATIONNUM];
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+        r.st_P[s] = P[s];
+        r.st_T[s] = T[s];
+    }
+}
+
+void TkrSourceData::validate() {
+
+    ma_invalid.assign(m_n, 0);
+    ma_absent.assign(m_n, 0);
+
+    uint32_t *invalid = ma_invalid.data();
+
+    checkColumn(ma_n.data(),     1, m_n, 0,  invalid);
+    checkColumn(ma_Me.data(),    1, m_n, 1,  invalid);
+    checkColumn(ma_Ne.data(),    1, m_n, 2,  invalid);
+    checkColumn(ma_Gfuel.data(), 1, m_n, 3,  invalid);
+    checkColumn(ma_Gair.data(),  1, m_n, 4,  invalid);
+    checkColumn(ma_B0.data(),    1, m_n, 5,  invalid);
+    checkColumn(ma_Tcool.data(), 1, m_n, 22, invalid);
+
+    for ( size_t s=0; s<STATIONNUM; s++ ) {
+
+        checkColumn(&ma_st_P[s], STATIONNUM, m_n, STPCOL + s, invalid);
+        checkColumn(&ma_st_T[s], STATIONNUM, m_n, STTCOL + s, invalid);
+
+        const uint32_t pbit = uint32_t(1) << (STPCOL + s);
+        const uint32_t tbit = uint32_t(1) << (STTCOL + s);
+
+        for ( size_t i=0; i<m_n; i++ ) {
+
+            const size_t j = i * STATIONNUM + s;
+
+            // station without measurements: zero gauge pressure and temperature
+            const uint32_t absent = (ma_st_P[j] == 0) & (ma_st_T[j] == 0);
+
+            // absolute pressure and temperature must be positive
+            const uint32_t pok = ma_st_P_r[j] > 0;
+            const uint32_t tok = ma_st_T_r[j] > 0;
+
+            ma_absent[i] |= static_cast<uint8_t>(absent << s);
+            invalid[i] |= (pbit & (pok - 1)) | (tbit & (tok - 1));
+        }
+    }
+
+    m_validation = SrcValidation();
+    m_validation.rowsNum = m_n;
+
+    for ( size_t i=0; i<m_n; i++ ) {
+
+        if ( ma_invalid[i] != 0 ) {
+
+            m_validation.maskedNum++;
+
+            for ( size_t c=0; c<SRCCOLNUM; c++ ) {
+                m_validation.invalidNum[c] += (ma_invalid[i] >> c) & 1;
+            }
+
+            if ( m_validation.masked.size() < SRCERRMAXNUM ) {
+                m_validation.masked.push_back(i);
+                m_validation.maskedCols.push_back(ma_invalid[i]);
+            }
+        }
+        else {
+            for ( size_t s=0; s<STATIONNUM; s++ ) {
+                m_validation.absentNum[s] += (ma_absent[i] >> s) & 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: tkrsourcedata.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TKRSOURCEDATA_HPP
+#define TKRSOURCEDATA_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "tkrkernel.hpp"
+
+//
+// Summary of validation of source data rows. Summaries of consecutive
+// blocks of rows are merged.
+//
+
+struct SrcValidation {
+
+    size_t rowsNum = 0;
+    size_t maskedNum = 0;                  // rows with invalid values, not calculated
+    size_t invalidNum[SRCCOLNUM] = {};     // rows with invalid value of column
+    size_t absentNum[STATIONNUM] = {};     // rows without measurements of station
+    std::vector<size_t> masked;            // first SRCERRMAXNUM masked rows
+    std::vector<uint32_t> maskedCols;      // their invalid columns, bit per column
+
+    void merge(const SrcValidation &);
+    void print() const;
+
+};
+
+//
+// Source data and results of preCalculate(). They do not depend on
+// configuration, so one object is shared by all configuration profiles.
+//
+
+class TkrSourceData {
+
+    friend class TkrParameters;
+
+public:
+
+    TkrSourceData();
+
+    bool calculate(const std::vector< std::vector<double> > &);
+
+    size_t val_rowsNum() const {
+        return m_n;
+    }
+
+    void loadRow(size_t, TkrRow<double> &) const;
+
+    bool isMasked(size_t i) const {
+        return ma_invalid[i] != 0;
+    }
+    unsigned val_absentStations(size_t i) const {
+        return ma_absent[i];
+    }
+    const SrcValidation &val_validation() const {
+        return m_validation;
+    }
+
+private:
+
+    void prepareArrays(const std::vector< std::vector<double> > &);
+    void preCalculate();
+    void validate();
+    void loadSource(size_t, TkrRow<double> &) const;
+
+    size_t m_n = 0;
+
+    std::vector<double> ma_n;
+    std::vector<double> ma_Me;
+    std::vector<double> ma_Ne;
+    std::vector<double> ma_Gfuel;
+    std::vector<double> ma_Gair;
+    std::vector<double> ma_B0;
+    std::vector<double> ma_Tcool;
+
+    // station-major arrays of m_n * STATIONNUM elements,
+    // element [i * STATIONNUM + s] belongs to row i and station s
+    std::vector<double> ma_st_P;
+    std::vector<double> ma_st_T;
+
+    std::vector<double> ma_B0_r;
+    std::vector<double> ma_Tcool_r;
+
+    std::vector<double> ma_st_P_r;
+    std::vector<double> ma_st_T_r;
+
+    std::vector<uint32_t> ma_invalid; // bit per source data column
+    std::vector<uint8_t> ma_absent;   // bit per station
+
+    SrcValidation m_validation;
+
+};
+
+#endif // TKRSOURCEDATA_HPP
@@ -0,0 +1,220 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/trace.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "trace.hpp"
+#include "constants.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+
+using std::string;
+using std::vector;
+using std::unique_ptr;
+using std::cout;
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct TraceBuffer {
+    size_t tid = 0;
+    string threadName;
+    vector<TraceEvent> events;
+    size_t dropped = 0;
+};
+
+// buffers live until exit, so pointers of finished threads stay valid
+std::mutex registryMutex;
+vector< unique_ptr<TraceBuffer> > registry;
+string traceFileName;
+
+thread_local TraceBuffer *threadBuffer = nullptr;
+
+TraceBuffer *ownBuffer() {
+
+    if ( !threadBuffer ) {
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        registry.push_back(unique_ptr<TraceBuffer>(new TraceBuffer()));
+        threadBuffer = registry.back().get();
+        threadBuffer->tid = registry.size();
+        threadBuffer->events.reserve(TRACEBLOCKEVENTS);
+    }
+
+    return threadBuffer;
+}
+
+void writeString(std::ostream &fout, const string &str) {
+
+    fout << '"';
+
+    for ( size_t i=0; i<str.size(); i++ ) {
+
+        if ( (str[i] == '"') || (str[i] == '\\') ) {
+            fout << '\\';
+        }
+
+        fout << str[i];
+    }
+
+    fout << '"';
+}
+
+// microseconds with ns precision
+void writeTime(std::ostream &fout, uint64_t ns) {
+    fout << (ns / 1000) << '.' << char('0' + (ns / 100) % 10) << char('0' + (ns / 10) % 10) << char('0' + ns % 10);
+}
+
+} // namespace
+
+std::atomic<bool> Trace::s_enabled(false);
+
+bool Trace::start(const string &fileName) {
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        traceFileName = fileName;
+    }
+
+    s_enabled.store(true, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool Trace::finish() {
+
+    if ( !isEnabled() ) {
+        return true;
+    }
+
+    s_enabled.store(false, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    uint64_t origin = std::numeric_limits<uint64_t>::max();
+    size_t dropped = 0;
+
+    for ( size_t b=0; b<registry.size(); b++ ) {
+
+        const vector<TraceEvent> &events = registry[b]->events;
+
+        for ( size_t i=0; i<events.size(); i++ ) {
+            origin = std::min(origin, events[i].begin);
+        }
+
+        dropped += registry[b]->dropped;
+    }
+
+    std::ofstream fout(traceFileName.c_str());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << traceFileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+
+    for ( size_t b=0; b<registry.size(); b++ ) {
+
+        const TraceBuffer &buf = *registry[b];
+
+        if ( !buf.threadName.empty() ) {
+
+            fout << (first ? "" : ",\n")
+                 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buf.tid
+                 << ",\"args\":{\"name\":";
+            writeString(fout, buf.threadName);
+            fout << "}}";
+
+            first = false;
+        }
+
+        for ( size_t i=0; i<buf.events.size(); i++ ) {
+
+            const TraceEvent &ev = buf.events[i];
+
+            fout << (first ? "" : ",\n") << "{\"name\":";
+            writeString(fout, ev.name);
+            fout << ",\"cat\":\"tkr\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf.tid << ",\"ts\":";
+            writeTime(fout, ev.begin - origin);
+            fout << ",\"dur\":";
+            writeTime(fout, ev.end - ev.begin);
+            fout << "}";
+
+            first = false;
+        }
+    }
+
+    fout << "\n]}\n";
+
+    fout.close();
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << traceFileName << "\"!\n";
+        return false;
+    }
+
+    if ( dropped > 0 ) {
+        cout << WARNMSGBLANK << dropped << " trace events were dropped, buffers are full.\n";
+    }
+
+    cout << MSGBLANK << "Trace file \"" << traceFileName << "\" created.\n";
+
+    return true;
+}
+
+uint64_t Trace::now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Trace::record(const char *name, uint64_t begin, uint64_t end) {
+
+    TraceBuffer *buf = ownBuffer();
+
+    if ( buf->events.size() >= TRACEMAXEVENTS ) {
+        buf->dropped++;
+        return;
+    }
+
+    TraceEvent ev = {name, begin, end};
+    buf->events.push_back(ev);
+}
+
+void Trace::setThreadName(const string &name) {
+
+    if ( isEnabled() ) {
+        ownBuffer()->threadName = name;
+    }
+}
@@ -0,0 +1,92 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: src/trace.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+//
+// Timeline of calculation stages in Chrome trace-event format. Every
+// thread records complete events (name, begin, end) into its own buffer
+// without locking; buffers are registered once per thread. Events are
+// written by finish() when all other threads are joined. When tracing is
+// not started, a scope costs one relaxed atomic load.
+//
+
+class Trace {
+
+public:
+
+    static bool start(const std::string &fileName);
+    static bool finish(); // writes the file, true if tracing was not started
+
+    static bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static uint64_t now(); // ns
+
+    // name must be a string literal or live until finish()
+    static void record(const char *name, uint64_t begin, uint64_t end);
+    static void setThreadName(const std::string &);
+
+private:
+
+    static std::atomic<bool> s_enabled;
+
+};
+
+class TraceScope {
+
+public:
+
+    explicit TraceScope(const char *name) :
+        m_name(Trace::isEnabled() ? name : nullptr) {
+
+        if ( m_name ) {
+            m_begin = Trace::now();
+        }
+    }
+
+    ~TraceScope() {
+
+        if ( m_name ) {
+            Trace::record(m_name, m_begin, Trace::now());
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+
+    const char *m_name;
+    uint64_t m_begin = 0;
+
+};
+
+#define TRACECONCAT2(a, b) a##b
+#define TRACECONCAT(a, b) TRACECONCAT2(a, b)
+#define TRACESCOPE(name) TraceScope TRACECONCAT(traceScope, __LINE__)(name)
+
+#endif // TRACE_HPP
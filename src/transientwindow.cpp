@@ -0,0 +1,117 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: transientwindow.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "transientwindow.hpp"
+#include "constants.hpp"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+
+using std::vector;
+using std::shared_ptr;
+using std::cout;
+
+TransientWindow::TransientWindow(const shared_ptr<Configuration> &conf) :
+    m_window(conf->val_trWindow()),
+    m_step(conf->val_trStep()) {
+
+    if ( m_window == 0 ) {
+        m_window = 1;
+    }
+
+    if ( m_step == 0 ) {
+        m_step = 1;
+    }
+
+    ma_ring.resize(m_window * SRCCOLNUM);
+    ma_winSum.resize(SRCCOLNUM, 0);
+}
+
+bool TransientWindow::readRow(SrcDataReader &reader, vector<double> &row) {
+
+    while ( reader.readRow(m_sample) ) {
+
+        m_samplesNum++;
+        addSample(m_sample);
+
+        // the first row is given when the window is filled
+        if ( (m_ringNum < m_window) || (((m_samplesNum - m_window) % m_step) != 0) ) {
+            continue;
+        }
+
+        row.resize(SRCCOLNUM);
+
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            row[j] = ma_winSum[j] / m_window;
+        }
+
+        m_rowsNum++;
+
+        return true;
+    }
+
+    return false;
+}
+
+void TransientWindow::printSummary() const {
+    cout << MSGBLANK << m_rowsNum << " moving average rows calculated from "
+         << m_samplesNum << " samples.\n";
+}
+
+void TransientWindow::addSample(const vector<double> &sample) {
+
+    double *slot = &ma_ring[m_ringPos * SRCCOLNUM];
+
+    if ( m_ringNum == m_window ) {
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            ma_winSum[j] += sample[j] - slot[j];
+            slot[j] = sample[j];
+        }
+    }
+    else {
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            ma_winSum[j] += sample[j];
+            slot[j] = sample[j];
+        }
+
+        m_ringNum++;
+    }
+
+    m_ringPos = (m_ringPos + 1) % m_window;
+
+    // rounding errors of running sums are dropped once per window
+    if ( m_ringPos == 0 ) {
+        recalcSums();
+    }
+}
+
+void TransientWindow::recalcSums() {
+
+    for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+        ma_winSum[j] = 0;
+    }
+
+    for ( size_t k=0; k<m_ringNum; k++ ) {
+        for ( size_t j=0; j<SRCCOLNUM; j++ ) {
+            ma_winSum[j] += ma_ring[k * SRCCOLNUM + j];
+        }
+    }
+}
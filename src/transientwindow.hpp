@@ -0,0 +1,67 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: transientwindow.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRANSIENTWINDOW_HPP
+#define TRANSIENTWINDOW_HPP
+
+#include <vector>
+#include <memory>
+
+#include "configuration.hpp"
+#include "srcdatafilter.hpp"
+
+//
+// Moving average of all source data columns over trWindow samples for
+// transient tests. Running sums are updated in O(1) per sample, the window
+// average is given every trStep samples as a row for calculation.
+//
+
+class TransientWindow : public SrcDataFilter {
+
+public:
+
+    TransientWindow(const std::shared_ptr<Configuration> &conf);
+
+    bool readRow(SrcDataReader &, std::vector<double> &);
+    void printSummary() const;
+
+private:
+
+    void addSample(const std::vector<double> &);
+    void recalcSums();
+
+    size_t m_window = 0;
+    size_t m_step = 1;
+
+    // ring buffer of last m_window samples, m_window * SRCCOLNUM elements
+    std::vector<double> ma_ring;
+    size_t m_ringPos = 0;
+    size_t m_ringNum = 0;
+
+    std::vector<double> ma_winSum;
+
+    std::vector<double> m_sample;
+
+    size_t m_samplesNum = 0;
+    size_t m_rowsNum = 0;
+
+};
+
+#endif // TRANSIENTWINDOW_HPP
@@ -0,0 +1,543 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: turbomaps.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "turbomaps.hpp"
+#include "constants.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+#include "numparser.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <iomanip>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::ifstream;
+using std::ofstream;
+using std::ostream;
+using std::cout;
+using std::setprecision;
+using std::fixed;
+
+TurboMaps::TurboMaps(const shared_ptr<Configuration> &conf) :
+    m_conf(conf),
+    m_gridSize(conf->val_mapGridSize()),
+    m_neighbours(conf->val_mapNeighbours()),
+    m_contours(conf->val_mapContours()) {
+
+    // configuration rejects other sizes, square of size must not overflow
+    m_gridSize = std::min(std::max(m_gridSize, size_t(2)), size_t(MAPMAXGRIDSIZE));
+
+    if ( m_neighbours == 0 ) {
+        m_neighbours = 1;
+    }
+
+    for ( size_t m=0; m<MAPNUM; m++ ) {
+        m_savedNum[m] = 0;
+    }
+}
+
+void TurboMaps::extractPoints(const TkrParameters &tkr, vector<MapPoint> &points) {
+
+    for ( size_t m=0; m<MAPNUM; m++ ) {
+
+        const MapDef &def = mapDefs[m];
+
+        const vector<double> &x = tkr.resultColumn(def.x);
+        const vector<double> &y = tkr.resultColumn(def.y);
+
+        for ( size_t i=0; i<tkr.val_rowsNum(); i++ ) {
+
+            MapPoint p = {m, x[i], y[i], {0, 0}};
+            bool valid = std::isfinite(p.x) && std::isfinite(p.y) && (p.x > 0) && (p.y > 0);
+
+            for ( size_t k=0; k<def.zNum; k++ ) {
+                p.z[k] = tkr.resultColumn(def.z[k])[i];
+                valid = valid && std::isfinite(p.z[k]);
+            }
+
+            if ( valid ) {
+                points.push_back(p);
+            }
+        }
+    }
+}
+
+bool TurboMaps::loadPoints() {
+
+    ifstream fin(pointsFileName().c_str());
+
+    if ( !fin ) {
+        return true;
+    }
+
+    string str;
+    size_t rowNum = 0;
+
+    while ( std::getline(fin, str) ) {
+
+        if ( (rowNum++ < TABLECAPSTRNUM) || str.empty() ) {
+            continue;
+        }
+
+        vector<string> elem;
+        size_t pos = 0;
+
+        while ( true ) {
+
+            const size_t next = str.find(CSVDELIMETER[0], pos);
+            elem.push_back(str.substr(pos, (next == string::npos) ? string::npos : (next - pos)));
+
+            if ( next == string::npos ) {
+                break;
+            }
+
+            pos = next + 1;
+        }
+
+        size_t m = 0;
+
+        while ( (m < MAPNUM) && (elem[0] != mapDefs[m].name) ) {
+            m++;
+        }
+
+        if ( (m == MAPNUM) || (elem.size() != 5) ) {
+            cout << WARNMSGBLANK << "Wrong row " << (rowNum - 1) << " in file \"" << pointsFileName() << "\"! Skipped.\n";
+            continue;
+        }
+
+        MapPoint p = {m, 0, 0, {0, 0}};
+
+        if ( !parseNumber(elem[1].data(), elem[1].data() + elem[1].size(), p.x) ||
+             !parseNumber(elem[2].data(), elem[2].data() + elem[2].size(), p.y) ||
+             !parseNumber(elem[3].data(), elem[3].data() + elem[3].size(), p.z[0]) ||
+             !parseNumber(elem[4].data(), elem[4].data() + elem[4].size(), p.z[1]) ) {
+            cout << WARNMSGBLANK << "Wrong row " << (rowNum - 1) << " in file \"" << pointsFileName() << "\"! Skipped.\n";
+            continue;
+        }
+
+        m_points[m].push_back(p);
+    }
+
+    for ( size_t m=0; m<MAPNUM; m++ ) {
+        m_savedNum[m] = m_points[m].size();
+    }
+
+    return true;
+}
+
+void TurboMaps::addPoints(const vector<MapPoint> &points) {
+
+    for ( size_t i=0; i<points.size(); i++ ) {
+        m_points[points[i].map].push_back(points[i]);
+    }
+}
+
+bool TurboMaps::savePoints() {
+
+    const string fileName = pointsFileName();
+    const bool exists = static_cast<bool>(ifstream(fileName.c_str()));
+
+    ofstream fout(fileName.c_str(), std::ios::app);
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    if ( !exists ) {
+        fout << "map" << CSVDELIMETER << "x" << CSVDELIMETER << "y" << CSVDELIMETER
+             << "z1" << CSVDELIMETER << "z2" << "\n";
+    }
+
+    fout << setprecision(std::numeric_limits<double>::digits10 + 2);
+
+    for ( size_t m=0; m<MAPNUM; m++ ) {
+
+        for ( size_t i=m_savedNum[m]; i<m_points[m].size(); i++ ) {
+
+            const MapPoint &p = m_points[m][i];
+
+            fout << mapDefs[m].name << CSVDELIMETER
+                 << p.x << CSVDELIMETER
+                 << p.y << CSVDELIMETER
+                 << p.z[0] << CSVDELIMETER
+                 << p.z[1] << "\n";
+        }
+
+        m_savedNum[m] = m_points[m].size();
+    }
+
+    fout.close();
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    return true;
+}
+
+void TurboMaps::build() {
+
+    KdTree2::Neighbours nb;
+
+    for ( size_t m=0; m<MAPNUM; m++ ) {
+
+        const vector<MapPoint> &points = m_points[m];
+        Grid &grid = m_grids[m];
+
+        for ( size_t k=0; k<2; k++ ) {
+            grid.z[k].clear();
+        }
+
+        m_trees[m] = KdTree2();
+
+        if ( points.empty() ) {
+            continue;
+        }
+
+        grid.xMin = grid.xMax = points[0].x;
+        grid.yMin = grid.yMax = points[0].y;
+
+        for ( size_t i=1; i<points.size(); i++ ) {
+            grid.xMin = std::min(grid.xMin, points[i].x);
+            grid.xMax = std::max(grid.xMax, points[i].x);
+            grid.yMin = std::min(grid.yMin, points[i].y);
+            grid.yMax = std::max(grid.yMax, points[i].y);
+        }
+
+        if ( grid.xMax == grid.xMin ) {
+            grid.xMax = grid.xMin + 1;
+        }
+
+        if ( grid.yMax == grid.yMin ) {
+            grid.yMax = grid.yMin + 1;
+        }
+
+        // tree in normalized coordinates, so both axes have equal weight
+        vector<KdTree2::Point> tpoints(points.size());
+
+        for ( size_t i=0; i<points.size(); i++ ) {
+            tpoints[i].x = (points[i].x - grid.xMin) / (grid.xMax - grid.xMin);
+            tpoints[i].y = (points[i].y - grid.yMin) / (grid.yMax - grid.yMin);
+            tpoints[i].id = i;
+        }
+
+        m_trees[m].build(tpoints);
+
+        for ( size_t k=0; k<mapDefs[m].zNum; k++ ) {
+
+            grid.z[k].resize(m_gridSize * m_gridSize);
+
+            for ( size_t j=0; j<m_gridSize; j++ ) {
+
+                const double y = grid.yMin + (grid.yMax - grid.yMin) * j / (m_gridSize - 1);
+
+                for ( size_t i=0; i<m_gridSize; i++ ) {
+
+                    const double x = grid.xMin + (grid.xMax - grid.xMin) * i / (m_gridSize - 1);
+                    grid.z[k][j * m_gridSize + i] = query(m, k, x, y, nb);
+                }
+            }
+        }
+    }
+}
+
+double TurboMaps::query(size_t map, size_t zi, double x, double y, KdTree2::Neighbours &nb) const {
+
+    const Grid &grid = m_grids[map];
+
+    if ( m_trees[map].size() == 0 ) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const double xn = (x - grid.xMin) / (grid.xMax - grid.xMin);
+    const double yn = (y - grid.yMin) / (grid.yMax - grid.yMin);
+
+    m_trees[map].nearest(xn, yn, m_neighbours, nb);
+
+    const double maxDist = MAPMAXCELLS / (m_gridSize - 1);
+
+    if ( nb[0].first > (maxDist * maxDist) ) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double wsum = 0;
+    double zsum = 0;
+
+    for ( size_t i=0; i<nb.size(); i++ ) {
+
+        const double z = m_points[map][nb[i].second].z[zi];
+
+        // query in measured point
+        if ( nb[i].first < 1e-24 ) {
+            return z;
+        }
+
+        const double w = 1.0 / nb[i].first;
+
+        wsum += w;
+        zsum += w * z;
+    }
+
+    return zsum / wsum;
+}
+
+double TurboMaps::query(size_t map, size_t zi, double x, double y) const {
+
+    KdTree2::Neighbours nb;
+
+    return query(map, zi, x, y, nb);
+}
+
+double TurboMaps::interpolate(size_t map, size_t zi, double x, double y) const {
+
+    const Grid &grid = m_grids[map];
+    const vector<double> &z = grid.z[zi];
+
+    if ( z.empty() ) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const double xg = (x - grid.xMin) / (grid.xMax - grid.xMin) * (m_gridSize - 1);
+    const double yg = (y - grid.yMin) / (grid.yMax - grid.yMin) * (m_gridSize - 1);
+
+    if ( !(xg >= 0) || !(yg >= 0) || !(xg <= (m_gridSize - 1)) || !(yg <= (m_gridSize - 1)) ) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const size_t i = std::min(static_cast<size_t>(xg), m_gridSize - 2);
+    const size_t j = std::min(static_cast<size_t>(yg), m_gridSize - 2);
+
+    const double u = xg - i;
+    const double v = yg - j;
+
+    const double *row = &z[j * m_gridSize + i];
+
+    // NaN of a node far from measured points propagates to the result
+    return (1 - v) * ((1 - u) * row[0] + u * row[1]) +
+           v * ((1 - u) * row[m_gridSize] + u * row[m_gridSize + 1]);
+}
+
+bool TurboMaps::createReport() const {
+
+    const string fileName = reportFileName(MAPREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n";
+
+    if ( !m_conf->val_profileName().empty() ) {
+        fout << "Configuration profile: " << m_conf->val_profileName() << "\n\n";
+    }
+
+    fout << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
+         << "Compressor and turbine maps\n\n"
+         << "Grid size" << CSVDELIMETER << m_gridSize << "\n"
+         << "Interpolation neighbours" << CSVDELIMETER << m_neighbours << "\n";
+
+    for ( size_t m=0; m<MAPNUM; m++ ) {
+
+        const MapDef &def = mapDefs[m];
+        const Grid &grid = m_grids[m];
+
+        fout << "\n" << "Map " << def.name << CSVDELIMETER << m_points[m].size() << " points\n";
+
+        if ( grid.z[0].empty() ) {
+            continue;
+        }
+
+        for ( size_t k=0; k<def.zNum; k++ ) {
+
+            fout << "\n" << resCaptions[def.z[k]] << "\n"
+                 << resCaptions[def.y] << " \\ " << resCaptions[def.x];
+
+            for ( size_t i=0; i<m_gridSize; i++ ) {
+                fout << CSVDELIMETER << fixed << setprecision(4)
+                     << (grid.xMin + (grid.xMax - grid.xMin) * i / (m_gridSize - 1));
+            }
+
+            fout << "\n";
+
+            for ( size_t j=0; j<m_gridSize; j++ ) {
+
+                fout << fixed << setprecision(4)
+                     << (grid.yMin + (grid.yMax - grid.yMin) * j / (m_gridSize - 1));
+
+                for ( size_t i=0; i<m_gridSize; i++ ) {
+
+                    const double z = grid.z[k][j * m_gridSize + i];
+
+                    fout << CSVDELIMETER;
+
+                    if ( !std::isnan(z) ) {
+                        fout << fixed << setprecision(4) << z;
+                    }
+                }
+
+                fout << "\n";
+            }
+        }
+
+        writeContours(fout, m);
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\"created.\n";
+
+    return true;
+}
+
+string TurboMaps::pointsFileName() const {
+
+    string fileName = string(MAPPOINTSNAME);
+
+    if ( !m_conf->val_profileName().empty() ) {
+        fileName += "__" + m_conf->val_profileName();
+    }
+
+    return joinPath(m_conf->val_outDir(), fileName + ".csv");
+}
+
+void TurboMaps::writeContours(ostream &fout, size_t m) const {
+
+    const Grid &grid = m_grids[m];
+    const vector<double> &z = grid.z[0];
+
+    if ( m_contours == 0 ) {
+        return;
+    }
+
+    double zMin = std::numeric_limits<double>::max();
+    double zMax = -zMin;
+
+    for ( size_t i=0; i<z.size(); i++ ) {
+        if ( !std::isnan(z[i]) ) {
+            zMin = std::min(zMin, z[i]);
+            zMax = std::max(zMax, z[i]);
+        }
+    }
+
+    if ( !(zMax > zMin) ) {
+        return;
+    }
+
+    const double dx = (grid.xMax - grid.xMin) / (m_gridSize - 1);
+    const double dy = (grid.yMax - grid.yMin) / (m_gridSize - 1);
+
+    fout << "\n" << "Contours of " << resCaptions[mapDefs[m].z[0]] << " (segments)\n"
+         << "level" << CSVDELIMETER
+         << "x1" << CSVDELIMETER << "y1" << CSVDELIMETER
+         << "x2" << CSVDELIMETER << "y2" << "\n";
+
+    // marching squares, corners of cell: 0 - (i, j), 1 - (i+1, j), 2 - (i+1, j+1), 3 - (i, j+1)
+    for ( size_t l=1; l<=m_contours; l++ ) {
+
+        const double level = zMin + (zMax - zMin) * l / (m_contours + 1);
+
+        for ( size_t j=0; j<(m_gridSize-1); j++ ) {
+
+            for ( size_t i=0; i<(m_gridSize-1); i++ ) {
+
+                const double v[4] = {
+                    z[j * m_gridSize + i],
+                    z[j * m_gridSize + i + 1],
+                    z[(j + 1) * m_gridSize + i + 1],
+                    z[(j + 1) * m_gridSize + i]
+                };
+
+                if ( std::isnan(v[0]) || std::isnan(v[1]) || std::isnan(v[2]) || std::isnan(v[3]) ) {
+                    continue;
+                }
+
+                const double cx[4] = {0, 1, 1, 0};
+                const double cy[4] = {0, 0, 1, 1};
+
+                // crossings of edges 0-1, 1-2, 2-3, 3-0
+                double px[4];
+                double py[4];
+                size_t cross[4];
+                size_t num = 0;
+
+                for ( size_t e=0; e<4; e++ ) {
+
+                    const size_t a = e;
+                    const size_t b = (e + 1) % 4;
+
+                    if ( (v[a] >= level) != (v[b] >= level) ) {
+
+                        const double t = (level - v[a]) / (v[b] - v[a]);
+
+                        px[e] = grid.xMin + dx * (i + cx[a] + (cx[b] - cx[a]) * t);
+                        py[e] = grid.yMin + dy * (j + cy[a] + (cy[b] - cy[a]) * t);
+                        cross[num++] = e;
+                    }
+                }
+
+                size_t seg[4] = {0, 0, 0, 0};
+                size_t segNum = 0;
+
+                if ( num == 2 ) {
+                    seg[0] = cross[0];
+                    seg[1] = cross[1];
+                    segNum = 1;
+                }
+                else if ( num == 4 ) {
+
+                    // saddle is resolved by the value in the center of cell
+                    const bool center = ((v[0] + v[1] + v[2] + v[3]) / 4) >= level;
+
+                    if ( center == (v[0] >= level) ) {
+                        seg[0] = 0; seg[1] = 1; seg[2] = 2; seg[3] = 3;
+                    }
+                    else {
+                        seg[0] = 0; seg[1] = 3; seg[2] = 1; seg[3] = 2;
+                    }
+
+                    segNum = 2;
+                }
+
+                for ( size_t s=0; s<segNum; s++ ) {
+                    fout << fixed << setprecision(4) << level << CSVDELIMETER
+                         << px[seg[2*s]]   << CSVDELIMETER << py[seg[2*s]]   << CSVDELIMETER
+                         << px[seg[2*s+1]] << CSVDELIMETER << py[seg[2*s+1]] << "\n";
+                }
+            }
+        }
+    }
+}
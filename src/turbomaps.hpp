@@ -0,0 +1,106 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: turbomaps.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TURBOMAPS_HPP
+#define TURBOMAPS_HPP
+
+#include <vector>
+#include <memory>
+#include <string>
+
+#include "configuration.hpp"
+#include "constants.hpp"
+#include "kdtree.hpp"
+#include "tkrparameters.hpp"
+
+//
+// Measured point of compressor or turbine map.
+//
+
+struct MapPoint {
+    size_t map;
+    double x;
+    double y;
+    double z[2];
+};
+
+//
+// Compressor and turbine maps built from scattered points accumulated
+// across runs in the file MAPPOINTSNAME of outDir. Points of every map are indexed
+// by k-d tree in coordinates normalized to the map range, values in grid
+// nodes and in arbitrary points are interpolated by inverse distance
+// weighting of mapNeighbours nearest points.
+//
+
+class TurboMaps {
+
+public:
+
+    TurboMaps(const std::shared_ptr<Configuration> &conf);
+
+    static void extractPoints(const TkrParameters &, std::vector<MapPoint> &);
+
+    bool loadPoints();
+    void addPoints(const std::vector<MapPoint> &);
+    bool savePoints();
+
+    void build();
+
+    // interpolated value of column zi of map, NaN if (x, y) is far from measured points
+    double query(size_t map, size_t zi, double x, double y, KdTree2::Neighbours &) const;
+    double query(size_t map, size_t zi, double x, double y) const;
+
+    // bilinear interpolation of column zi of map between grid nodes, NaN outside of grid
+    double interpolate(size_t map, size_t zi, double x, double y) const;
+
+    bool createReport() const;
+
+    size_t val_pointsNum(size_t map) const {
+        return m_points[map].size();
+    }
+
+private:
+
+    struct Grid {
+        double xMin = 0;
+        double xMax = 0;
+        double yMin = 0;
+        double yMax = 0;
+        std::vector<double> z[2]; // m_gridSize * m_gridSize nodes, x index changes first
+    };
+
+    std::string pointsFileName() const;
+    void writeContours(std::ostream &, size_t) const;
+
+    std::shared_ptr<Configuration> m_conf;
+
+    size_t m_gridSize = 50;
+    size_t m_neighbours = 8;
+    size_t m_contours = 10;
+
+    std::vector<MapPoint> m_points[MAPNUM];
+    size_t m_savedNum[MAPNUM];
+
+    KdTree2 m_trees[MAPNUM];
+    Grid m_grids[MAPNUM];
+
+};
+
+#endif // TURBOMAPS_HPP
@@ -0,0 +1,263 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: uncertainty.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "uncertainty.hpp"
+#include "tkrparameters.hpp"
+#include "constants.hpp"
+#include "configuration.hpp"
+#include "auxfunctions.hpp"
+#include "identification.hpp"
+#include "compression.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+using std::cout;
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::setprecision;
+using std::fixed;
+
+Uncertainty::Uncertainty(const shared_ptr<Configuration> &cfg) {
+    m_conf = cfg;
+}
+
+bool Uncertainty::calculate(const vector< vector<double> > &v) {
+
+    if ( v.empty() || (m_conf->val_mcSamples() == 0) ) {
+        return false;
+    }
+
+    m_srcdata = &v;
+    m_n = v.size();
+    m_resNum = resCaptions.size();
+
+    ma_mean.resize(m_n * m_resNum);
+    ma_sd.resize(m_n * m_resNum);
+    ma_p025.resize(m_n * m_resNum);
+    ma_p50.resize(m_n * m_resNum);
+    ma_p975.resize(m_n * m_resNum);
+
+    ma_n.resize(m_n);
+    ma_Me.resize(m_n);
+
+    for ( size_t i=0; i<m_n; i++ ) {
+        ma_n [i] = v[i][0];
+        ma_Me[i] = v[i][1];
+    }
+
+    size_t thrnum = m_conf->val_mcThreads();
+
+    if ( thrnum == 0 ) {
+        thrnum = std::thread::hardware_concurrency();
+    }
+    if ( thrnum == 0 ) {
+        thrnum = 1;
+    }
+    if ( thrnum > m_n ) {
+        thrnum = m_n;
+    }
+
+    vector<std::thread> threads;
+
+    for ( size_t t=1; t<thrnum; t++ ) {
+        threads.push_back(std::thread(&Uncertainty::calculateRows, this, t, thrnum));
+    }
+
+    calculateRows(0, thrnum);
+
+    for ( size_t t=0; t<threads.size(); t++ ) {
+        threads[t].join();
+    }
+
+    m_srcdata = nullptr;
+
+    return true;
+}
+
+void Uncertainty::calculateRows(size_t thr, size_t thrnum) {
+
+    const size_t samples = m_conf->val_mcSamples();
+    const vector<double> tols = m_conf->val_mcTolerances();
+
+    const uint64_t seed = m_conf->val_mcSeed();
+
+    std::mt19937_64 rng;
+    std::normal_distribution<double> norm(0.0, 1.0);
+
+    // samples of one row are calculated as a batch of source data rows
+    vector< vector<double> > batch(samples, vector<double>(colCaptions.size()));
+    vector<double> res(samples);
+    TkrParameters tkr(m_conf);
+
+    for ( size_t i=thr; i<m_n; i+=thrnum ) {
+
+        const vector<double> &src = (*m_srcdata)[i];
+
+        // every row has its own random number stream, so results do not
+        // depend on the number of threads
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                          static_cast<uint32_t>(i), static_cast<uint32_t>(static_cast<uint64_t>(i) >> 32)};
+        rng.seed(seq);
+        norm.reset();
+
+        for ( size_t s=0; s<samples; s++ ) {
+            for ( size_t j=0; j<src.size(); j++ ) {
+                batch[s][j] = src[j] + tols[j] * norm(rng);
+            }
+        }
+
+        tkr.calculate(batch);
+
+        for ( size_t k=0; k<m_resNum; k++ ) {
+
+            const vector<double> &col = tkr.resultColumn(k);
+            size_t valid = 0;
+
+            for ( size_t s=0; s<samples; s++ ) {
+                if ( std::isfinite(col[s]) ) {
+                    res[valid++] = col[s];
+                }
+            }
+
+            const size_t ind = i * m_resNum + k;
+
+            if ( valid == 0 ) {
+                ma_mean[ind] = ma_sd[ind] = ma_p025[ind] = ma_p50[ind] = ma_p975[ind] = NAN;
+                continue;
+            }
+
+            double mean = 0;
+            double m2 = 0;
+
+            for ( size_t s=0; s<valid; s++ ) {
+                const double delta = res[s] - mean;
+                mean += delta / (s + 1);
+                m2 += delta * (res[s] - mean);
+            }
+
+            std::sort(res.begin(), res.begin() + valid);
+
+            auto percentile = [&res, valid](double p) {
+                const double pos = p * (valid - 1);
+                const size_t lo = static_cast<size_t>(pos);
+                const size_t hi = (lo + 1 < valid) ? lo + 1 : lo;
+                return res[lo] + (res[hi] - res[lo]) * (pos - lo);
+            };
+
+            ma_mean[ind] = mean;
+            ma_sd[ind]   = (valid > 1) ? sqrt(m2 / (valid - 1)) : 0;
+            ma_p025[ind] = percentile(0.025);
+            ma_p50[ind]  = percentile(0.5);
+            ma_p975[ind] = percentile(0.975);
+        }
+    }
+}
+
+bool Uncertainty::createReport() const {
+
+    const string fileName = reportFileName(UNCREPORTNAME, *m_conf);
+
+    ReportStream fout(fileName, m_conf->val_reportCompression());
+
+    if ( !fout ) {
+        cout << ERRORMSGBLANK << "Can not open file \"" << fileName << "\" to write!\n";
+        return false;
+    }
+
+    fout << Identification{}.name() << " v" << Identification{}.version() << "\n\n";
+
+    if ( !m_conf->val_profileName().empty() ) {
+        fout << "Configuration profile: " << m_conf->val_profileName() << "\n\n";
+    }
+
+    fout << "Engine description: " << m_conf->val_testObjDescr() << "\n\n"
+         << "Monte Carlo uncertainty propagation\n\n"
+         << "Samples per row" << CSVDELIMETER << m_conf->val_mcSamples() << "\n"
+         << "Seed" << CSVDELIMETER << m_conf->val_mcSeed() << "\n\n"
+         << "Standard uncertainties of source data\n\n";
+
+    const vector<double> tols = m_conf->val_mcTolerances();
+
+    for ( size_t i=0; i<colCaptions.size(); i++ ) {
+        fout << colCaptions[i] << CSVDELIMETER << tols[i] << "\n";
+    }
+
+    fout << "\n" << "Calculation results (mean, standard deviation, 2.5%, 50% and 97.5% percentiles)\n\n"
+         << "n[min-1]" << CSVDELIMETER
+         << "Me[Nm]"   << CSVDELIMETER;
+
+    for ( size_t k=0; k<m_resNum; k++ ) {
+        fout << CSVDELIMETER
+             << resCaptions[k] << " mean" << CSVDELIMETER
+             << resCaptions[k] << " sd"   << CSVDELIMETER
+             << resCaptions[k] << " 2.5%" << CSVDELIMETER
+             << resCaptions[k] << " 50%"  << CSVDELIMETER
+             << resCaptions[k] << " 97.5%";
+
+        if ( k != (m_resNum-1) ) {
+            fout << CSVDELIMETER;
+        }
+    }
+
+    fout << "\n";
+
+    for ( size_t i=0; i<m_n; i++ ) {
+
+        fout << fixed << setprecision(0) << ma_n[i]  << CSVDELIMETER
+             << fixed << setprecision(0) << ma_Me[i] << CSVDELIMETER;
+
+        for ( size_t k=0; k<m_resNum; k++ ) {
+
+            const size_t ind = i * m_resNum + k;
+
+            fout << CSVDELIMETER
+                 << fixed << setprecision(4) << ma_mean[ind] << CSVDELIMETER
+                 << fixed << setprecision(4) << ma_sd[ind]   << CSVDELIMETER
+                 << fixed << setprecision(4) << ma_p025[ind] << CSVDELIMETER
+                 << fixed << setprecision(4) << ma_p50[ind]  << CSVDELIMETER
+                 << fixed << setprecision(4) << ma_p975[ind];
+
+            if ( k != (m_resNum-1) ) {
+                fout << CSVDELIMETER;
+            }
+        }
+
+        fout << "\n";
+    }
+
+    if ( !fout.close() ) {
+        cout << ERRORMSGBLANK << "Can not write file \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    cout << MSGBLANK << "Report file \"" << fileName << "\" created.\n";
+
+    return true;
+}
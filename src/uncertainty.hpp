@@ -0,0 +1,61 @@
+/*
+    tkr
+    Calculation of turbocharger parameters.
+
+    File: uncertainty.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UNCERTAINTY_HPP
+#define UNCERTAINTY_HPP
+
+#include <vector>
+#include <memory>
+
+#include "configuration.hpp"
+
+class Uncertainty {
+
+public:
+
+    Uncertainty(const std::shared_ptr<Configuration> &conf);
+
+    bool calculate(const std::vector< std::vector<double> > &);
+    bool createReport() const;
+
+private:
+
+    void calculateRows(size_t, size_t);
+
+    std::shared_ptr<Configuration> m_conf;
+
+    const std::vector< std::vector<double> > *m_srcdata = nullptr;
+
+    size_t m_n = 0;
+    size_t m_resNum = 0;
+
+    std::vector<double> ma_n;
+    std::vector<double> ma_Me;
+
+    // statistics of result columns, arrays of m_n * m_resNum elements
+    std::vector<double> ma_mean;
+    std::vector<double> ma_sd;
+    std::vector<double> ma_p025;
+    std::vector<double> ma_p50;
+    std::vector<double> ma_p975;
+
+};
+
+#endif // UNCERTAINTY_HPP